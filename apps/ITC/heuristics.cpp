@@ -44,6 +44,7 @@ int VarHeurTimetabling::select(const NsIntVarArray& vLectPeriod)
         unsigned i;
         NsDeque<unsigned> varIndex;
         NsDeque<double> heuristic;
+        NsDeque<NsIndex> candidates;
         for (i = 0; i < vLectPeriod.size(); ++i) {
                 if (vLectPeriod[i].isBound() && !vLectRoom[i].isBound()) {
                         //  This is the case that we have not a complete
@@ -61,7 +62,18 @@ int VarHeurTimetabling::select(const NsIntVarArray& vLectPeriod)
         switch ((pr.isActiveLocalSearch) ? pr.varHeuristicType_ls
                                          : pr.varHeuristicType) {
         case NORMAL:
-                for (i = 0; i < vLectPeriod.size(); ++i) {
+                //  Only the lectures with the minimum domain size can win,
+                //  except for LAN, which may skip some of them.
+                if (((pr.isActiveLocalSearch) ? pr.searchMethod_ls
+                                              : pr.searchMethod) == LAN) {
+                        candidates.resize(vLectPeriod.size());
+                        for (i = 0; i < vLectPeriod.size(); ++i)
+                                candidates[i] = i;
+                } else {
+                        vLectPeriod.firstFailIndices(candidates);
+                }
+                for (NsIndex c = 0; c < candidates.size(); ++c) {
+                        i = candidates[c];
                         courseIndex = lectInfo[i].courseIndex;
                         if (!vLectPeriod[i].isBound() &&
                             (bestIndex == -1 ||
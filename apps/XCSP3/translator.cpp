@@ -59,7 +59,7 @@ void Xcsp3_to_Naxos::endInstance()
                 cout << "end SAX parsing\n";
         if (AllVars.empty())
                 throw invalid_argument("No constrained variables defined");
-        pm.addGoal(new NsgLabeling(AllVars));
+        pm.addGoal(new NsgLabeling(AllVars, NsgLabeling::DOM_WDEG));
 }
 
 void Xcsp3_to_Naxos::beginVariables()
@@ -490,11 +490,22 @@ void Xcsp3_to_Naxos::buildConstraintPrimitive(string id, OrderType op,
         }
 }
 
+NsInt Xcsp3_to_Naxos::tableValue(const int value)
+{
+        return ((value == STAR) ? NsSTAR : value);
+}
+
 /// Materializes the unary extensional constraint
 void Xcsp3_to_Naxos::addUnaryExtensionConstraint(XVariable* var, bool support)
 {
         NsIntVar& Var = variable(var->id);
-        NsDeque<NsInt>& tuple = tuplesStore.back().back();
+        NsDeque<NsInt>& tuple = lastTable.back();
+        if (find(tuple.begin(), tuple.end(), NsSTAR) != tuple.end()) {
+                // Every value is a support, or a conflict
+                if (!support)
+                        Var.removeAll();
+                return;
+        }
         if (support) {
                 removeUnsupportedValues(Var, tuple);
         } else {
@@ -509,9 +520,9 @@ void Xcsp3_to_Naxos::addExtensionConstraint(vector<XVariable*> list,
 {
         collectArray(list);
         if (support)
-                pm.add(NsSupports(arrays.back(), tuplesStore.back()));
+                pm.add(NsSupports(arrays.back(), lastTable));
         else
-                pm.add(NsConflicts(arrays.back(), tuplesStore.back()));
+                pm.add(NsConflicts(arrays.back(), lastTable));
 }
 
 /// Unary extension constraint
@@ -527,10 +538,6 @@ void Xcsp3_to_Naxos::buildConstraintExtension(string id, XVariable* var,
                      << "star: " << hasStar << "\n"
                      << "      " << *var << "\n";
         }
-        if (hasStar) {
-                throw invalid_argument("Short tables, i.e. tables with tuples "
-                                       "containing '*', are not accepted");
-        }
         collectTuples(tuples);
         addUnaryExtensionConstraint(var, support);
 }
@@ -551,10 +558,6 @@ void Xcsp3_to_Naxos::buildConstraintExtension(string id,
                      << "      ";
                 displayList(list);
         }
-        if (hasStar) {
-                throw invalid_argument("Short tables, i.e. tables with tuples "
-                                       "containing '*', are not accepted");
-        }
         collectTuples(tuples);
         addExtensionConstraint(list, support);
 }
@@ -566,10 +569,6 @@ void Xcsp3_to_Naxos::buildConstraintExtensionAs(string id,
 {
         if (verbose)
                 cout << "    extension same as above " << id << "\n";
-        if (hasStar) {
-                throw invalid_argument("Short tables, i.e. tables with tuples "
-                                       "containing '*', are not accepted");
-        }
         if (list.size() == 1)
                 addUnaryExtensionConstraint(list[0], support);
         else
@@ -589,28 +588,28 @@ void Xcsp3_to_Naxos::buildConstraintAlldifferent(string id,
 
 /// Enforces sum constraint for every possible condition
 template <typename T>
-void Xcsp3_to_Naxos::unfoldSumConstraintCondition(NsIntVarArray& array,
+void Xcsp3_to_Naxos::unfoldSumConstraintCondition(const Ns_Expression& sum,
                                                   const OrderType condition,
                                                   T& operand)
 {
         switch (condition) {
         case EQ:
-                pm.add(NsSum(array) == operand);
+                pm.add(sum == operand);
                 break;
         case NE:
-                pm.add(NsSum(array) != operand);
+                pm.add(sum != operand);
                 break;
         case LT:
-                pm.add(NsSum(array) < operand);
+                pm.add(sum < operand);
                 break;
         case LE:
-                pm.add(NsSum(array) <= operand);
+                pm.add(sum <= operand);
                 break;
         case GT:
-                pm.add(NsSum(array) > operand);
+                pm.add(sum > operand);
                 break;
         case GE:
-                pm.add(NsSum(array) >= operand);
+                pm.add(sum >= operand);
                 break;
         default:
                 throw invalid_argument("Unsupported sum condition");
@@ -619,15 +618,15 @@ void Xcsp3_to_Naxos::unfoldSumConstraintCondition(NsIntVarArray& array,
 }
 
 /// Enforces sum constraint for every possible operand
-void Xcsp3_to_Naxos::unfoldSumConstraintOperand(NsIntVarArray& array,
+void Xcsp3_to_Naxos::unfoldSumConstraintOperand(const Ns_Expression& sum,
                                                 const XCondition& cond)
 {
         switch (cond.operandType) {
         case INTEGER:
-                unfoldSumConstraintCondition(array, cond.op, cond.val);
+                unfoldSumConstraintCondition(sum, cond.op, cond.val);
                 break;
         case VARIABLE:
-                unfoldSumConstraintCondition(array, cond.op,
+                unfoldSumConstraintCondition(sum, cond.op,
                                              variable(cond.var));
                 break;
         default:
@@ -646,7 +645,7 @@ void Xcsp3_to_Naxos::buildConstraintSum(string id, vector<XVariable*>& list,
                 cout << cond << "\n";
         }
         collectArray(list);
-        unfoldSumConstraintOperand(arrays.back(), cond);
+        unfoldSumConstraintOperand(NsSum(arrays.back()), cond);
 }
 
 /// Weighted sum constraint
@@ -671,8 +670,9 @@ void Xcsp3_to_Naxos::buildConstraintSum(string id, vector<XVariable*>& list,
                 }
                 cout << cond << "\n";
         }
-        collectArray(list, coeffs);
-        unfoldSumConstraintOperand(arrays.back(), cond);
+        collectArray(list);
+        NsDeque<NsInt> weights = signedWeights(coeffs);
+        unfoldSumConstraintOperand(NsLinear(weights, arrays.back()), cond);
 }
 
 /// Sum constraint with variables as weights
@@ -703,7 +703,7 @@ void Xcsp3_to_Naxos::buildConstraintSum(string id, vector<XVariable*>& list,
         for (vector<XVariable*>::size_type i = 0; i < list.size(); ++i)
                 array.push_back(variable(coeffs.at(i)->id) *
                                 variable(list[i]->id));
-        unfoldSumConstraintOperand(array, cond);
+        unfoldSumConstraintOperand(NsSum(array), cond);
 }
 
 /// Value is in position index inside the list
@@ -798,6 +798,10 @@ void Xcsp3_to_Naxos::buildObjectiveMinimize(ExpressionObjective type,
                                             vector<int>& coefs)
 {
         objectiveSign = +1;
+        if (type == SUM_O) {
+                addObjectiveLinear(list, coefs);
+                return;
+        }
         collectArray(list, coefs);
         addObjectiveArray(type);
 }
@@ -807,10 +811,25 @@ void Xcsp3_to_Naxos::buildObjectiveMaximize(ExpressionObjective type,
                                             vector<int>& coefs)
 {
         objectiveSign = -1;
+        if (type == SUM_O) {
+                addObjectiveLinear(list, coefs);
+                return;
+        }
         collectArray(list, coefs);
         addObjectiveArray(type);
 }
 
+/// Sets the objective goal for a weighted sum
+void Xcsp3_to_Naxos::addObjectiveLinear(vector<XVariable*>& list,
+                                        vector<int>& coefs)
+{
+        constrainedOptimizationMode = true;
+        // The sign is applied to the weights, to avoid another variable
+        collectArray(list);
+        NsDeque<NsInt> weights = signedWeights(coefs, objectiveSign);
+        pm.minimize(NsLinear(weights, arrays.back()));
+}
+
 /// Sets the objective goal for arrays
 void Xcsp3_to_Naxos::addObjectiveArray(ExpressionObjective type)
 {
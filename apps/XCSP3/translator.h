@@ -143,6 +143,19 @@ class Xcsp3_to_Naxos : public XCSP3Core::XCSP3CoreCallbacks {
                                                 variable(list[i]->id));
         }
 
+        /// Returns the XCSP3 weights multiplied by sign
+        ///
+        /// NsLinear() copies them and can then post the weighted sum
+        /// as one constraint, without an intermediate variable per term.
+        naxos::NsDeque<naxos::NsInt>
+        signedWeights(const std::vector<int>& coeffs, const int sign = +1)
+        {
+                naxos::NsDeque<naxos::NsInt> weights;
+                for (std::vector<int>::size_type i = 0; i < coeffs.size(); ++i)
+                        weights.push_back(sign * coeffs[i]);
+                return weights;
+        }
+
         /// The problem manager
         ///
         /// It is declared as the last data-member, to be destroyed
@@ -281,29 +294,34 @@ class Xcsp3_to_Naxos : public XCSP3Core::XCSP3CoreCallbacks {
         /// @name Extensional Constraints
 
     private:
-        /// Collection of all the tables for the extensional constraints
-        naxos::NsList<naxos::NsDeque<naxos::NsDeque<naxos::NsInt>>> tuplesStore;
+        /// The table of the last extensional constraint
+        ///
+        /// The constraints copy their tables into the problem
+        /// manager, which shares the same tables between them. So,
+        /// only the last table is kept, for the constraints that
+        /// reuse it.
+        naxos::NsDeque<naxos::NsDeque<naxos::NsInt>> lastTable;
+
+        /// Converts a table cell, which may be the parser's '*'
+        static naxos::NsInt tableValue(const int value);
 
         /// Stores the table of the last unary extensional constraint
         void collectTuples(const std::vector<int>& tuple)
         {
-                tuplesStore.push_back(
-                    naxos::NsDeque<naxos::NsDeque<naxos::NsInt>>());
-                tuplesStore.back().push_back(naxos::NsDeque<naxos::NsInt>());
+                lastTable.clear();
+                lastTable.push_back(naxos::NsDeque<naxos::NsInt>());
                 for (const auto& value : tuple)
-                        tuplesStore.back().back().push_back(value);
+                        lastTable.back().push_back(tableValue(value));
         }
 
         /// Stores the table of the last extensional constraint
         void collectTuples(std::vector<std::vector<int>>& tuples)
         {
-                tuplesStore.push_back(
-                    naxos::NsDeque<naxos::NsDeque<naxos::NsInt>>());
+                lastTable.clear();
                 for (const auto& tuple : tuples) {
-                        tuplesStore.back().push_back(
-                            naxos::NsDeque<naxos::NsInt>());
+                        lastTable.push_back(naxos::NsDeque<naxos::NsInt>());
                         for (const auto& value : tuple)
-                                tuplesStore.back().back().push_back(value);
+                                lastTable.back().push_back(tableValue(value));
                 }
         }
 
@@ -346,11 +364,11 @@ class Xcsp3_to_Naxos : public XCSP3Core::XCSP3CoreCallbacks {
 
     private:
         template <typename T>
-        void unfoldSumConstraintCondition(naxos::NsIntVarArray& array,
+        void unfoldSumConstraintCondition(const naxos::Ns_Expression& sum,
                                           const XCSP3Core::OrderType condition,
                                           T& operand);
 
-        void unfoldSumConstraintOperand(naxos::NsIntVarArray& array,
+        void unfoldSumConstraintOperand(const naxos::Ns_Expression& sum,
                                         const XCSP3Core::XCondition& cond);
 
     public:
@@ -422,6 +440,9 @@ class Xcsp3_to_Naxos : public XCSP3Core::XCSP3CoreCallbacks {
     private:
         void addObjectiveArray(XCSP3Core::ExpressionObjective type);
 
+        void addObjectiveLinear(std::vector<XCSP3Core::XVariable*>& list,
+                                std::vector<int>& coefs);
+
         /// @}
 };
 
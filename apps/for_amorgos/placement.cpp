@@ -51,7 +51,7 @@ int main(int argc, char* argv[])
                 // maximum size of small rectangles
                 int maxX = (argc > 4) ? atoi(argv[4]) : 5;
                 int maxY = (argc > 5) ? atoi(argv[5]) : 5;
-                int i, j;
+                int i;
                 // construct N random small rectangles
                 srand(time(NULL));
                 Rectangle* rects = new Rectangle[N];
@@ -82,18 +82,19 @@ int main(int argc, char* argv[])
                         Vars.push_back(*(rects[i].minX));
                 }
                 // small rectangles must not overlap
-                for (i = 0; i < N; ++i)
-                        for (j = 0; j < N; ++j)
-                                if (i != j) {
-                                        pm.add(*(rects[i].minX) + rects[i].x <=
-                                                   *(rects[j].minX) ||
-                                               *(rects[j].minX) + rects[j].x <=
-                                                   *(rects[i].minX) ||
-                                               *(rects[i].minY) + rects[i].y <=
-                                                   *(rects[j].minY) ||
-                                               *(rects[j].minY) + rects[j].y <=
-                                                   *(rects[i].minY));
-                                }
+                NsIntVarArray VarsX, VarsY;
+                NsDeque<NsInt> sizesX, sizesY;
+                for (i = 0; i < N; ++i) {
+                        VarsX.push_back(*(rects[i].minX));
+                        VarsY.push_back(*(rects[i].minY));
+                        sizesX.push_back(rects[i].x);
+                        sizesY.push_back(rects[i].y);
+                }
+                pm.add(NsDiffn(VarsX, VarsY, sizesX, sizesY));
+                // the rectangles that cross a vertical (or horizontal)
+                // line should fit into the height (width) of the big one
+                pm.add(NsCumulative(VarsX, sizesX, sizesY, bigRect.y));
+                pm.add(NsCumulative(VarsY, sizesY, sizesX, bigRect.x));
                 // GOALS //
                 pm.addGoal(new AmDfsLabeling(Vars, new VarHeurCouples));
                 // SOLVING //
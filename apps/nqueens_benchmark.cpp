@@ -0,0 +1,47 @@
+// Part of https://github.com/pothitos/naxos
+
+#include <ctime>
+#include <cstdlib>
+#include <iostream>
+#include <naxos.h>
+
+using namespace naxos;
+using namespace std;
+
+/// Measures the search tree nodes explored per second while
+/// finding all the solutions of the N Queens problem
+int main(int argc, char* argv[])
+{
+        try {
+                int N = (argc > 1) ? atoi(argv[1]) : 12;
+                NsProblemManager pm;
+                NsIntVarArray Var, VarPlus, VarMinus;
+                for (int i = 0; i < N; ++i) {
+                        Var.push_back(NsIntVar(pm, 0, N - 1));
+                        VarPlus.push_back(Var[i] + i);
+                        VarMinus.push_back(Var[i] - i);
+                }
+                pm.add(NsAllDiff(Var));
+                pm.add(NsAllDiff(VarPlus));
+                pm.add(NsAllDiff(VarMinus));
+                pm.addGoal(new NsgLabeling(Var));
+                unsigned long nSolutions = 0;
+                clock_t start = clock();
+                while (pm.nextSolution() != false)
+                        ++nSolutions;
+                double secs = static_cast<double>(clock() - start) /
+                              CLOCKS_PER_SEC;
+                cout << "N\tSolutions\tNodes\tBacktracks\tSeconds\tNodes/sec\n"
+                     << N << "\t" << nSolutions << "\t"
+                     << pm.numSearchTreeNodes() << "\t" << pm.numBacktracks()
+                     << "\t" << secs << "\t"
+                     << ((secs > 0) ? pm.numSearchTreeNodes() / secs : 0)
+                     << "\n";
+        } catch (exception& exc) {
+                cerr << exc.what() << "\n";
+                return 1;
+        } catch (...) {
+                cerr << "Unknown exception\n";
+                return 1;
+        }
+}
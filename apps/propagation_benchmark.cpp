@@ -0,0 +1,115 @@
+// Part of https://github.com/pothitos/naxos
+
+#include <ctime>
+#include <cstdlib>
+#include <iostream>
+#include <naxos.h>
+
+using namespace naxos;
+using namespace std;
+
+namespace {
+
+/// N Queens with a global NsAllDiff per direction
+void queensAllDiff(NsProblemManager& pm, NsIntVarArray& Var,
+                   NsDeque<NsIntVarArray>& Aux, const int N)
+{
+        Aux.resize(2);
+        NsIntVarArray& VarPlus = Aux[0];
+        NsIntVarArray& VarMinus = Aux[1];
+        for (int i = 0; i < N; ++i) {
+                Var.push_back(NsIntVar(pm, 0, N - 1));
+                VarPlus.push_back(Var[i] + i);
+                VarMinus.push_back(Var[i] - i);
+        }
+        pm.add(NsAllDiff(Var));
+        pm.add(NsAllDiff(VarPlus));
+        pm.add(NsAllDiff(VarMinus));
+}
+
+/// N Queens with binary inequalities only
+void queensBinary(NsProblemManager& pm, NsIntVarArray& Var,
+                  NsDeque<NsIntVarArray>& /*Aux*/, const int N)
+{
+        for (int i = 0; i < N; ++i)
+                Var.push_back(NsIntVar(pm, 0, N - 1));
+        for (int i = 0; i < N; ++i) {
+                for (int j = i + 1; j < N; ++j) {
+                        pm.add(Var[i] != Var[j]);
+                        pm.add(Var[i] != Var[j] + (j - i));
+                        pm.add(Var[i] != Var[j] - (j - i));
+                }
+        }
+}
+
+/// Magic series, with a sum and a count per value
+void magicSeries(NsProblemManager& pm, NsIntVarArray& Var,
+                 NsDeque<NsIntVarArray>& Aux, const int N)
+{
+        for (int i = 0; i < N; ++i)
+                Var.push_back(NsIntVar(pm, 0, N - 1));
+        Aux.resize(N + 1);
+        NsIntVarArray& Weighted = Aux[N];
+        for (int i = 0; i < N; ++i) {
+                NsIntVarArray& Occurrences = Aux[i];
+                for (int j = 0; j < N; ++j)
+                        Occurrences.push_back(Var[j] == i);
+                pm.add(Var[i] == NsSum(Occurrences));
+                Weighted.push_back(i * Var[i]);
+        }
+        pm.add(NsSum(Var) == N);
+        pm.add(NsSum(Weighted) == N);
+}
+
+/// Finds all the solutions of a model with the given engine
+void run(const char* name,
+         void (*model)(NsProblemManager&, NsIntVarArray&,
+                       NsDeque<NsIntVarArray>&, const int),
+         const int N, const NsProblemManager::PropagationEngine engine)
+{
+        NsProblemManager pm;
+        pm.propagationEngine(engine);
+        NsIntVarArray Var;
+        // The arrays of the constraints should live during the search
+        NsDeque<NsIntVarArray> Aux;
+        model(pm, Var, Aux, N);
+        pm.addGoal(new NsgLabeling(Var));
+        unsigned long nSolutions = 0;
+        clock_t start = clock();
+        while (pm.nextSolution() != false)
+                ++nSolutions;
+        double secs = static_cast<double>(clock() - start) / CLOCKS_PER_SEC;
+        cout << name << "\t"
+             << ((engine == NsProblemManager::VARIABLE_QUEUE) ? "variables"
+                                                              : "constraints")
+             << "\t" << N << "\t" << nSolutions << "\t"
+             << pm.numSearchTreeNodes() << "\t" << pm.numConstraintChecks()
+             << "\t" << secs << "\n";
+}
+
+} // end namespace
+
+/// Compares the constraint checks and the time of the AC-5 engine,
+/// which queues the modified variables, with the engine that queues
+/// the constraints to revise
+int main(int argc, char* argv[])
+{
+        try {
+                int N = (argc > 1) ? atoi(argv[1]) : 10;
+                cout << "Model\tQueue\tN\tSolutions\tNodes\tChecks\tSeconds\n";
+                for (int e = NsProblemManager::VARIABLE_QUEUE;
+                     e <= NsProblemManager::CONSTRAINT_QUEUE; ++e) {
+                        NsProblemManager::PropagationEngine engine =
+                            static_cast<NsProblemManager::PropagationEngine>(e);
+                        run("queens_alldiff", queensAllDiff, N, engine);
+                        run("queens_binary", queensBinary, N, engine);
+                        run("magic_series", magicSeries, 5 * N, engine);
+                }
+        } catch (exception& exc) {
+                cerr << exc.what() << "\n";
+                return 1;
+        } catch (...) {
+                cerr << "Unknown exception\n";
+                return 1;
+        }
+}
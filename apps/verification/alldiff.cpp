@@ -0,0 +1,80 @@
+// Part of https://github.com/pothitos/naxos
+//
+// Compares the solutions of NsAllDiff with NsALLDIFF_DOMAINS with the
+// ones of a brute force search, and checks that its initial
+// propagation removes every value that belongs to no solution
+
+#include "compare.h"
+
+using namespace std;
+using namespace naxos;
+
+namespace {
+
+const unsigned INSTANCES = 40;
+
+struct Instance {
+
+        Domains domains;
+
+        Solutions expected;
+};
+
+bool satisfies(const Instance& /*data*/, const vector<NsInt>& assignment)
+{
+        set<NsInt> values(assignment.begin(), assignment.end());
+        return (values.size() == assignment.size());
+}
+
+/// Small domains with holes, where Hall sets of interior values
+/// are frequent
+Domains sparseDomains(Instances& random, const NsInt n)
+{
+        Domains doms(n);
+        for (NsInt i = 0; i < n; ++i) {
+                while (doms[i].size() < 2) {
+                        doms[i].clear();
+                        for (NsInt val = 0; val <= n; ++val)
+                                if (random.between(0, 2) == 0)
+                                        doms[i].push_back(val);
+                }
+        }
+        return doms;
+}
+
+void post(Model& m, const Instance& data)
+{
+        for (unsigned i = 0; i < data.domains.size(); ++i)
+                addVar(m.pm, m.Vars, data.domains[i]);
+        m.pm.add(NsAllDiff(m.Vars, NsALLDIFF_DOMAINS));
+}
+
+void generate(Instances& random, const unsigned /*instance*/, Instance& data)
+{
+        data.domains = sparseDomains(random, random.between(3, 8));
+        data.expected = bruteForce(data.domains, data, satisfies);
+}
+
+bool check(const Instance& data, const unsigned instance, const Engine engine)
+{
+        bool passed = true;
+        Model model(engine);
+        post(model, data);
+        if (!same("NsALLDIFF_DOMAINS", instance, data.expected,
+                  solutions(model)))
+                passed = false;
+        Model root(engine);
+        post(root, data);
+        if (!same("NsALLDIFF_DOMAINS propagation", instance,
+                  projection(data.expected, data.domains.size()),
+                  rootDomains(root)))
+                passed = false;
+        return passed;
+}
+
+} // end namespace
+
+int main(void)
+{
+        return verify(INSTANCES, generate, check);
+}
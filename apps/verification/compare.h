@@ -0,0 +1,357 @@
+// Part of https://github.com/pothitos/naxos
+//
+// Common code of the verification programs, which compare the
+// solutions of a constraint with the ones of its decomposition
+
+#ifndef Ns_VERIFICATION_COMPARE_H
+#define Ns_VERIFICATION_COMPARE_H
+
+#include <algorithm>
+#include <iostream>
+#include <naxos.h>
+#include <random>
+#include <set>
+#include <vector>
+
+typedef naxos::NsProblemManager::PropagationEngine Engine;
+
+/// The two propagation engines, which should give the same solutions
+const Engine engines[] = {naxos::NsProblemManager::VARIABLE_QUEUE,
+                          naxos::NsProblemManager::CONSTRAINT_QUEUE};
+
+const unsigned N_ENGINES = sizeof(engines) / sizeof(engines[0]);
+
+/// A problem whose solutions are compared with the ones of another
+struct Model {
+
+        /// The arrays of the intermediate variables, which should
+        /// exist while searching
+        naxos::NsList<naxos::NsIntVarArray> arrays;
+
+        /// The variables whose values constitute a solution
+        naxos::NsIntVarArray Vars;
+
+        /// It is declared last, in order to be destroyed first
+        naxos::NsProblemManager pm;
+
+        explicit Model(const Engine engine)
+        {
+                pm.propagationEngine(engine);
+        }
+
+        naxos::NsIntVarArray& newArray(void)
+        {
+                arrays.push_back(naxos::NsIntVarArray());
+                return arrays.back();
+        }
+};
+
+typedef std::set<std::vector<naxos::NsInt>> Solutions;
+
+/// Labels the variables of the model and returns all its solutions
+inline Solutions solutions(Model& model)
+{
+        model.pm.addGoal(new naxos::NsgLabeling(model.Vars));
+        Solutions found;
+        while (model.pm.nextSolution() != false) {
+                std::vector<naxos::NsInt> solution;
+                for (naxos::NsIndex i = 0; i < model.Vars.size(); ++i)
+                        solution.push_back(model.Vars[i].value());
+                found.insert(solution);
+        }
+        return found;
+}
+
+/// Returns the minimum of Cost, or NsPLUS_INF if there is no solution
+inline naxos::NsInt minimum(Model& model, naxos::NsIntVar& Cost)
+{
+        model.pm.minimize(Cost);
+        model.pm.addGoal(new naxos::NsgLabeling(model.Vars));
+        naxos::NsInt best = naxos::NsPLUS_INF;
+        while (model.pm.nextSolution() != false)
+                best = Cost.value();
+        return best;
+}
+
+/// The course of a search: the index and the domain size of each
+/// variable that it chose to label, in order, and a -1 for each
+/// solution that it found
+typedef std::vector<naxos::NsInt> SearchTree;
+
+/// Chooses the next variable to label, or returns NsINDEX_INF if
+/// every variable is bound
+typedef naxos::NsIndex (*VarChooser)(const naxos::NsIntVarArray& VarArr);
+
+/// Chooses the variable that NsgLabeling chooses by default
+inline naxos::NsIndex firstFail(const naxos::NsIntVarArray& VarArr)
+{
+        return VarArr.firstFailIndex();
+}
+
+/// Labels the variables like NsgLabeling, but via choose(), and
+/// records the choices into 'tree'
+class RecordedLabeling : public naxos::NsGoal {
+
+    private:
+        naxos::NsIntVarArray& VarArr;
+
+        VarChooser choose;
+
+        SearchTree& tree;
+
+    public:
+        RecordedLabeling(naxos::NsIntVarArray& VarArr_init,
+                         const VarChooser choose_init, SearchTree& tree_init)
+          : VarArr(VarArr_init), choose(choose_init), tree(tree_init)
+        {
+        }
+
+        naxos::NsGoal* GOAL(void)
+        {
+                naxos::NsIndex index = choose(VarArr);
+                if (index == naxos::NsINDEX_INF)
+                        return 0;
+                tree.push_back(index);
+                tree.push_back(VarArr[index].size());
+                return (new naxos::NsgAND(
+                    new naxos::NsgInDomain(VarArr[index]),
+                    new RecordedLabeling(*this)));
+        }
+};
+
+/// Labels the variables of the model via choose(), and returns the
+/// course of the search
+inline SearchTree searchTree(Model& model, const VarChooser choose)
+{
+        SearchTree tree;
+        model.pm.addGoal(new RecordedLabeling(model.Vars, choose, tree));
+        while (model.pm.nextSolution() != false)
+                tree.push_back(-1);
+        return tree;
+}
+
+typedef std::vector<std::vector<naxos::NsInt>> Domains;
+
+/// Generates the instances; the fixed seed reproduces them
+class Instances {
+
+    private:
+        std::minstd_rand generator;
+
+    public:
+        Instances(void) : generator(1)
+        {
+        }
+
+        /// A random integer in the range [min..max]
+        naxos::NsInt between(const naxos::NsInt min, const naxos::NsInt max)
+        {
+                return (min + static_cast<naxos::NsInt>(generator() %
+                                                         (max - min + 1)));
+        }
+
+        /// 'n' random domains with holes, inside [min..max]
+        Domains domains(const unsigned n, const naxos::NsInt min,
+                        const naxos::NsInt max)
+        {
+                Domains doms(n);
+                for (unsigned i = 0; i < n; ++i) {
+                        naxos::NsInt first = between(min, max);
+                        naxos::NsInt last = between(first, max);
+                        for (naxos::NsInt val = first; val <= last; ++val) {
+                                // The bounds are kept, to ensure that
+                                // the domain is not empty
+                                if (val == first || val == last ||
+                                    between(0, 3) != 0)
+                                        doms[i].push_back(val);
+                        }
+                }
+                return doms;
+        }
+};
+
+/// Appends to Arr a variable with the values of 'domain'
+inline void addVar(naxos::NsProblemManager& pm, naxos::NsIntVarArray& Arr,
+                   const std::vector<naxos::NsInt>& domain,
+                   const naxos::Ns_BitSet::Representation representation =
+                       naxos::Ns_BitSet::BIT_SET)
+{
+        Arr.push_back(naxos::NsIntVar(pm, domain.front(), domain.back(),
+                                      representation));
+        std::vector<naxos::NsInt>::const_iterator v = domain.begin();
+        for (naxos::NsInt val = domain.front(); val <= domain.back(); ++val) {
+                if (val == *v)
+                        ++v;
+                else
+                        Arr.back().remove(val);
+        }
+}
+
+/// Returns the current domains of the variables
+inline Domains domainsOf(naxos::NsIntVarArray& Arr)
+{
+        Domains doms(Arr.size());
+        for (naxos::NsIndex i = 0; i < Arr.size(); ++i)
+                for (naxos::NsIntVar::const_iterator v = Arr[i].begin();
+                     v != Arr[i].end(); ++v)
+                        doms[i].push_back(*v);
+        return doms;
+}
+
+/// Returns the domains after the initial propagation; they are
+/// empty if the propagation fails
+inline Domains rootDomains(Model& model)
+{
+        if (model.pm.nextSolution() == false)
+                return Domains(model.Vars.size());
+        return domainsOf(model.Vars);
+}
+
+/// Returns the assignments of 'domains' that satisfy the instance
+template <typename Instance>
+Solutions bruteForce(const Domains& domains, const Instance& data,
+                     bool (*satisfies)(const Instance&,
+                                       const std::vector<naxos::NsInt>&))
+{
+        Solutions found;
+        std::vector<naxos::NsInt> assignment(domains.size());
+        std::vector<std::size_t> position(domains.size(), 0);
+        for (;;) {
+                for (std::size_t i = 0; i < domains.size(); ++i) {
+                        if (domains[i].empty())
+                                return found;
+                        assignment[i] = domains[i][position[i]];
+                }
+                if (satisfies(data, assignment))
+                        found.insert(assignment);
+                // Moves to the next assignment, like an odometer
+                std::size_t i = 0;
+                while (i < domains.size() &&
+                       ++position[i] == domains[i].size()) {
+                        position[i] = 0;
+                        ++i;
+                }
+                if (i == domains.size())
+                        return found;
+        }
+}
+
+/// Returns the domains that consist of the values of the solutions
+inline Domains projection(const Solutions& found, const std::size_t n)
+{
+        std::vector<std::set<naxos::NsInt>> values(n);
+        for (Solutions::const_iterator s = found.begin(); s != found.end();
+             ++s)
+                for (std::size_t i = 0; i < n; ++i)
+                        values[i].insert((*s)[i]);
+        Domains doms(n);
+        for (std::size_t i = 0; i < n; ++i)
+                doms[i].assign(values[i].begin(), values[i].end());
+        return doms;
+}
+
+/// Reports whether the expected domains of an instance were found
+inline bool same(const char* check, const unsigned instance,
+                 const Domains& expected, const Domains& found)
+{
+        if (found == expected)
+                return true;
+        std::cerr << check << ": Instance " << instance
+                  << " has different domains\n";
+        return false;
+}
+
+/// Reports whether the domains that were found contain the 'inner'
+/// ones and are contained in the 'outer' ones
+///
+/// It checks a propagation that is not complete: it should keep the
+/// supported values and prune at least as much as a weaker one.
+inline bool within(const char* check, const unsigned instance,
+                   const Domains& inner, const Domains& found,
+                   const Domains& outer)
+{
+        for (std::size_t i = 0; i < found.size(); ++i) {
+                if (!std::includes(found[i].begin(), found[i].end(),
+                                   inner[i].begin(), inner[i].end()) ||
+                    !std::includes(outer[i].begin(), outer[i].end(),
+                                   found[i].begin(), found[i].end())) {
+                        std::cerr << check << ": Instance " << instance
+                                  << " has domains out of range\n";
+                        return false;
+                }
+        }
+        return true;
+}
+
+/// Reports whether the expected solutions of an instance were found
+inline bool same(const char* check, const unsigned instance,
+                 const Solutions& expected, const Solutions& found)
+{
+        if (found == expected)
+                return true;
+        std::cerr << check << ": Instance " << instance << " has ";
+        if (found.size() == expected.size())
+                std::cerr << "different solutions\n";
+        else
+                std::cerr << found.size() << " solutions instead of "
+                          << expected.size() << "\n";
+        return false;
+}
+
+/// Reports whether a search made the expected choices
+inline bool same(const char* check, const unsigned instance,
+                 const SearchTree& expected, const SearchTree& found)
+{
+        if (found == expected)
+                return true;
+        std::cerr << check << ": Instance " << instance
+                  << " has a different search tree\n";
+        return false;
+}
+
+/// Reports whether the expected optimum of an instance was found
+inline bool same(const char* check, const unsigned instance,
+                 const naxos::NsInt expected, const naxos::NsInt found)
+{
+        if (found == expected)
+                return true;
+        std::cerr << check << ": Instance " << instance << " has optimum "
+                  << found << " instead of " << expected << "\n";
+        return false;
+}
+
+/// Verifies 'nInstances' random instances with each engine
+///
+/// generate() creates an instance together with its expected
+/// results, and check() compares them with the results of an
+/// engine, reporting the differences. Returns the exit status of
+/// the verification program.
+template <typename Instance>
+int verify(const unsigned nInstances,
+           void (*generate)(Instances& random, const unsigned instance,
+                            Instance& data),
+           bool (*check)(const Instance& data, const unsigned instance,
+                         const Engine engine))
+{
+        try {
+                bool passed = true;
+                Instances random;
+                for (unsigned instance = 0; instance < nInstances;
+                     ++instance) {
+                        Instance data;
+                        generate(random, instance, data);
+                        for (unsigned e = 0; e < N_ENGINES; ++e) {
+                                if (!check(data, instance, engines[e]))
+                                        passed = false;
+                        }
+                }
+                return (passed ? 0 : 1);
+        } catch (std::exception& exc) {
+                std::cerr << exc.what() << "\n";
+        } catch (...) {
+                std::cerr << "Unknown exception\n";
+        }
+        return 1;
+}
+
+#endif // Ns_VERIFICATION_COMPARE_H
@@ -0,0 +1,113 @@
+// Part of https://github.com/pothitos/naxos
+//
+// Compares the solutions of NsCount, for every consistency, with the
+// ones of a brute force search, and checks that the initial
+// propagation of NsCOUNT_DOMAINS removes every value that belongs to
+// no solution
+
+#include "compare.h"
+#include <algorithm>
+
+using namespace std;
+using namespace naxos;
+
+namespace {
+
+const unsigned INSTANCES = 40;
+
+const NsCountConsistency consistencies[] = {NsCOUNT_VALUES, NsCOUNT_BOUNDS,
+                                            NsCOUNT_DOMAINS};
+
+const char* names[] = {"NsCOUNT_VALUES", "NsCOUNT_BOUNDS", "NsCOUNT_DOMAINS"};
+
+const unsigned N_CONSISTENCIES =
+    sizeof(consistencies) / sizeof(consistencies[0]);
+
+struct Instance {
+
+        Domains domains;
+
+        NsDeque<NsInt> values;
+
+        /// They sum up to the number of the variables
+        NsDeque<NsInt> occurrences;
+
+        Solutions expected;
+};
+
+bool satisfies(const Instance& data, const vector<NsInt>& assignment)
+{
+        for (NsIndex i = 0; i < data.values.size(); ++i)
+                if (count(assignment.begin(), assignment.end(),
+                          data.values[i]) != data.occurrences[i])
+                        return false;
+        return true;
+}
+
+/// Distinct values with random occurrences that sum up to 'n'
+void randomValues(Instances& random, Instance& data, const NsInt n)
+{
+        for (NsInt val = 0; val <= 4; ++val)
+                if (random.between(0, 1) == 0)
+                        data.values.push_back(val);
+        if (data.values.empty())
+                data.values.push_back(random.between(0, 4));
+        data.occurrences.assign(data.values.size(), 0);
+        for (NsInt i = 0; i < n; ++i)
+                ++data.occurrences[random.between(0, data.values.size() - 1)];
+}
+
+/// Domains with holes, which may contain values that are not counted
+Domains sparseDomains(Instances& random, const NsInt n)
+{
+        Domains doms(n);
+        for (NsInt i = 0; i < n; ++i) {
+                while (doms[i].empty()) {
+                        for (NsInt val = -1; val <= 5; ++val)
+                                if (random.between(0, 1) == 0)
+                                        doms[i].push_back(val);
+                }
+        }
+        return doms;
+}
+
+void post(Model& m, const Instance& data, const NsCountConsistency consistency)
+{
+        for (unsigned i = 0; i < data.domains.size(); ++i)
+                addVar(m.pm, m.Vars, data.domains[i]);
+        m.pm.add(NsCount(m.Vars, data.values, data.occurrences, consistency));
+}
+
+void generate(Instances& random, const unsigned /*instance*/, Instance& data)
+{
+        NsInt n = random.between(3, 7);
+        data.domains = sparseDomains(random, n);
+        randomValues(random, data, n);
+        data.expected = bruteForce(data.domains, data, satisfies);
+}
+
+bool check(const Instance& data, const unsigned instance, const Engine engine)
+{
+        bool passed = true;
+        for (unsigned c = 0; c < N_CONSISTENCIES; ++c) {
+                Model model(engine);
+                post(model, data, consistencies[c]);
+                if (!same(names[c], instance, data.expected,
+                          solutions(model)))
+                        passed = false;
+        }
+        Model root(engine);
+        post(root, data, NsCOUNT_DOMAINS);
+        if (!same("NsCOUNT_DOMAINS propagation", instance,
+                  projection(data.expected, data.domains.size()),
+                  rootDomains(root)))
+                passed = false;
+        return passed;
+}
+
+} // end namespace
+
+int main(void)
+{
+        return verify(INSTANCES, generate, check);
+}
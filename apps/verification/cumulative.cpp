@@ -0,0 +1,148 @@
+// Part of https://github.com/pothitos/naxos
+//
+// Compares the solutions of NsCumulative, with and without
+// edge-finding, with the ones of a brute force search that sums up
+// the demands at each time. It also compares the initial propagation
+// with time-tabling computed value by value.
+
+#include "compare.h"
+#include <algorithm>
+
+using namespace std;
+using namespace naxos;
+
+namespace {
+
+const unsigned INSTANCES = 40;
+
+struct Instance {
+
+        /// The domains of the starts
+        Domains domains;
+
+        NsDeque<NsInt> durations;
+
+        NsDeque<NsInt> demands;
+
+        NsInt capacity;
+
+        Solutions expected;
+
+        /// The domains after time-tabling
+        Domains timeTabled;
+};
+
+bool satisfies(const Instance& data, const vector<NsInt>& starts)
+{
+        NsInt end = 0;
+        for (NsIndex i = 0; i < starts.size(); ++i)
+                end = max(end, starts[i] + data.durations[i]);
+        for (NsInt time = 0; time < end; ++time) {
+                NsInt load = 0;
+                for (NsIndex i = 0; i < starts.size(); ++i)
+                        if (starts[i] <= time &&
+                            time < starts[i] + data.durations[i])
+                                load += data.demands[i];
+                if (load > data.capacity)
+                        return false;
+        }
+        return true;
+}
+
+/// Whether the i-th task fits when it starts at 'start', together
+/// with the compulsory parts of the others
+bool fits(const Instance& data, const Domains& domains, const NsIndex i,
+          const NsInt start)
+{
+        for (NsInt time = start; time < start + data.durations[i]; ++time) {
+                NsInt load = data.demands[i];
+                for (NsIndex j = 0; j < domains.size(); ++j)
+                        if (j != i && domains[j].back() <= time &&
+                            time < domains[j].front() + data.durations[j])
+                                load += data.demands[j];
+                if (load > data.capacity)
+                        return false;
+        }
+        return true;
+}
+
+/// Removes the bounds of the starts where the tasks do not fit, until
+/// nothing changes; the domains are empty if one of them is emptied
+Domains timeTabling(const Instance& data)
+{
+        Domains domains(data.domains);
+        bool modified;
+        do {
+                modified = false;
+                for (NsIndex i = 0; i < domains.size(); ++i) {
+                        vector<NsInt>& d = domains[i];
+                        while (!d.empty() && !fits(data, domains, i, d[0])) {
+                                d.erase(d.begin());
+                                modified = true;
+                        }
+                        while (!d.empty() &&
+                               !fits(data, domains, i, d.back())) {
+                                d.pop_back();
+                                modified = true;
+                        }
+                        if (d.empty())
+                                return Domains(domains.size());
+                }
+        } while (modified);
+        return domains;
+}
+
+void post(Model& m, const Instance& data, const bool edgeFinding)
+{
+        for (unsigned i = 0; i < data.domains.size(); ++i)
+                addVar(m.pm, m.Vars, data.domains[i]);
+        m.pm.add(NsCumulative(m.Vars, data.durations, data.demands,
+                              data.capacity, edgeFinding));
+}
+
+void generate(Instances& random, const unsigned /*instance*/, Instance& data)
+{
+        NsInt n = random.between(2, 5);
+        data.domains = random.domains(n, 0, 6);
+        for (NsInt i = 0; i < n; ++i) {
+                data.durations.push_back(random.between(0, 4));
+                data.demands.push_back(random.between(0, 3));
+        }
+        data.capacity = random.between(1, 4);
+        data.expected = bruteForce(data.domains, data, satisfies);
+        data.timeTabled = timeTabling(data);
+}
+
+bool check(const Instance& data, const unsigned instance, const Engine engine)
+{
+        bool passed = true;
+        Model model(engine);
+        post(model, data, false);
+        if (!same("NsCumulative", instance, data.expected, solutions(model)))
+                passed = false;
+        Model edgeFinding(engine);
+        post(edgeFinding, data, true);
+        if (!same("NsCumulative edge-finding", instance, data.expected,
+                  solutions(edgeFinding)))
+                passed = false;
+        Model root(engine);
+        post(root, data, false);
+        if (!same("NsCumulative propagation", instance, data.timeTabled,
+                  rootDomains(root)))
+                passed = false;
+        // Edge-finding prunes at least as much as time-tabling
+        Model edgeFindingRoot(engine);
+        post(edgeFindingRoot, data, true);
+        if (!within("NsCumulative edge-finding propagation", instance,
+                    projection(data.expected, data.domains.size()),
+                    rootDomains(edgeFindingRoot), data.timeTabled))
+                passed = false;
+        return passed;
+}
+
+} // end namespace
+
+int main(void)
+{
+        return verify(INSTANCES, generate, check);
+}
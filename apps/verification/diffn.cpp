@@ -0,0 +1,160 @@
+// Part of https://github.com/pothitos/naxos
+//
+// Compares the solutions of NsDiffn with the ones of a brute force
+// search over the disjunctions of each pair of rectangles, some of
+// which have zero width or height. It also compares the initial
+// propagation with the sweep of the compulsory parts computed value
+// by value.
+
+#include "compare.h"
+
+using namespace std;
+using namespace naxos;
+
+namespace {
+
+const unsigned INSTANCES = 40;
+
+struct Instance {
+
+        /// The domains of the origins X[0], Y[0], X[1], Y[1], ...
+        Domains domains;
+
+        NsDeque<NsInt> widths;
+
+        NsDeque<NsInt> heights;
+
+        Solutions expected;
+
+        /// The domains after the sweep of the compulsory parts
+        Domains swept;
+};
+
+/// A rectangle of zero area does not overlap any other
+bool satisfies(const Instance& data, const vector<NsInt>& origins)
+{
+        for (NsIndex i = 0; i < data.widths.size(); ++i) {
+                for (NsIndex j = i + 1; j < data.widths.size(); ++j) {
+                        if (data.widths[i] == 0 || data.heights[i] == 0 ||
+                            data.widths[j] == 0 || data.heights[j] == 0)
+                                continue;
+                        NsInt xi = origins[2 * i], yi = origins[2 * i + 1];
+                        NsInt xj = origins[2 * j], yj = origins[2 * j + 1];
+                        if (!(xi + data.widths[i] <= xj ||
+                              xj + data.widths[j] <= xi ||
+                              yi + data.heights[i] <= yj ||
+                              yj + data.heights[j] <= yi))
+                                return false;
+                }
+        }
+        return true;
+}
+
+/// Whether the j-th rectangle, with its origin at (x, y), overlaps
+/// the compulsory part of another one
+bool forbidden(const Instance& data, const Domains& domains, const NsIndex j,
+               const NsInt x, const NsInt y)
+{
+        for (NsIndex i = 0; i < data.widths.size(); ++i) {
+                const vector<NsInt>& X = domains[2 * i];
+                const vector<NsInt>& Y = domains[2 * i + 1];
+                if (i != j && data.widths[i] > 0 && data.heights[i] > 0 &&
+                    X.back() < X.front() + data.widths[i] &&
+                    Y.back() < Y.front() + data.heights[i] &&
+                    X.back() < x + data.widths[j] &&
+                    x < X.front() + data.widths[i] &&
+                    Y.back() < y + data.heights[j] &&
+                    y < Y.front() + data.heights[i])
+                        return true;
+        }
+        return false;
+}
+
+/// Whether the v-th origin variable, at 'val', is forbidden for each
+/// value in the range of the other coordinate of its rectangle
+bool covered(const Instance& data, const Domains& domains, const NsIndex v,
+             const NsInt val)
+{
+        const vector<NsInt>& other = domains[v ^ 1];
+        for (NsInt w = other.front(); w <= other.back(); ++w) {
+                if (v % 2 == 0 ? !forbidden(data, domains, v / 2, val, w)
+                               : !forbidden(data, domains, v / 2, w, val))
+                        return false;
+        }
+        return true;
+}
+
+/// Removes the bounds of the origins that are covered, until nothing
+/// changes; the domains are empty if one of them is emptied
+Domains sweep(const Instance& data)
+{
+        Domains domains(data.domains);
+        bool modified;
+        do {
+                modified = false;
+                for (NsIndex v = 0; v < domains.size(); ++v) {
+                        if (data.widths[v / 2] == 0 || data.heights[v / 2] == 0)
+                                continue;
+                        vector<NsInt>& d = domains[v];
+                        while (!d.empty() && covered(data, domains, v, d[0])) {
+                                d.erase(d.begin());
+                                modified = true;
+                        }
+                        while (!d.empty() &&
+                               covered(data, domains, v, d.back())) {
+                                d.pop_back();
+                                modified = true;
+                        }
+                        if (d.empty())
+                                return Domains(domains.size());
+                }
+        } while (modified);
+        return domains;
+}
+
+void post(Model& m, const Instance& data)
+{
+        for (unsigned i = 0; i < data.domains.size(); ++i)
+                addVar(m.pm, m.Vars, data.domains[i]);
+        NsIntVarArray& X = m.newArray();
+        NsIntVarArray& Y = m.newArray();
+        for (NsIndex i = 0; i < m.Vars.size(); i += 2) {
+                X.push_back(m.Vars[i]);
+                Y.push_back(m.Vars[i + 1]);
+        }
+        m.pm.add(NsDiffn(X, Y, data.widths, data.heights));
+}
+
+void generate(Instances& random, const unsigned /*instance*/, Instance& data)
+{
+        NsInt n = random.between(2, 4);
+        data.domains = random.domains(2 * n, 0, 4);
+        for (NsInt i = 0; i < n; ++i) {
+                data.widths.push_back(random.between(0, 3));
+                data.heights.push_back(random.between(0, 3));
+        }
+        data.expected = bruteForce(data.domains, data, satisfies);
+        data.swept = sweep(data);
+}
+
+bool check(const Instance& data, const unsigned instance, const Engine engine)
+{
+        bool passed = true;
+        Model model(engine);
+        post(model, data);
+        if (!same("NsDiffn", instance, data.expected, solutions(model)))
+                passed = false;
+        Model root(engine);
+        post(root, data);
+        if (!same("NsDiffn propagation", instance, data.swept,
+                  rootDomains(root)))
+                passed = false;
+        return passed;
+}
+
+} // end namespace
+
+int main(void)
+{
+        return verify(INSTANCES, generate, check);
+}
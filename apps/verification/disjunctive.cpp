@@ -0,0 +1,84 @@
+// Part of https://github.com/pothitos/naxos
+//
+// Compares the solutions of NsDisjunctive with the ones of a brute
+// force search over the disjunctions of each pair of tasks, some of
+// which last zero time. It also checks that the initial propagation
+// prunes at least as much as the disjunctions.
+
+#include "compare.h"
+
+using namespace std;
+using namespace naxos;
+
+namespace {
+
+const unsigned INSTANCES = 40;
+
+struct Instance {
+
+        /// The domains of the starts
+        Domains domains;
+
+        NsDeque<NsInt> durations;
+
+        Solutions expected;
+};
+
+/// A task of zero duration may not start strictly inside another one
+bool satisfies(const Instance& data, const vector<NsInt>& starts)
+{
+        for (NsIndex i = 0; i < starts.size(); ++i)
+                for (NsIndex j = i + 1; j < starts.size(); ++j)
+                        if (!(starts[i] + data.durations[i] <= starts[j] ||
+                              starts[j] + data.durations[j] <= starts[i]))
+                                return false;
+        return true;
+}
+
+void post(Model& m, const Instance& data, const bool decomposed)
+{
+        for (unsigned i = 0; i < data.domains.size(); ++i)
+                addVar(m.pm, m.Vars, data.domains[i]);
+        if (!decomposed) {
+                m.pm.add(NsDisjunctive(m.Vars, data.durations));
+                return;
+        }
+        for (NsIndex i = 0; i < m.Vars.size(); ++i)
+                for (NsIndex j = i + 1; j < m.Vars.size(); ++j)
+                        m.pm.add(m.Vars[i] + data.durations[i] <= m.Vars[j] ||
+                                 m.Vars[j] + data.durations[j] <= m.Vars[i]);
+}
+
+void generate(Instances& random, const unsigned /*instance*/, Instance& data)
+{
+        NsInt n = random.between(2, 6);
+        data.domains = random.domains(n, 0, 9);
+        for (NsInt i = 0; i < n; ++i)
+                data.durations.push_back(random.between(0, 4));
+        data.expected = bruteForce(data.domains, data, satisfies);
+}
+
+bool check(const Instance& data, const unsigned instance, const Engine engine)
+{
+        bool passed = true;
+        Model model(engine);
+        post(model, data, false);
+        if (!same("NsDisjunctive", instance, data.expected, solutions(model)))
+                passed = false;
+        Model root(engine);
+        post(root, data, false);
+        Model decomposition(engine);
+        post(decomposition, data, true);
+        if (!within("NsDisjunctive propagation", instance,
+                    projection(data.expected, data.domains.size()),
+                    rootDomains(root), rootDomains(decomposition)))
+                passed = false;
+        return passed;
+}
+
+} // end namespace
+
+int main(void)
+{
+        return verify(INSTANCES, generate, check);
+}
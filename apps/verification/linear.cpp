@@ -0,0 +1,94 @@
+// Part of https://github.com/pothitos/naxos
+//
+// Compares the solutions and the optima of NsLinear with the ones of
+// a sum of products, on random weights and domains with holes
+
+#include "compare.h"
+
+using namespace std;
+using namespace naxos;
+
+namespace {
+
+const unsigned INSTANCES = 40;
+
+struct Instance {
+
+        Domains domains;
+
+        /// The weights, which may be negative or zero
+        NsDeque<NsInt> coeffs;
+
+        /// The domain of the weighted sum
+        vector<NsInt> sum;
+};
+
+/// Returns the weighted sum of the variables of the model
+NsIntVar& weightedSum(Model& m, const Instance& data, const bool decomposed)
+{
+        for (unsigned i = 0; i < data.domains.size(); ++i)
+                addVar(m.pm, m.Vars, data.domains[i]);
+        NsIntVarArray& Sum = m.newArray();
+        if (!decomposed) {
+                Sum.push_back(NsLinear(data.coeffs, m.Vars));
+                return Sum[0];
+        }
+        NsIntVarArray& Products = m.newArray();
+        for (NsIndex i = 0; i < m.Vars.size(); ++i)
+                Products.push_back(data.coeffs[i] * m.Vars[i]);
+        Sum.push_back(NsSum(Products));
+        return Sum[0];
+}
+
+/// Constrains the weighted sum into the domain of the instance
+void post(Model& m, const Instance& data, const bool decomposed)
+{
+        NsIntVar& Sum = weightedSum(m, data, decomposed);
+        NsIntVarArray& Limits = m.newArray();
+        addVar(m.pm, Limits, data.sum);
+        m.pm.add(Limits[0] == Sum);
+}
+
+/// Minimizes the weighted sum of pairwise different variables
+NsInt optimum(Model& m, const Instance& data, const bool decomposed)
+{
+        NsIntVar& Sum = weightedSum(m, data, decomposed);
+        for (NsIndex i = 0; i < m.Vars.size(); ++i)
+                for (NsIndex j = i + 1; j < m.Vars.size(); ++j)
+                        m.pm.add(m.Vars[i] != m.Vars[j]);
+        return minimum(m, Sum);
+}
+
+void generate(Instances& random, const unsigned /*instance*/, Instance& data)
+{
+        data.domains = random.domains(random.between(2, 5), -3, 4);
+        for (unsigned i = 0; i < data.domains.size(); ++i)
+                data.coeffs.push_back(random.between(-4, 4));
+        data.sum = random.domains(1, -12, 12)[0];
+}
+
+bool check(const Instance& data, const unsigned instance, const Engine engine)
+{
+        bool passed = true;
+        Model global(engine);
+        Model decomposition(engine);
+        post(global, data, false);
+        post(decomposition, data, true);
+        if (!same("NsLinear", instance, solutions(decomposition),
+                  solutions(global)))
+                passed = false;
+        Model globalOpt(engine);
+        Model decompositionOpt(engine);
+        if (!same("NsLinear minimum", instance,
+                  optimum(decompositionOpt, data, true),
+                  optimum(globalOpt, data, false)))
+                passed = false;
+        return passed;
+}
+
+} // end namespace
+
+int main(void)
+{
+        return verify(INSTANCES, generate, check);
+}
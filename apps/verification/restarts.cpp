@@ -0,0 +1,139 @@
+// Part of https://github.com/pothitos/naxos
+//
+// Checks that every restart policy, together with the nogoods it
+// records, proves the unsatisfiable problems and finds the optimal
+// solutions, and that a seed reproduces a search
+
+#include <iostream>
+#include <naxos.h>
+
+using namespace std;
+using namespace naxos;
+
+namespace {
+
+/// More backtracks mean that the search would not end
+const unsigned long BACKTRACK_LIMIT = 100000;
+
+struct Policy {
+
+        NsProblemManager::RestartPolicy policy;
+        unsigned long scale;
+        double factor;
+        const char* name;
+};
+
+const Policy policies[] = {
+    {NsProblemManager::LUBY, 1, 1, "LUBY 1"},
+    {NsProblemManager::GEOMETRIC, 1, 1.5, "GEOMETRIC 1 1.5"},
+    {NsProblemManager::GEOMETRIC, 1, 1, "GEOMETRIC 1 1"},
+    {NsProblemManager::FAIL_COUNT, 1, 1, "FAIL_COUNT 1"},
+};
+
+/// Places 'pigeons' pigeons into 'holes' holes, one pigeon per hole
+bool provesPigeonholes(const Policy& p, const int pigeons, const int holes)
+{
+        NsProblemManager pm;
+        NsIntVarArray Pigeon;
+        for (int i = 0; i < pigeons; ++i)
+                Pigeon.push_back(NsIntVar(pm, 0, holes - 1));
+        // Pairwise inequalities propagate less than NsAllDiff
+        for (int i = 0; i < pigeons; ++i)
+                for (int j = i + 1; j < pigeons; ++j)
+                        pm.add(Pigeon[i] != Pigeon[j]);
+        pm.restartPolicy(p.policy, p.scale, p.factor);
+        pm.backtrackLimit(BACKTRACK_LIMIT);
+        pm.addGoal(new NsgLabeling(Pigeon));
+        if (pm.nextSolution() != false) {
+                cerr << p.name << ": Pigeons share a hole\n";
+                return false;
+        }
+        if (pm.numBacktracks() >= BACKTRACK_LIMIT) {
+                cerr << p.name << ": Pigeonholes search did not end after "
+                     << pm.numRestarts() << " restarts and "
+                     << pm.numNogoods() << " nogoods\n";
+                return false;
+        }
+        return true;
+}
+
+/// Returns the minimum weighted sum of the N queens' columns
+///
+/// The number of the failures is stored into 'failures'.
+NsInt queensOptimum(const Policy* p, const int N, unsigned long& failures,
+                    const unsigned long seed = 1)
+{
+        NsProblemManager pm;
+        pm.randomSeed(seed);
+        NsIntVarArray Var, VarPlus, VarMinus, Weighted;
+        for (int i = 0; i < N; ++i) {
+                Var.push_back(NsIntVar(pm, 0, N - 1));
+                VarPlus.push_back(Var[i] + i);
+                VarMinus.push_back(Var[i] - i);
+                Weighted.push_back((i + 1) * Var[i]);
+        }
+        pm.add(NsAllDiff(Var));
+        pm.add(NsAllDiff(VarPlus));
+        pm.add(NsAllDiff(VarMinus));
+        NsIntVar Cost = NsSum(Weighted);
+        pm.minimize(Cost);
+        if (p != 0)
+                pm.restartPolicy(p->policy, p->scale, p->factor);
+        pm.backtrackLimit(BACKTRACK_LIMIT);
+        pm.addGoal(new NsgLabeling(Var, NsgLabeling::DOM_WDEG));
+        NsInt best = -1;
+        failures = 0;
+        while (pm.nextSolution() != false) {
+                for (int i = 0; i < N; ++i)
+                        for (int j = i + 1; j < N; ++j)
+                                if (Var[i].value() == Var[j].value() ||
+                                    Var[i].value() + i == Var[j].value() + j ||
+                                    Var[i].value() - i == Var[j].value() - j)
+                                        return -1;
+                best = Cost.value();
+        }
+        failures = pm.numFailures();
+        if (pm.numBacktracks() >= BACKTRACK_LIMIT)
+                return -1;
+        return best;
+}
+
+} // end namespace
+
+int main(void)
+{
+        try {
+                bool passed = true;
+                const int N = 8;
+                unsigned long failures, failuresAgain;
+                NsInt optimum = queensOptimum(0, N, failures);
+                for (unsigned i = 0; i < sizeof(policies) / sizeof(Policy);
+                     ++i) {
+                        if (!provesPigeonholes(policies[i], 6, 5))
+                                passed = false;
+                        NsInt best =
+                            queensOptimum(&policies[i], N, failures);
+                        if (best != optimum) {
+                                cerr << policies[i].name << ": " << N
+                                     << " queens optimum " << best
+                                     << " instead of " << optimum << "\n";
+                                passed = false;
+                        }
+                }
+                // The same seed should lead to the same search
+                queensOptimum(&policies[0], N, failures, 7);
+                queensOptimum(&policies[0], N, failuresAgain, 7);
+                if (failures != failuresAgain) {
+                        cerr << policies[0].name << ": " << failures << " and "
+                             << failuresAgain
+                             << " failures for the same seed\n";
+                        passed = false;
+                }
+                return (passed ? 0 : 1);
+        } catch (exception& exc) {
+                cerr << exc.what() << "\n";
+        } catch (...) {
+                cerr << "Unknown exception\n";
+        }
+        return 1;
+}
@@ -0,0 +1,153 @@
+// Part of https://github.com/pothitos/naxos
+//
+// Compares the search trees of the first-fail labeling, when the
+// variables are chosen via Ns_FirstFailHeap and via a linear scan,
+// and when the domains are bit-sets, sparse sets and interval lists
+
+#include "compare.h"
+
+using namespace std;
+using namespace naxos;
+
+namespace {
+
+const unsigned INSTANCES = 40;
+
+/// The values are multiplied by it, so that any two of them are
+/// farther than the 65536 values that a bit-set may span
+const NsInt SCALE = 70000;
+
+typedef vector<pair<NsIndex, NsIndex>> Pairs;
+
+struct Instance {
+
+        Domains domains;
+
+        /// The pairs of variables that should differ
+        Pairs different;
+
+        /// The pairs (i, j) where the i-th variable should be less
+        /// than the j-th
+        Pairs less;
+};
+
+/// The unbound variable with the smallest domain, found by scanning
+/// the array; ties are broken in favor of the smallest index
+NsIndex linearFirstFail(const NsIntVarArray& VarArr)
+{
+        NsIndex index = NsINDEX_INF;
+        for (NsIndex i = 0; i < VarArr.size(); ++i) {
+                if (!VarArr[i].isBound() &&
+                    (index == NsINDEX_INF ||
+                     VarArr[i].size() < VarArr[index].size()))
+                        index = i;
+        }
+        return index;
+}
+
+void postConstraints(Model& m, const Instance& data)
+{
+        for (Pairs::const_iterator p = data.different.begin();
+             p != data.different.end(); ++p)
+                m.pm.add(m.Vars[p->first] != m.Vars[p->second]);
+        for (Pairs::const_iterator p = data.less.begin(); p != data.less.end();
+             ++p)
+                m.pm.add(m.Vars[p->first] < m.Vars[p->second]);
+}
+
+void post(Model& m, const Instance& data,
+          const Ns_BitSet::Representation representation)
+{
+        for (unsigned i = 0; i < data.domains.size(); ++i)
+                addVar(m.pm, m.Vars, data.domains[i], representation);
+        postConstraints(m, data);
+}
+
+/// Posts the instance with its values multiplied by SCALE, so that
+/// the domains are stored as interval lists
+void postScaled(Model& m, const Instance& data)
+{
+        for (unsigned i = 0; i < data.domains.size(); ++i) {
+                const vector<NsInt>& domain = data.domains[i];
+                m.Vars.push_back(NsIntVar(m.pm, domain.front() * SCALE,
+                                          domain.back() * SCALE));
+                for (unsigned k = 1; k < domain.size(); ++k)
+                        m.Vars.back().remove(domain[k - 1] * SCALE + 1,
+                                             domain[k] * SCALE - 1);
+        }
+        postConstraints(m, data);
+}
+
+/// Multiplies the values of the solutions by SCALE
+Solutions scaled(const Solutions& found)
+{
+        Solutions result;
+        for (Solutions::const_iterator s = found.begin(); s != found.end();
+             ++s) {
+                vector<NsInt> solution(*s);
+                for (unsigned i = 0; i < solution.size(); ++i)
+                        solution[i] *= SCALE;
+                result.insert(solution);
+        }
+        return result;
+}
+
+void generate(Instances& random, const unsigned /*instance*/, Instance& data)
+{
+        NsInt n = random.between(3, 6);
+        data.domains = random.domains(n, 0, 4);
+        for (NsInt k = random.between(n, 3 * n); k > 0; --k) {
+                NsIndex i = random.between(0, n - 1);
+                NsIndex j = random.between(0, n - 1);
+                if (i == j)
+                        continue;
+                if (random.between(0, 2) == 0)
+                        data.less.push_back(make_pair(i, j));
+                else
+                        data.different.push_back(make_pair(i, j));
+        }
+}
+
+bool check(const Instance& data, const unsigned instance, const Engine engine)
+{
+        bool passed = true;
+        Model heap(engine);
+        Model linear(engine);
+        post(heap, data, Ns_BitSet::BIT_SET);
+        post(linear, data, Ns_BitSet::BIT_SET);
+        SearchTree expected = searchTree(linear, linearFirstFail);
+        if (!same("Ns_FirstFailHeap", instance, expected,
+                  searchTree(heap, firstFail)))
+                passed = false;
+        Model sparse(engine);
+        post(sparse, data, Ns_BitSet::SPARSE_SET);
+        if (!same("Ns_BitSet::SPARSE_SET", instance, expected,
+                  searchTree(sparse, firstFail)))
+                passed = false;
+        Model bitSetSolutions(engine);
+        Model sparseSolutions(engine);
+        post(bitSetSolutions, data, Ns_BitSet::BIT_SET);
+        post(sparseSolutions, data, Ns_BitSet::SPARSE_SET);
+        Solutions expectedSolutions = solutions(bitSetSolutions);
+        if (!same("Ns_BitSet::SPARSE_SET", instance, expectedSolutions,
+                  solutions(sparseSolutions)))
+                passed = false;
+        Model intervals(engine);
+        postScaled(intervals, data);
+        if (!same("Ns_BitSet::INTERVAL_LIST", instance, expected,
+                  searchTree(intervals, firstFail)))
+                passed = false;
+        Model intervalSolutions(engine);
+        postScaled(intervalSolutions, data);
+        if (!same("Ns_BitSet::INTERVAL_LIST", instance,
+                  scaled(expectedSolutions), solutions(intervalSolutions)))
+                passed = false;
+        return passed;
+}
+
+} // end namespace
+
+int main(void)
+{
+        return verify(INSTANCES, generate, check);
+}
@@ -0,0 +1,142 @@
+// Part of https://github.com/pothitos/naxos
+//
+// Posts equal tables onto several scopes, which may repeat a
+// variable, so that the constraints share their tuple stores and
+// indexes, and compares their solutions with the ones of a brute
+// force search
+
+#include "compare.h"
+
+using namespace std;
+using namespace naxos;
+
+namespace {
+
+const unsigned INSTANCES = 30;
+
+const unsigned ARITY = 3;
+
+/// The scopes of the table; the last one is for conflicts
+const unsigned SCOPES[][ARITY] = {{0, 1, 2}, {1, 2, 3}, {2, 0, 2}, {3, 3, 1}};
+
+const unsigned N_SCOPES = sizeof(SCOPES) / sizeof(SCOPES[0]);
+
+struct Instance {
+
+        Domains domains;
+
+        NsDeque<NsDeque<NsInt>> table;
+
+        set<vector<NsInt>> tuples;
+
+        Solutions expected;
+
+        /// The values of the table, posted with a repeated variable,
+        /// that have a support in it
+        Domains supported;
+};
+
+/// A dense table of random tuples, including values out of the
+/// domains
+void randomTable(Instances& random, Instance& data)
+{
+        NsInt density = random.between(2, 6);
+        for (NsInt x = -1; x <= 5; ++x) {
+                for (NsInt y = -1; y <= 5; ++y) {
+                        for (NsInt z = -1; z <= 5; ++z) {
+                                if (random.between(1, density) == 1)
+                                        continue;
+                                NsDeque<NsInt> tuple;
+                                tuple.push_back(x);
+                                tuple.push_back(y);
+                                tuple.push_back(z);
+                                data.table.push_back(tuple);
+                                data.tuples.insert(
+                                    vector<NsInt>(tuple.begin(), tuple.end()));
+                        }
+                }
+        }
+}
+
+bool inTable(const Instance& data, const vector<NsInt>& assignment,
+             const unsigned s)
+{
+        vector<NsInt> tuple;
+        for (unsigned i = 0; i < ARITY; ++i)
+                tuple.push_back(assignment[SCOPES[s][i]]);
+        return (data.tuples.count(tuple) != 0);
+}
+
+bool satisfies(const Instance& data, const vector<NsInt>& assignment)
+{
+        for (unsigned s = 0; s + 1 < N_SCOPES; ++s)
+                if (!inTable(data, assignment, s))
+                        return false;
+        return !inTable(data, assignment, N_SCOPES - 1);
+}
+
+/// The supports of the scope {2, 0, 2}, which repeats a variable
+bool satisfiesRepeated(const Instance& data, const vector<NsInt>& assignment)
+{
+        return inTable(data, assignment, 2);
+}
+
+NsIntVarArray& scope(Model& m, const unsigned s)
+{
+        NsIntVarArray& Scope = m.newArray();
+        for (unsigned i = 0; i < ARITY; ++i)
+                Scope.push_back(m.Vars[SCOPES[s][i]]);
+        return Scope;
+}
+
+void post(Model& m, const Instance& data)
+{
+        for (unsigned i = 0; i < data.domains.size(); ++i)
+                addVar(m.pm, m.Vars, data.domains[i]);
+        // Each constraint gets an equal copy of the table, which is
+        // modified after posting, as the constraints keep their own
+        NsDeque<NsDeque<NsInt>> table(data.table);
+        for (unsigned s = 0; s + 1 < N_SCOPES; ++s) {
+                m.pm.add(NsSupports(scope(m, s), table));
+                table.back().back() = NsSTAR;
+                table = data.table;
+        }
+        m.pm.add(NsConflicts(scope(m, N_SCOPES - 1), table));
+        table.clear();
+}
+
+void generate(Instances& random, const unsigned /*instance*/, Instance& data)
+{
+        data.domains = random.domains(4, -1, 5);
+        randomTable(random, data);
+        data.expected = bruteForce(data.domains, data, satisfies);
+        Domains firstThree(data.domains.begin(),
+                           data.domains.begin() + ARITY);
+        data.supported = projection(
+            bruteForce(firstThree, data, satisfiesRepeated), ARITY);
+}
+
+bool check(const Instance& data, const unsigned instance, const Engine engine)
+{
+        bool passed = true;
+        Model model(engine);
+        post(model, data);
+        if (!same("Shared tables", instance, data.expected, solutions(model)))
+                passed = false;
+        // The repeated variable propagation
+        Model single(engine);
+        for (unsigned i = 0; i < ARITY; ++i)
+                addVar(single.pm, single.Vars, data.domains[i]);
+        single.pm.add(NsSupports(scope(single, 2), data.table));
+        if (!same("Shared tables", instance, data.supported,
+                  rootDomains(single)))
+                passed = false;
+        return passed;
+}
+
+} // end namespace
+
+int main(void)
+{
+        return verify(INSTANCES, generate, check);
+}
@@ -0,0 +1,163 @@
+// Part of https://github.com/pothitos/naxos
+//
+// Compares the solutions of short tables, having NsSTAR cells, and
+// of compressed tables, having sets of values as cells, with the ones
+// of a brute force search
+
+#include "compare.h"
+#include <algorithm>
+
+using namespace std;
+using namespace naxos;
+
+namespace {
+
+const unsigned INSTANCES = 40;
+
+/// The supports are posted onto the variables [0..2] and the
+/// conflicts onto [1..3]
+const unsigned ARITY = 3;
+
+typedef NsDeque<NsDeque<NsDeque<NsInt>>> Compressed;
+
+struct Instance {
+
+        Domains domains;
+
+        /// True for the short tables, whose cells are single values
+        bool isShort;
+
+        /// The supports and the conflicts
+        Compressed tables[2];
+
+        Solutions expected;
+
+        /// The values of the supports that have a support in them
+        Domains supported;
+};
+
+/// A random cell, which may be a star or contain repeated values
+NsDeque<NsInt> randomCell(Instances& random, const bool isShort)
+{
+        NsDeque<NsInt> cell;
+        if (random.between(1, 4) == 1) {
+                cell.push_back(NsSTAR);
+                return cell;
+        }
+        NsInt size = (isShort ? 1 : random.between(1, 4));
+        for (NsInt i = 0; i < size; ++i)
+                cell.push_back(random.between(-1, 5));
+        return cell;
+}
+
+Compressed randomTable(Instances& random, const bool isShort,
+                       const NsInt nTuples)
+{
+        Compressed table(nTuples);
+        for (NsInt t = 0; t < nTuples; ++t)
+                for (unsigned i = 0; i < ARITY; ++i)
+                        table[t].push_back(randomCell(random, isShort));
+        return table;
+}
+
+/// The cells of a short table, which are single values
+NsDeque<NsDeque<NsInt>> shortTable(const Compressed& table)
+{
+        NsDeque<NsDeque<NsInt>> plain(table.size());
+        for (NsIndex t = 0; t < table.size(); ++t)
+                for (unsigned i = 0; i < ARITY; ++i)
+                        plain[t].push_back(table[t][i][0]);
+        return plain;
+}
+
+bool matches(const NsDeque<NsInt>& cell, const NsInt val)
+{
+        return (find(cell.begin(), cell.end(), NsSTAR) != cell.end() ||
+                find(cell.begin(), cell.end(), val) != cell.end());
+}
+
+/// True if a tuple of 'table' matches the variables [first..]
+bool inTable(const Compressed& table, const vector<NsInt>& assignment,
+             const unsigned first)
+{
+        for (NsIndex t = 0; t < table.size(); ++t) {
+                unsigned i = 0;
+                while (i < ARITY && matches(table[t][i], assignment[first + i]))
+                        ++i;
+                if (i == ARITY)
+                        return true;
+        }
+        return false;
+}
+
+bool satisfies(const Instance& data, const vector<NsInt>& assignment)
+{
+        return (inTable(data.tables[0], assignment, 0) &&
+                !inTable(data.tables[1], assignment, 1));
+}
+
+bool isSupported(const Instance& data, const vector<NsInt>& assignment)
+{
+        return inTable(data.tables[0], assignment, 0);
+}
+
+/// Posts the supports and, if 'withConflicts', the conflicts
+void post(Model& m, const Instance& data, const bool withConflicts)
+{
+        for (unsigned i = 0; i < ARITY + withConflicts; ++i)
+                addVar(m.pm, m.Vars, data.domains[i]);
+        NsIntVarArray& Scope = m.newArray();
+        for (unsigned i = 0; i < ARITY; ++i)
+                Scope.push_back(m.Vars[i]);
+        if (data.isShort)
+                m.pm.add(NsSupports(Scope, shortTable(data.tables[0])));
+        else
+                m.pm.add(NsSupports(Scope, data.tables[0]));
+        if (!withConflicts)
+                return;
+        NsIntVarArray& ConflictsScope = m.newArray();
+        for (unsigned i = 1; i <= ARITY; ++i)
+                ConflictsScope.push_back(m.Vars[i]);
+        if (data.isShort)
+                m.pm.add(NsConflicts(ConflictsScope,
+                                     shortTable(data.tables[1])));
+        else
+                m.pm.add(NsConflicts(ConflictsScope, data.tables[1]));
+}
+
+void generate(Instances& random, const unsigned instance, Instance& data)
+{
+        data.domains = random.domains(ARITY + 1, 0, 4);
+        data.isShort = (instance % 2 == 0);
+        data.tables[0] =
+            randomTable(random, data.isShort, random.between(1, 30));
+        data.tables[1] =
+            randomTable(random, data.isShort, random.between(1, 8));
+        data.expected = bruteForce(data.domains, data, satisfies);
+        Domains first(data.domains.begin(), data.domains.begin() + ARITY);
+        data.supported =
+            projection(bruteForce(first, data, isSupported), ARITY);
+}
+
+bool check(const Instance& data, const unsigned instance, const Engine engine)
+{
+        bool passed = true;
+        const char* name =
+            (data.isShort ? "Short tables" : "Compressed tables");
+        Model model(engine);
+        post(model, data, true);
+        if (!same(name, instance, data.expected, solutions(model)))
+                passed = false;
+        Model single(engine);
+        post(single, data, false);
+        if (!same(name, instance, data.supported, rootDomains(single)))
+                passed = false;
+        return passed;
+}
+
+} // end namespace
+
+int main(void)
+{
+        return verify(INSTANCES, generate, check);
+}
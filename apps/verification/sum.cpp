@@ -0,0 +1,61 @@
+// Part of https://github.com/pothitos/naxos
+//
+// Compares the solutions of NsSum with the ones of a chain of
+// additions, on random domains with holes
+
+#include "compare.h"
+
+using namespace std;
+using namespace naxos;
+
+namespace {
+
+const unsigned INSTANCES = 40;
+
+struct Instance {
+
+        Domains domains;
+
+        /// The domain of the sum
+        vector<NsInt> sum;
+};
+
+void post(Model& m, const Instance& data, const bool decomposed)
+{
+        for (unsigned i = 0; i < data.domains.size(); ++i)
+                addVar(m.pm, m.Vars, data.domains[i]);
+        NsIntVarArray& Sum = m.newArray();
+        addVar(m.pm, Sum, data.sum);
+        if (!decomposed) {
+                m.pm.add(Sum[0] == NsSum(m.Vars));
+                return;
+        }
+        NsIntVarArray& Partial = m.newArray();
+        Partial.push_back(m.Vars[0] + 0);
+        for (NsIndex i = 1; i < m.Vars.size(); ++i)
+                Partial.push_back(Partial[i - 1] + m.Vars[i]);
+        m.pm.add(Sum[0] == Partial.back());
+}
+
+void generate(Instances& random, const unsigned /*instance*/, Instance& data)
+{
+        data.domains = random.domains(random.between(2, 6), -3, 4);
+        data.sum = random.domains(1, -6, 10)[0];
+}
+
+bool check(const Instance& data, const unsigned instance, const Engine engine)
+{
+        Model global(engine);
+        Model decomposition(engine);
+        post(global, data, false);
+        post(decomposition, data, true);
+        return same("NsSum", instance, solutions(decomposition),
+                    solutions(global));
+}
+
+} // end namespace
+
+int main(void)
+{
+        return verify(INSTANCES, generate, check);
+}
@@ -0,0 +1,114 @@
+// Part of https://github.com/pothitos/naxos
+//
+// Compares the solutions of NsSupports with the ones of a brute
+// force search, and checks that its initial propagation removes all
+// the values without a support
+
+#include "compare.h"
+
+using namespace std;
+using namespace naxos;
+
+namespace {
+
+const unsigned INSTANCES = 30;
+
+/// The tables are posted onto the variables [0..2] and [1..3]
+const unsigned ARITY = 3;
+
+struct Instance {
+
+        Domains domains;
+
+        NsDeque<NsDeque<NsInt>> tables[2];
+
+        set<vector<NsInt>> tuples[2];
+
+        Solutions expected;
+
+        /// The values of the first table that have a support in it
+        Domains supported;
+};
+
+/// A table of random tuples, including values out of the domains
+void randomTable(Instances& random, Instance& data, const unsigned t)
+{
+        NsInt sparsity = random.between(1, 6);
+        for (NsInt x = -1; x <= 5; ++x) {
+                for (NsInt y = -1; y <= 5; ++y) {
+                        for (NsInt z = -1; z <= 5; ++z) {
+                                if (random.between(1, sparsity) != 1)
+                                        continue;
+                                NsDeque<NsInt> tuple;
+                                tuple.push_back(x);
+                                tuple.push_back(y);
+                                tuple.push_back(z);
+                                data.tables[t].push_back(tuple);
+                                data.tuples[t].insert(
+                                    vector<NsInt>(tuple.begin(), tuple.end()));
+                        }
+                }
+        }
+}
+
+bool satisfies(const Instance& data, const vector<NsInt>& assignment)
+{
+        for (unsigned t = 0; t < 2; ++t) {
+                vector<NsInt> tuple(assignment.begin() + t,
+                                    assignment.begin() + t + ARITY);
+                if (data.tuples[t].count(tuple) == 0)
+                        return false;
+        }
+        return true;
+}
+
+bool satisfiesFirst(const Instance& data, const vector<NsInt>& assignment)
+{
+        return (data.tuples[0].count(assignment) != 0);
+}
+
+/// Posts the first 'nTables' tables onto the variables
+void post(Model& m, const Instance& data, const unsigned nTables)
+{
+        for (unsigned i = 0; i < ARITY + nTables - 1; ++i)
+                addVar(m.pm, m.Vars, data.domains[i]);
+        for (unsigned t = 0; t < nTables; ++t) {
+                NsIntVarArray& Scope = m.newArray();
+                for (unsigned i = t; i < t + ARITY; ++i)
+                        Scope.push_back(m.Vars[i]);
+                m.pm.add(NsSupports(Scope, data.tables[t]));
+        }
+}
+
+void generate(Instances& random, const unsigned /*instance*/, Instance& data)
+{
+        data.domains = random.domains(ARITY + 1, 0, 4);
+        randomTable(random, data, 0);
+        randomTable(random, data, 1);
+        data.expected = bruteForce(data.domains, data, satisfies);
+        Domains first(data.domains.begin(), data.domains.begin() + ARITY);
+        data.supported =
+            projection(bruteForce(first, data, satisfiesFirst), ARITY);
+}
+
+bool check(const Instance& data, const unsigned instance, const Engine engine)
+{
+        bool passed = true;
+        Model model(engine);
+        post(model, data, 2);
+        if (!same("NsSupports", instance, data.expected, solutions(model)))
+                passed = false;
+        Model single(engine);
+        post(single, data, 1);
+        if (!same("NsSupports propagation", instance, data.supported,
+                  rootDomains(single)))
+                passed = false;
+        return passed;
+}
+
+} // end namespace
+
+int main(void)
+{
+        return verify(INSTANCES, generate, check);
+}
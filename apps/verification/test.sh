@@ -15,5 +15,32 @@ bash -c 'cmp <(sort solutions.txt) <(sort verification/nqueens_12_sorted_solutio
 # Validate SEND + MORE = MONEY solution
 $MEM_CHECK ./send_more_money > solutions.txt
 bash -c 'cmp <(sort solutions.txt) <(sort verification/send_more_money_solution.txt)'
+# Validate that the restarts and their nogoods prove the optimum
+$MEM_CHECK ./restarts
+# Compare NsSum with a chain of additions
+$MEM_CHECK ./sum
+# Compare NsLinear with a sum of products
+$MEM_CHECK ./linear
+# Compare NsSupports with a brute force search
+$MEM_CHECK ./supports
+# Compare NsConflicts with a brute force search
+$MEM_CHECK ./conflicts
+# Compare the short and the compressed tables with a brute force search
+$MEM_CHECK ./short_tables
+# Compare equal tables on several scopes with a brute force search
+$MEM_CHECK ./shared_tables
+# Compare NsAllDiff for domains with a brute force search
+$MEM_CHECK ./alldiff
+# Compare NsCount with a brute force search
+$MEM_CHECK ./count
+# Compare NsCumulative with a brute force search
+$MEM_CHECK ./cumulative
+# Compare NsDisjunctive with a brute force search
+$MEM_CHECK ./disjunctive
+# Compare NsDiffn with a brute force search
+$MEM_CHECK ./diffn
+# Compare the search trees of the heap and of a linear scan, and of
+# bit-sets, sparse sets and interval lists
+$MEM_CHECK ./search_trees
 # Clean up
 rm solutions.txt
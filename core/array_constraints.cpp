@@ -50,6 +50,24 @@ void array_sum_min_max(const NsIntVarArray* VarArr, const NsIndex start,
         }
 }
 
+void array_linear_min_max(const NsDeque<NsInt>& coeffs,
+                          const NsIntVarArray& VarArr, NsInt& sumMin,
+                          NsInt& sumMax)
+{
+        sumMin = sumMax = 0;
+        NsIndex i = 0;
+        for (NsIntVarArray::const_iterator V = VarArr.begin();
+             V != VarArr.end(); ++V, ++i) {
+                if (coeffs[i] >= 0) {
+                        sumMin += coeffs[i] * V->min();
+                        sumMax += coeffs[i] * V->max();
+                } else {
+                        sumMin += coeffs[i] * V->max();
+                        sumMax += coeffs[i] * V->min();
+                }
+        }
+}
+
 Ns_ConstrXeqMin::Ns_ConstrXeqMin(NsIntVar* X, NsIntVarArray* VarArr_init)
   : VarX(X), VarArr(VarArr_init)
 {
@@ -143,6 +161,7 @@ Ns_ConstrXeqSum::Ns_ConstrXeqSum(NsIntVar* X, NsIntVarArray* VarArr_init)
                           "of a constraint must belong to the same "
                           "NsProblemManager");
         }
+        initSums();
 }
 
 Ns_ConstrXeqSum::Ns_ConstrXeqSum(NsIntVar* X, NsIntVarArray* VarArr_init,
@@ -150,7 +169,6 @@ Ns_ConstrXeqSum::Ns_ConstrXeqSum(NsIntVar* X, NsIntVarArray* VarArr_init,
                                  const NsIndex length_init)
   : VarX(X), VarArr(VarArr_init), start(start_init), length(length_init)
 {
-        revisionType = BIDIRECTIONAL_CONSISTENCY;
         assert_Ns(!VarArr->empty(),
                   "Ns_ConstrXeqSum::Ns_ConstrXeqSum: Empty 'VarArr'");
         NsProblemManager& pm = VarX->manager();
@@ -161,64 +179,283 @@ Ns_ConstrXeqSum::Ns_ConstrXeqSum(NsIntVar* X, NsIntVarArray* VarArr_init,
                           "of a constraint must belong to the same "
                           "NsProblemManager");
         }
+        initSums();
+}
+
+/// Records the current bounds of the terms
+///
+/// The revisions should not be skipped, as with
+/// BIDIRECTIONAL_CONSISTENCY, because each one records the
+/// modification of a term.
+void Ns_ConstrXeqSum::initSums(void)
+{
+        sumMin = sumMax = maxSpan = 0;
+        for (NsIndex i = 0; i < length; ++i) {
+                const NsIntVar& V = (*VarArr)[start + i];
+                termMin.push_back(V.min());
+                termMax.push_back(V.max());
+                sumMin += V.min();
+                sumMax += V.max();
+                maxSpan = max(maxSpan, V.max() - V.min());
+                VarPointerIndices[(Ns_pointer_t)&V].push_back(i);
+        }
+        // Make 'lastSaveId' dirty as the sums have not been saved
+        lastSaveId.id = NsUPLUS_INF;
+        lastSaveId.level = 0;
+}
+
+/// Saves the sums once per search node, before they change
+void Ns_ConstrXeqSum::saveSums(void)
+{
+        NsProblemManager& pm = VarX->manager();
+        if (!pm.isCurrentHistoryId(lastSaveId)) {
+                pm.saveValue(sumMin);
+                pm.saveValue(sumMax);
+                pm.saveValue(maxSpan);
+                lastSaveId = pm.getCurrentHistoryId();
+        }
+}
+
+/// Adds the modification of the bounds of the i-th term to the sums
+void Ns_ConstrXeqSum::updateTerm(const NsIndex i)
+{
+        const NsIntVar& V = (*VarArr)[start + i];
+        if (V.min() == termMin[i] && V.max() == termMax[i])
+                return;
+        saveSums();
+        NsProblemManager& pm = VarX->manager();
+        pm.saveValue(termMin[i]);
+        pm.saveValue(termMax[i]);
+        sumMin += V.min() - termMin[i];
+        sumMax += V.max() - termMax[i];
+        termMin[i] = V.min();
+        termMax[i] = V.max();
+}
+
+/// Imposes bounds-consistency, given that the sums are up to date
+///
+/// The terms are scanned only if scanTerms is set or if the bounds
+/// of VarX are close enough to the sums to prune a term.
+void Ns_ConstrXeqSum::prune(bool scanTerms)
+{
+        for (;;) {
+                if (!VarX->removeRange(NsMINUS_INF, sumMin - 1, this) ||
+                    !VarX->removeRange(sumMax + 1, NsPLUS_INF, this))
+                        return;
+                if (!scanTerms && maxSpan <= sumMax - VarX->min() &&
+                    maxSpan <= VarX->max() - sumMin)
+                        break;
+                scanTerms = false;
+                NsInt span = 0;
+                for (NsIndex i = 0; i < length; ++i) {
+                        NsIntVar& V = (*VarArr)[start + i];
+                        updateTerm(i);
+                        if (V.min() + sumMax - V.max() < VarX->min()) {
+                                if (!V.removeRange(NsMINUS_INF,
+                                                   -sumMax + V.max() +
+                                                       VarX->min() - 1,
+                                                   this))
+                                        return;
+                                updateTerm(i);
+                        }
+                        if (V.max() + sumMin - V.min() > VarX->max()) {
+                                if (!V.removeRange(-sumMin + V.min() +
+                                                       VarX->max() + 1,
+                                                   NsPLUS_INF, this))
+                                        return;
+                                updateTerm(i);
+                        }
+                        span = max(span, V.max() - V.min());
+                }
+                if (span != maxSpan) {
+                        saveSums();
+                        maxSpan = span;
+                }
+        }
+        // VarX lies in [sumMin, sumMax]
+        if (sumMin == sumMax)
+                VarX->manager().entail(this);
 }
 
 // bounds-consistency only
 void Ns_ConstrXeqSum::ArcCons(void)
 {
-        NsInt sumMin, sumMax;
-        array_sum_min_max(VarArr, start, length, sumMin, sumMax);
-        NsIndex i;
-        bool changed_summinmax = true;
+        prune(true);
+}
+
+/// Revises the constraint in constant time, unless a term can be pruned
+void Ns_ConstrXeqSum::LocalArcCons(Ns_QueueItem& Qitem)
+{
+        VarPointerIndices_t::const_iterator indices =
+            VarPointerIndices.find((Ns_pointer_t)Qitem.getVarFired());
+        if (indices != VarPointerIndices.end()) {
+                for (NsDeque<NsIndex>::const_iterator i =
+                         indices->second.begin();
+                     i != indices->second.end(); ++i)
+                        updateTerm(*i);
+        }
+        prune(false);
+}
+
+namespace {
+
+/// The quotient x / y, rounded towards minus infinity
+NsInt floorDiv(const NsInt x, const NsInt y)
+{
+        NsInt q = x / y;
+        if (x % y != 0 && ((x < 0) != (y < 0)))
+                --q;
+        return q;
+}
+
+/// The quotient x / y, rounded towards plus infinity
+NsInt ceilDiv(const NsInt x, const NsInt y)
+{
+        NsInt q = x / y;
+        if (x % y != 0 && ((x < 0) == (y < 0)))
+                ++q;
+        return q;
+}
+
+} // end namespace
+
+Ns_ConstrXeqLinear::Ns_ConstrXeqLinear(NsIntVar* X,
+                                       const NsDeque<NsInt>& coeffs_init,
+                                       NsIntVarArray* VarArr_init)
+  : VarX(X), VarArr(VarArr_init), sumMin(0), sumMax(0), maxSpan(0)
+{
+        assert_Ns(coeffs_init.size() == VarArr->size(),
+                  "Ns_ConstrXeqLinear::Ns_ConstrXeqLinear: 'coeffs' and "
+                  "'VarArr' should have the same size");
+        NsProblemManager& pm = VarX->manager();
+        for (NsIndex i = 0; i < VarArr->size(); ++i) {
+                NsIntVar& V = (*VarArr)[i];
+                assert_Ns(&pm == &V.manager(),
+                          "Ns_ConstrXeqLinear::Ns_ConstrXeqLinear: All the "
+                          "variables of a constraint must belong to the same "
+                          "NsProblemManager");
+                const NsInt C = coeffs_init[i];
+                if (C == 0)
+                        continue;
+                VarPointerIndices[(Ns_pointer_t)&V].push_back(terms.size());
+                terms.push_back(&V);
+                coeffs.push_back(C);
+                termMin.push_back((C > 0) ? C * V.min() : C * V.max());
+                termMax.push_back((C > 0) ? C * V.max() : C * V.min());
+                sumMin += termMin.back();
+                sumMax += termMax.back();
+                maxSpan = max(maxSpan, termMax.back() - termMin.back());
+        }
+        // Make 'lastSaveId' dirty as the sums have not been saved
+        lastSaveId.id = NsUPLUS_INF;
+        lastSaveId.level = 0;
+}
+
+/// Saves the sums once per search node, before they change
+void Ns_ConstrXeqLinear::saveSums(void)
+{
+        NsProblemManager& pm = VarX->manager();
+        if (!pm.isCurrentHistoryId(lastSaveId)) {
+                pm.saveValue(sumMin);
+                pm.saveValue(sumMax);
+                pm.saveValue(maxSpan);
+                lastSaveId = pm.getCurrentHistoryId();
+        }
+}
+
+/// Adds the modification of the bounds of the i-th term to the sums
+void Ns_ConstrXeqLinear::updateTerm(const NsIndex i)
+{
+        const NsIntVar& V = *terms[i];
+        const NsInt C = coeffs[i];
+        const NsInt newMin = (C > 0) ? C * V.min() : C * V.max();
+        const NsInt newMax = (C > 0) ? C * V.max() : C * V.min();
+        if (newMin == termMin[i] && newMax == termMax[i])
+                return;
+        saveSums();
+        NsProblemManager& pm = VarX->manager();
+        pm.saveValue(termMin[i]);
+        pm.saveValue(termMax[i]);
+        sumMin += newMin - termMin[i];
+        sumMax += newMax - termMax[i];
+        termMin[i] = newMin;
+        termMax[i] = newMax;
+}
+
+/// Imposes bounds-consistency, given that the sums are up to date
+///
+/// As in Ns_ConstrXeqSum, the terms are scanned only if scanTerms is
+/// set or if a bound of VarX is close enough to the opposite sum.
+void Ns_ConstrXeqLinear::prune(bool scanTerms)
+{
         for (;;) {
-                do {
-                        if (!VarX->removeRange(NsMINUS_INF, sumMin - 1, this))
-                                return;
-                        for (i = start; i < start + length; ++i) {
-                                NsIntVar& V = (*VarArr)[i];
-                                if (V.min() + sumMax - V.max() < VarX->min()) {
-                                        sumMin -= V.min();
-                                        if (!V.removeRange(NsMINUS_INF,
-                                                           -sumMax + V.max() +
-                                                               VarX->min() - 1,
-                                                           this))
-                                                return;
-                                        sumMin += V.min();
-                                        changed_summinmax = true;
-                                }
-                        }
-                } while (VarX->min() < sumMin);
-                // Initially 'changed_summinmax' was intentionally set true, in
-                // order the following 'if' statement to be ignored, the first
-                // time it is executed.
-                if (!changed_summinmax)
+                if (!VarX->removeRange(NsMINUS_INF, sumMin - 1, this) ||
+                    !VarX->removeRange(sumMax + 1, NsPLUS_INF, this))
+                        return;
+                if (!scanTerms && maxSpan <= sumMax - VarX->min() &&
+                    maxSpan <= VarX->max() - sumMin)
                         break;
-                changed_summinmax = false;
-                do {
-                        if (!VarX->removeRange(sumMax + 1, NsPLUS_INF, this))
-                                return;
-                        for (i = start; i < start + length; ++i) {
-                                NsIntVar& V = (*VarArr)[i];
-                                if (V.max() + sumMin - V.min() > VarX->max()) {
-                                        sumMax -= V.max();
-                                        if (!V.removeRange(-sumMin + V.min() +
-                                                               VarX->max() + 1,
-                                                           NsPLUS_INF, this))
-                                                return;
-                                        sumMax += V.max();
-                                        changed_summinmax = true;
-                                }
+                scanTerms = false;
+                NsInt span = 0;
+                for (NsIndex i = 0; i < terms.size(); ++i) {
+                        NsIntVar& V = *terms[i];
+                        const NsInt C = coeffs[i];
+                        updateTerm(i);
+                        // The weighted term should be at least 'least'
+                        NsInt least = VarX->min() - sumMax + termMax[i];
+                        if (least > termMin[i]) {
+                                if (!((C > 0) ? V.removeRange(
+                                                    NsMINUS_INF,
+                                                    ceilDiv(least, C) - 1, this)
+                                              : V.removeRange(
+                                                    floorDiv(least, C) + 1,
+                                                    NsPLUS_INF, this)))
+                                        return;
+                                updateTerm(i);
                         }
-                } while (VarX->max() > sumMax);
-                if (!changed_summinmax)
-                        break;
-                changed_summinmax = false;
+                        // The weighted term should be at most 'most'
+                        NsInt most = VarX->max() - sumMin + termMin[i];
+                        if (most < termMax[i]) {
+                                if (!((C > 0) ? V.removeRange(
+                                                    floorDiv(most, C) + 1,
+                                                    NsPLUS_INF, this)
+                                              : V.removeRange(
+                                                    NsMINUS_INF,
+                                                    ceilDiv(most, C) - 1,
+                                                    this)))
+                                        return;
+                                updateTerm(i);
+                        }
+                        span = max(span, termMax[i] - termMin[i]);
+                }
+                if (span != maxSpan) {
+                        saveSums();
+                        maxSpan = span;
+                }
         }
+        // VarX lies in [sumMin, sumMax]
+        if (sumMin == sumMax)
+                VarX->manager().entail(this);
 }
 
-void Ns_ConstrXeqSum::LocalArcCons(Ns_QueueItem& /*Qitem*/)
+// bounds-consistency only
+void Ns_ConstrXeqLinear::ArcCons(void)
 {
-        ArcCons();
+        prune(true);
+}
+
+/// Revises the constraint in constant time, unless a term can be pruned
+void Ns_ConstrXeqLinear::LocalArcCons(Ns_QueueItem& Qitem)
+{
+        VarPointerIndices_t::const_iterator indices =
+            VarPointerIndices.find((Ns_pointer_t)Qitem.getVarFired());
+        if (indices != VarPointerIndices.end()) {
+                for (NsDeque<NsIndex>::const_iterator i =
+                         indices->second.begin();
+                     i != indices->second.end(); ++i)
+                        updateTerm(*i);
+        }
+        prune(false);
 }
 
 Ns_ConstrAllDiff::Ns_ConstrAllDiff(NsIntVarArray* VarArr_init)
@@ -643,22 +880,603 @@ void Ns_ConstrAllDiffStrong::LocalArcCons(Ns_QueueItem& Qitem)
         allDiffBoundsConsistency(VarArr, Capacity, groupFired, this);
 }
 
-Ns_ConstrTable::Ns_ConstrTable(NsIntVarArray& VarArr_init,
-                               const NsDeque<NsDeque<NsInt>>& table_init,
-                               const bool isSupportsTable_init)
-  : VarArr(VarArr_init),
-    table(table_init),
-    isSupportsTable(isSupportsTable_init)
+const NsIndex Ns_ConstrAllDiffDomain::UNMATCHED;
+
+Ns_ConstrAllDiffDomain::Ns_ConstrAllDiffDomain(NsIntVarArray* VarArr_init)
+  : VarArr(VarArr_init), nAugmentations(0)
 {
-        revisionType = BIDIRECTIONAL_CONSISTENCY;
-        assert_Ns(VarArr.size() >= 2,
-                  "A table constraint must refer at least to two variables");
+        revisionType = VALUE_CONSISTENCY;
+        assert_Ns(VarArr->size() >= 2,
+                  "Ns_ConstrAllDiffDomain::Ns_ConstrAllDiffDomain: "
+                  "Condition required: VarArr.size() >= 2");
+        NsIntVarArray::iterator X = VarArr->begin();
+        NsProblemManager& pm = X->manager();
+        for (; X != VarArr->end(); ++X) {
+                assert_Ns(&pm == &X->manager(),
+                          "Ns_ConstrAllDiffDomain::Ns_ConstrAllDiffDomain: "
+                          "All the variables of a constraint must belong to "
+                          "the same NsProblemManager");
+                for (NsIntVar::const_iterator val = X->begin();
+                     val != X->end(); ++val) {
+                        if (valueIndices
+                                .insert(std::make_pair(*val, values.size()))
+                                .second)
+                                values.push_back(*val);
+                }
+        }
+        varMatch.resize(VarArr->size());
+        std::fill(varMatch.begin(), varMatch.end(), UNMATCHED);
+        valueMatch.resize(values.size());
+        std::fill(valueMatch.begin(), valueMatch.end(), UNMATCHED);
+        valueVisit.resize(values.size());
+}
+
+/// Searches for an augmenting path that starts from the x-th variable
+bool Ns_ConstrAllDiffDomain::augment(const NsIndex x)
+{
+        NsIntVar& X = (*VarArr)[x];
+        // A free value is preferred
+        for (NsIntVar::const_iterator val = X.begin(); val != X.end(); ++val) {
+                NsIndex v = valueIndices[*val];
+                if (valueMatch[v] == UNMATCHED) {
+                        varMatch[x] = v;
+                        valueMatch[v] = x;
+                        return true;
+                }
+        }
+        for (NsIntVar::const_iterator val = X.begin(); val != X.end(); ++val) {
+                NsIndex v = valueIndices[*val];
+                if (valueVisit[v] == nAugmentations)
+                        continue;
+                valueVisit[v] = nAugmentations;
+                if (augment(valueMatch[v])) {
+                        varMatch[x] = v;
+                        valueMatch[v] = x;
+                        return true;
+                }
+        }
+        return false;
+}
+
+/// Rematches the variables that have lost their matched values
+///
+/// Returns false if there is no matching for all the variables.
+bool Ns_ConstrAllDiffDomain::repairMatching(void)
+{
+        for (NsIndex x = 0; x < VarArr->size(); ++x) {
+                if (varMatch[x] != UNMATCHED &&
+                    !(*VarArr)[x].contains(values[varMatch[x]])) {
+                        valueMatch[varMatch[x]] = UNMATCHED;
+                        varMatch[x] = UNMATCHED;
+                }
+        }
+        for (NsIndex x = 0; x < VarArr->size(); ++x) {
+                if (varMatch[x] == UNMATCHED) {
+                        ++nAugmentations;
+                        if (!augment(x))
+                                return false;
+                }
+        }
+        return true;
+}
+
+/// Removes the values that do not belong to any matching
+///
+/// The residual graph has an edge from each variable to its unmatched
+/// values, from each matched value to its variable, and from each
+/// free value to a sink that leads to all the matched values. An
+/// unmatched value is removed if it is not in the strongly connected
+/// component of the variable. Returns false if a domain is emptied.
+bool Ns_ConstrAllDiffDomain::removeUnmatchableValues(void)
+{
+        const NsIndex nVars = VarArr->size();
+        const NsIndex sink = nVars + values.size();
+        const NsIndex nNodes = sink + 1;
+        // The edges of each variable node
+        NsDeque<NsIndex> edgesBegin(nVars + 1), edges;
+        for (NsIndex x = 0; x < nVars; ++x) {
+                edgesBegin[x] = edges.size();
+                NsIntVar& X = (*VarArr)[x];
+                for (NsIntVar::const_iterator val = X.begin(); val != X.end();
+                     ++val) {
+                        NsIndex v = valueIndices[*val];
+                        if (v != varMatch[x])
+                                edges.push_back(nVars + v);
+                }
+        }
+        edgesBegin[nVars] = edges.size();
+        // Iterative Tarjan's algorithm
+        const NsIndex UNVISITED = static_cast<NsIndex>(-1);
+        NsDeque<NsIndex> order(nNodes), lowLink(nNodes), component(nNodes);
+        std::fill(order.begin(), order.end(), UNVISITED);
+        NsDeque<NsIndex> nextEdge(nNodes);
+        NsDeque<bool> onStack(nNodes);
+        NsDeque<NsIndex> stack, path;
+        NsIndex nVisited = 0, nComponents = 0;
+        for (NsIndex root = 0; root < nNodes; ++root) {
+                if (order[root] != UNVISITED || (root >= nVars && root < sink))
+                        continue;
+                path.push_back(root);
+                while (!path.empty()) {
+                        NsIndex node = path.back();
+                        if (order[node] == UNVISITED) {
+                                order[node] = lowLink[node] = nVisited++;
+                                nextEdge[node] = 0;
+                                stack.push_back(node);
+                                onStack[node] = true;
+                        }
+                        // The next successor of the node
+                        NsIndex succ = UNVISITED;
+                        if (node < nVars) {
+                                if (edgesBegin[node] + nextEdge[node] <
+                                    edgesBegin[node + 1])
+                                        succ = edges[edgesBegin[node] +
+                                                     nextEdge[node]];
+                        } else if (node < sink) {
+                                if (nextEdge[node] == 0) {
+                                        NsIndex x = valueMatch[node - nVars];
+                                        succ = (x == UNMATCHED) ? sink : x;
+                                }
+                        } else {
+                                while (nextEdge[node] < nVars &&
+                                       varMatch[nextEdge[node]] == UNMATCHED)
+                                        ++nextEdge[node];
+                                if (nextEdge[node] < nVars)
+                                        succ = nVars +
+                                               varMatch[nextEdge[node]];
+                        }
+                        if (succ != UNVISITED) {
+                                ++nextEdge[node];
+                                if (order[succ] == UNVISITED)
+                                        path.push_back(succ);
+                                else if (onStack[succ] &&
+                                         order[succ] < lowLink[node])
+                                        lowLink[node] = order[succ];
+                                continue;
+                        }
+                        // All the successors have been examined
+                        path.pop_back();
+                        if (!path.empty() &&
+                            lowLink[node] < lowLink[path.back()])
+                                lowLink[path.back()] = lowLink[node];
+                        if (lowLink[node] == order[node]) {
+                                NsIndex member;
+                                do {
+                                        member = stack.back();
+                                        stack.pop_back();
+                                        onStack[member] = false;
+                                        component[member] = nComponents;
+                                } while (member != node);
+                                ++nComponents;
+                        }
+                }
+        }
+        NsDeque<NsInt> unmatchable;
+        for (NsIndex x = 0; x < nVars; ++x) {
+                unmatchable.clear();
+                for (NsIndex e = edgesBegin[x]; e < edgesBegin[x + 1]; ++e) {
+                        if (component[edges[e]] != component[x])
+                                unmatchable.push_back(values[edges[e] - nVars]);
+                }
+                for (NsDeque<NsInt>::const_iterator val = unmatchable.begin();
+                     val != unmatchable.end(); ++val) {
+                        if (!(*VarArr)[x].removeSingle(*val, this))
+                                return false;
+                }
+        }
+        return true;
+}
+
+void Ns_ConstrAllDiffDomain::ArcCons(void)
+{
+        // A repeated variable may lose a value matched to another
+        // of its positions, because of the removals of this revision
+        bool matched;
+        do {
+                if (!repairMatching()) {
+                        (*VarArr)[0].removeAll();
+                        return;
+                }
+                if (!removeUnmatchableValues())
+                        return;
+                matched = true;
+                for (NsIndex x = 0; x < VarArr->size() && matched; ++x)
+                        matched = (*VarArr)[x].contains(values[varMatch[x]]);
+        } while (!matched);
+}
+
+/// The matching is repaired once for all the removed values
+void Ns_ConstrAllDiffDomain::LocalArcCons(Ns_QueueItem& Qitem)
+{
+        if (Qitem.lastRemovedValueFor(this))
+                ArcCons();
+}
+
+void Ns_TupleSet::init(const NsDeque<bool>& valid)
+{
+        words.assign((valid.size() + MW_BITS - 1) / MW_BITS, 0);
+        for (NsUInt i = 0; i < valid.size(); ++i) {
+                if (valid[i])
+                        words[i / MW_BITS] |= static_cast<size_t>(1)
+                                              << (i % MW_BITS);
+        }
+        index.clear();
+        // The nonzero words are placed first
+        for (NsUInt w = 0; w < words.size(); ++w) {
+                if (words[w] != 0)
+                        index.push_back(w);
+        }
+        limit = index.size();
+        for (NsUInt w = 0; w < words.size(); ++w) {
+                if (words[w] == 0)
+                        index.push_back(w);
+        }
+        // Make 'limitSaveId' dirty as 'limit' has not been saved
+        limitSaveId.id = NsUPLUS_INF;
+        limitSaveId.level = 0;
+}
+
+void Ns_TupleSet::saveLimit(NsProblemManager& pm)
+{
+        if (!pm.isCurrentHistoryId(limitSaveId)) {
+                pm.saveValue(limit);
+                limitSaveId = pm.getCurrentHistoryId();
+        }
+}
+
+/// Replaces the word index[i] with a subset of it
+void Ns_TupleSet::replaceWord(NsProblemManager& pm, const NsInt i,
+                              const size_t remaining)
+{
+        NsUInt w = index[i];
+        pm.saveValue(words[w]);
+        words[w] = remaining;
+        if (remaining == 0) {
+                // The word is swapped with the last nonzero one, which
+                // has already been examined by the callers
+                saveLimit(pm);
+                --limit;
+                std::swap(index[i], index[limit]);
+        }
+}
+
+bool Ns_TupleSet::removeMask(NsProblemManager& pm,
+                             const NsDeque<size_t>& masks, const NsUInt offset,
+                             NsDeque<NsUInt>* removed)
+{
+        bool modified = false;
+        for (NsInt i = limit - 1; i >= 0; --i) {
+                NsUInt w = index[i];
+                size_t remaining = words[w] & ~masks[offset + w];
+                if (remaining == words[w])
+                        continue;
+                modified = true;
+                if (removed != 0) {
+                        for (NsUInt bit = 0; bit < MW_BITS; ++bit) {
+                                if (((words[w] & ~remaining) >> bit) & 1u)
+                                        removed->push_back(w * MW_BITS + bit);
+                        }
+                }
+                replaceWord(pm, i, remaining);
+        }
+        return modified;
+}
+
+bool Ns_TupleSet::intersectWith(NsProblemManager& pm,
+                                const NsDeque<size_t>& mask)
+{
+        bool modified = false;
+        for (NsInt i = limit - 1; i >= 0; --i) {
+                NsUInt w = index[i];
+                size_t remaining = words[w] & mask[w];
+                if (remaining == words[w])
+                        continue;
+                modified = true;
+                replaceWord(pm, i, remaining);
+        }
+        return modified;
+}
+
+bool Ns_TupleSet::intersects(const NsDeque<size_t>& masks,
+                             const NsUInt offset, NsUInt& residue) const
+{
+        // The words after 'limit' are zero
+        if ((words[residue] & masks[offset + residue]) != 0)
+                return true;
+        for (NsInt i = 0; i < limit; ++i) {
+                NsUInt w = index[i];
+                if ((words[w] & masks[offset + w]) != 0) {
+                        residue = w;
+                        return true;
+                }
+        }
+        return false;
+}
+
+void Ns_TupleSet::commonTuples(const NsDeque<size_t>& masks,
+                               const NsUInt offset,
+                               NsDeque<NsUInt>& tuples) const
+{
+        for (NsInt i = 0; i < limit; ++i) {
+                NsUInt w = index[i];
+                size_t common = words[w] & masks[offset + w];
+                for (NsUInt bit = 0; common != 0; ++bit, common >>= 1) {
+                        if (common & 1u)
+                                tuples.push_back(w * MW_BITS + bit);
+                }
+        }
+}
+
+void Ns_TupleSet::elements(NsDeque<NsUInt>& tuples) const
+{
+        for (NsInt i = 0; i < limit; ++i) {
+                NsUInt w = index[i];
+                size_t word = words[w];
+                for (NsUInt bit = 0; word != 0; ++bit, word >>= 1) {
+                        if (word & 1u)
+                                tuples.push_back(w * MW_BITS + bit);
+                }
+        }
+}
+
+namespace {
+
+/// Rejects a table value that no domain can contain, e.g. an
+/// infinite bound, unless it is NsSTAR
+void assertTableValue(const NsInt val)
+{
+        assert_Ns(NsMINUS_INF < val && val < NsSTAR,
+                  "Ns_TupleStore::Ns_TupleStore: Table value out of the "
+                  "domain range");
+}
+
+} // end namespace
+
+Ns_TupleStore::Ns_TupleStore(const NsDeque<NsDeque<NsInt>>& table,
+                             const NsIndex arity_init)
+  : arity(arity_init), nTuples(table.size()), plain(true)
+{
+        values.reserve(nTuples * arity);
         for (NsDeque<NsDeque<NsInt>>::const_iterator tuple = table.begin();
              tuple != table.end(); ++tuple) {
-                assert_Ns(VarArr.size() == tuple->size(),
+                assert_Ns(tuple->size() == arity,
+                          "Variable array's and table constraint tuple's sizes "
+                          "mismatch");
+                for (NsDeque<NsInt>::const_iterator val = tuple->begin();
+                     val != tuple->end(); ++val) {
+                        if (*val == NsSTAR)
+                                plain = false;
+                        else
+                                assertTableValue(*val);
+                        values.push_back(*val);
+                }
+        }
+        computeHash();
+}
+
+Ns_TupleStore::Ns_TupleStore(const NsDeque<NsDeque<NsDeque<NsInt>>>& table,
+                             const NsIndex arity_init)
+  : arity(arity_init), nTuples(table.size()), plain(false)
+{
+        cellStarts.reserve(nTuples * arity + 1);
+        for (NsDeque<NsDeque<NsDeque<NsInt>>>::const_iterator tuple =
+                 table.begin();
+             tuple != table.end(); ++tuple) {
+                assert_Ns(tuple->size() == arity,
                           "Variable array's and table constraint tuple's sizes "
                           "mismatch");
+                for (NsDeque<NsDeque<NsInt>>::const_iterator cell =
+                         tuple->begin();
+                     cell != tuple->end(); ++cell) {
+                        cellStarts.push_back(values.size());
+                        if (std::find(cell->begin(), cell->end(), NsSTAR) !=
+                            cell->end()) {
+                                values.push_back(NsSTAR);
+                                continue;
+                        }
+                        std::for_each(cell->begin(), cell->end(),
+                                      assertTableValue);
+                        // The values of a cell are kept sorted
+                        std::vector<NsInt>::iterator cellBegin =
+                            values.insert(values.end(), cell->begin(),
+                                          cell->end());
+                        std::sort(cellBegin, values.end());
+                        values.erase(std::unique(cellBegin, values.end()),
+                                     values.end());
+                }
+        }
+        cellStarts.push_back(values.size());
+        computeHash();
+}
+
+Ns_TupleStore::~Ns_TupleStore(void)
+{
+        for (NsDeque<Ns_TableIndex*>::iterator index = indexes.begin();
+             index != indexes.end(); ++index) {
+                delete *index;
+        }
+}
+
+namespace {
+
+void hashCombine(size_t& seed, const size_t value)
+{
+        seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+} // end namespace
+
+void Ns_TupleStore::computeHash(void)
+{
+        hashValue = 0;
+        hashCombine(hashValue, arity);
+        hashCombine(hashValue, nTuples);
+        for (std::vector<NsInt>::const_iterator val = values.begin();
+             val != values.end(); ++val) {
+                hashCombine(hashValue, *val);
+        }
+        for (std::vector<NsUInt>::const_iterator start = cellStarts.begin();
+             start != cellStarts.end(); ++start) {
+                hashCombine(hashValue, *start);
+        }
+}
+
+const Ns_TableIndex&
+Ns_TupleStore::index(const NsDeque<NsIndex>& firstPositions)
+{
+        for (NsDeque<Ns_TableIndex*>::const_iterator i = indexes.begin();
+             i != indexes.end(); ++i) {
+                if ((*i)->firstPositions == firstPositions)
+                        return **i;
         }
+        indexes.push_back(new Ns_TableIndex(*this, firstPositions));
+        return *indexes.back();
+}
+
+namespace {
+
+/// Compares two tuples of a plain table, given their positions
+class TupleLess {
+
+    private:
+        const Ns_TupleStore& store;
+        const NsIndex arity;
+
+    public:
+        TupleLess(const Ns_TupleStore& store_init, const NsIndex arity_init)
+          : store(store_init), arity(arity_init)
+        {
+        }
+
+        bool operator()(const NsUInt t1, const NsUInt t2) const
+        {
+                return std::lexicographical_compare(
+                    store.cellBegin(t1, 0), store.cellEnd(t1, arity - 1),
+                    store.cellBegin(t2, 0), store.cellEnd(t2, arity - 1));
+        }
+};
+
+} // end namespace
+
+Ns_TableIndex::Ns_TableIndex(const Ns_TupleStore& store,
+                             const NsDeque<NsIndex>& firstPositions_init)
+  : firstPositions(firstPositions_init),
+    nWords((store.size() + Ns_TupleSet::MW_BITS - 1) / Ns_TupleSet::MW_BITS),
+    nMasks(0),
+    masksOfValues(firstPositions.size()),
+    consistent(store.size()),
+    multiValueCells(firstPositions.size())
+{
+        const NsIndex arity = firstPositions.size();
+        std::fill(consistent.begin(), consistent.end(), true);
+        if (store.isPlain()) {
+                // Each conflict should be counted once
+                NsDeque<NsUInt> sorted(store.size());
+                for (NsUInt t = 0; t < store.size(); ++t)
+                        sorted[t] = t;
+                TupleLess less(store, arity);
+                std::sort(sorted.begin(), sorted.end(), less);
+                for (NsUInt t = 1; t < sorted.size(); ++t) {
+                        if (!less(sorted[t - 1], sorted[t]))
+                                consistent[sorted[t]] = false;
+                }
+                masksOfTuples.resize(store.size() * arity);
+        }
+        // The common values of the cells of each variable, stored in
+        // the first position of the variable
+        NsDeque<NsDeque<NsInt>> cells(arity);
+        NsDeque<NsInt> common;
+        for (NsIndex t = 0; t < store.size(); ++t) {
+                if (!consistent[t])
+                        continue;
+                for (NsIndex i = 0; i < arity; ++i) {
+                        NsDeque<NsInt>& cell = cells[firstPositions[i]];
+                        if (firstPositions[i] == i) {
+                                cell.assign(store.cellBegin(t, i),
+                                            store.cellEnd(t, i));
+                        } else if (store.cellIsStar(t, i)) {
+                                continue;
+                        } else if (cell.size() == 1 && cell[0] == NsSTAR) {
+                                cell.assign(store.cellBegin(t, i),
+                                            store.cellEnd(t, i));
+                        } else {
+                                common.clear();
+                                std::set_intersection(
+                                    cell.begin(), cell.end(),
+                                    store.cellBegin(t, i), store.cellEnd(t, i),
+                                    std::back_inserter(common));
+                                cell = common;
+                        }
+                        if (cell.empty()) {
+                                consistent[t] = false;
+                                break;
+                        }
+                }
+                if (!consistent[t])
+                        continue;
+                for (NsIndex i = 0; i < arity; ++i) {
+                        const NsDeque<NsInt>& cell = cells[firstPositions[i]];
+                        if (cell.size() > 1 || cell[0] == NsSTAR)
+                                multiValueCells[i] = true;
+                        for (NsDeque<NsInt>::const_iterator val = cell.begin();
+                             val != cell.end(); ++val)
+                                addToMask(t, i, *val, store.isPlain());
+                }
+        }
+}
+
+/// Sets the t-th tuple in the mask of the value val for position i
+void Ns_TableIndex::addToMask(const NsIndex t, const NsIndex i,
+                              const NsInt val, const bool isPlain)
+{
+        Ns_UNORDERED_MAP<NsInt, NsUInt>::iterator mask =
+            masksOfValues[i].find(val);
+        if (mask == masksOfValues[i].end()) {
+                mask = masksOfValues[i]
+                           .insert(std::make_pair(val, nMasks))
+                           .first;
+                ++nMasks;
+                tupleMasks.resize(tupleMasks.size() + nWords);
+        }
+        tupleMasks[mask->second * nWords + t / Ns_TupleSet::MW_BITS] |=
+            static_cast<size_t>(1) << (t % Ns_TupleSet::MW_BITS);
+        if (isPlain)
+                masksOfTuples[t * firstPositions.size() + i] = mask->second;
+}
+
+Ns_ConstrTable::Ns_ConstrTable(NsIntVarArray& VarArr_init,
+                               const NsDeque<NsDeque<NsInt>>& table,
+                               const bool isSupportsTable_init)
+  : VarArr(VarArr_init),
+    store(0),
+    index(0),
+    isSupportsTable(isSupportsTable_init),
+    validTuplesModified(true),
+    nValidTuples(0)
+{
+        init(new Ns_TupleStore(table, VarArr.size()));
+}
+
+Ns_ConstrTable::Ns_ConstrTable(NsIntVarArray& VarArr_init,
+                               const NsDeque<NsDeque<NsDeque<NsInt>>>& table,
+                               const bool isSupportsTable_init)
+  : VarArr(VarArr_init),
+    store(0),
+    index(0),
+    isSupportsTable(isSupportsTable_init),
+    validTuplesModified(true),
+    nValidTuples(0)
+{
+        init(new Ns_TupleStore(table, VarArr.size()));
+}
+
+/// Shares the tuples and their index with the other constraints, and
+/// constructs the valid tuples
+void Ns_ConstrTable::init(Ns_TupleStore* newStore)
+{
+        revisionType = VALUE_CONSISTENCY;
+        assert_Ns(VarArr.size() >= 2,
+                  "A table constraint must refer at least to two variables");
         NsIntVarArray::iterator X = VarArr.begin();
         NsProblemManager& pm = X->manager();
         ++X;
@@ -668,72 +1486,337 @@ Ns_ConstrTable::Ns_ConstrTable(NsIntVarArray& VarArr_init,
                           "variables of a constraint must belong to the same "
                           "NsProblemManager");
         }
+        NsDeque<NsIndex> firstPositions;
+        for (NsIndex i = 0; i < VarArr.size(); ++i) {
+                NsDeque<NsIndex>& positions =
+                    VarPointerIndices[(Ns_pointer_t)&VarArr[i]];
+                if (positions.empty())
+                        distinctVars.push_back(&VarArr[i]);
+                positions.push_back(i);
+                firstPositions.push_back(positions.front());
+        }
+        Ns_TupleStore* sharedStore = pm.internTupleStore(newStore);
+        index = &sharedStore->index(firstPositions);
+        store = sharedStore;
+        // A tuple is valid if each variable has a value in the domain
+        // that matches all the cells of the variable
+        NsDeque<bool> valid(store->size());
+        if (countsConflicts())
+                conflicts.resize(index->nMasks);
+        for (NsIndex t = 0; t < store->size(); ++t) {
+                if (!index->consistent[t])
+                        continue;
+                NsDeque<NsIntVar*>::const_iterator Y = distinctVars.begin();
+                while (Y != distinctVars.end() && hasAllowedValue(t, **Y))
+                        ++Y;
+                valid[t] = (Y == distinctVars.end());
+                if (!valid[t])
+                        continue;
+                ++nValidTuples;
+                if (countsConflicts()) {
+                        for (NsIndex i = 0; i < VarArr.size(); ++i)
+                                ++conflicts[index->masksOfTuples
+                                                [t * VarArr.size() + i]];
+                }
+        }
+        validTuples.init(valid);
+        residues.resize(index->nMasks);
+}
+
+/// True if Var has a value in the domain that matches all its cells
+/// in the t-th tuple
+bool Ns_ConstrTable::hasAllowedValue(const NsIndex t, NsIntVar& Var) const
+{
+        const NsDeque<NsIndex>& positions =
+            VarPointerIndices.find((Ns_pointer_t)&Var)->second;
+        NsDeque<NsIndex>::const_iterator p = positions.begin();
+        while (p != positions.end() && store->cellIsStar(t, *p))
+                ++p;
+        if (p == positions.end())
+                return true;
+        for (const NsInt* val = store->cellBegin(t, *p);
+             val != store->cellEnd(t, *p); ++val) {
+                if (!Var.contains(*val))
+                        continue;
+                NsDeque<NsIndex>::const_iterator q = positions.begin();
+                while (q != positions.end() && store->cellContains(t, *q, *val))
+                        ++q;
+                if (q == positions.end())
+                        return true;
+        }
+        return false;
+}
+
+/// Appends to 'values' the values of Var that match all its cells
+/// in the t-th tuple
+void Ns_ConstrTable::allowedValues(const NsIndex t, NsIntVar& Var,
+                                   NsDeque<NsInt>& values) const
+{
+        const NsDeque<NsIndex>& positions =
+            VarPointerIndices.find((Ns_pointer_t)&Var)->second;
+        // The candidates are taken from a cell that is not a star
+        NsDeque<NsIndex>::const_iterator p = positions.begin();
+        while (p != positions.end() && store->cellIsStar(t, *p))
+                ++p;
+        if (p == positions.end()) {
+                for (NsIntVar::const_iterator val = Var.begin();
+                     val != Var.end(); ++val)
+                        values.push_back(*val);
+                return;
+        }
+        for (const NsInt* val = store->cellBegin(t, *p);
+             val != store->cellEnd(t, *p); ++val) {
+                if (!Var.contains(*val))
+                        continue;
+                NsDeque<NsIndex>::const_iterator q = positions.begin();
+                while (q != positions.end() && store->cellContains(t, *q, *val))
+                        ++q;
+                if (q == positions.end())
+                        values.push_back(*val);
+        }
+}
+
+/// Invalidates the tuples that contain the value val for Var
+void Ns_ConstrTable::removeValue(const NsIntVar* Var, const NsInt val)
+{
+        NsProblemManager& pm = VarArr[0].manager();
+        NsDeque<NsUInt> removed;
+        const NsDeque<NsIndex>& positions =
+            VarPointerIndices[(Ns_pointer_t)Var];
+        for (NsDeque<NsIndex>::const_iterator i = positions.begin();
+             i != positions.end(); ++i) {
+                if (index->multiValueCells[*i])
+                        continue;
+                Ns_UNORDERED_MAP<NsInt, NsUInt>::const_iterator mask =
+                    index->masksOfValues[*i].find(val);
+                if (mask != index->masksOfValues[*i].end() &&
+                    validTuples.removeMask(pm, index->tupleMasks,
+                                           mask->second * index->nWords,
+                                           (countsConflicts()) ? &removed
+                                                               : 0))
+                        validTuplesModified = true;
+        }
+        if (removed.empty())
+                return;
+        // The invalidated conflicts no longer count
+        pm.saveValue(nValidTuples);
+        nValidTuples -= removed.size();
+        for (NsDeque<NsUInt>::const_iterator t = removed.begin();
+             t != removed.end(); ++t) {
+                for (NsIndex i = 0; i < VarArr.size(); ++i) {
+                        NsInt& count =
+                            conflicts[index->masksOfTuples[*t * VarArr.size() +
+                                                           i]];
+                        pm.saveValue(count);
+                        --count;
+                }
+        }
+}
+
+/// Keeps only the tuples that match the domain of Var in the
+/// positions with multi-value cells
+void Ns_ConstrTable::keepDomainTuples(const NsIntVar* Var)
+{
+        NsProblemManager& pm = VarArr[0].manager();
+        const NsDeque<NsIndex>& positions =
+            VarPointerIndices[(Ns_pointer_t)Var];
+        for (NsDeque<NsIndex>::const_iterator i = positions.begin();
+             i != positions.end(); ++i) {
+                if (!index->multiValueCells[*i])
+                        continue;
+                const Ns_UNORDERED_MAP<NsInt, NsUInt>& masks =
+                    index->masksOfValues[*i];
+                // The masks of the star and of the values in the domain
+                NsDeque<NsUInt> domainMasks;
+                Ns_UNORDERED_MAP<NsInt, NsUInt>::const_iterator mask =
+                    masks.find(NsSTAR);
+                if (mask != masks.end())
+                        domainMasks.push_back(mask->second);
+                for (NsIntVar::const_iterator val = Var->begin();
+                     val != Var->end(); ++val) {
+                        mask = masks.find(*val);
+                        if (mask != masks.end())
+                                domainMasks.push_back(mask->second);
+                }
+                NsDeque<size_t> domainMask(index->nWords);
+                for (NsDeque<NsUInt>::const_iterator m = domainMasks.begin();
+                     m != domainMasks.end(); ++m) {
+                        for (NsUInt w = 0; w < index->nWords; ++w)
+                                domainMask[w] |=
+                                    index->tupleMasks[*m * index->nWords + w];
+                }
+                if (validTuples.intersectWith(pm, domainMask))
+                        validTuplesModified = true;
+        }
+}
+
+/// True if a valid tuple matches the value val for position i
+bool Ns_ConstrTable::supported(const NsIndex i, const NsInt val)
+{
+        const Ns_UNORDERED_MAP<NsInt, NsUInt>& masks = index->masksOfValues[i];
+        Ns_UNORDERED_MAP<NsInt, NsUInt>::const_iterator mask = masks.find(val);
+        if (mask != masks.end() &&
+            validTuples.intersects(index->tupleMasks,
+                                   mask->second * index->nWords,
+                                   residues[mask->second]))
+                return true;
+        mask = masks.find(NsSTAR);
+        return (mask != masks.end() &&
+                validTuples.intersects(index->tupleMasks,
+                                       mask->second * index->nWords,
+                                       residues[mask->second]));
 }
 
+/// Removes the values that are not supported by a valid tuple
 void Ns_ConstrTable::ArcConsSupports(void)
 {
-        // Initialize the supported variables' bounds
-        NsDeque<NsInt> VarArrMin(VarArr.size());
-        NsDeque<NsInt> VarArrMax(VarArr.size());
-        NsDeque<NsInt>::size_type i;
-        for (i = 0; i < VarArr.size(); ++i) {
-                VarArrMin[i] = NsPLUS_INF;
-                VarArrMax[i] = NsMINUS_INF;
+        if (!validTuplesModified)
+                return;
+        validTuplesModified = false;
+        if (validTuples.empty()) {
+                VarArr[0].removeAll();
+                return;
         }
-        // Iterate through the tuples of supporting values
-        for (NsDeque<NsDeque<NsInt>>::const_iterator tuple = table.begin();
-             tuple != table.end(); ++tuple) {
-                // Iterate through the values for each tuple
-                for (i = 0; i < tuple->size(); ++i)
-                        if (!VarArr[i].contains((*tuple)[i]))
-                                break; // tuple is not supporting
-                if (i == tuple->size()) {
-                        // This is a support tuple!
-                        // Update the (supported) bounds for each variable
-                        for (i = 0; i < tuple->size(); ++i) {
-                                update_min_max((*tuple)[i], VarArrMin[i],
-                                               VarArrMax[i]);
-                        }
+        NsDeque<NsInt> unsupported;
+        for (NsIndex i = 0; i < VarArr.size(); ++i) {
+                unsupported.clear();
+                for (NsIntVar::const_iterator val = VarArr[i].begin();
+                     val != VarArr[i].end(); ++val) {
+                        if (!supported(i, *val))
+                                unsupported.push_back(*val);
+                }
+                for (NsDeque<NsInt>::const_iterator val = unsupported.begin();
+                     val != unsupported.end(); ++val) {
+                        if (!VarArr[i].removeSingle(*val, this))
+                                return;
                 }
         }
-        // Update the supported variables' bounds
-        for (i = 0; i < VarArr.size(); ++i) {
-                VarArr[i].removeRange(NsMINUS_INF, VarArrMin[i] - 1, this);
-                VarArr[i].removeRange(VarArrMax[i] + 1, NsPLUS_INF, this);
+}
+
+/// The number of the valid conflicts of the mask, whose values
+/// belong to the current domains
+NsInt Ns_ConstrTable::conflictsInDomains(const NsUInt mask) const
+{
+        NsDeque<NsUInt> tuples;
+        validTuples.commonTuples(index->tupleMasks, mask * index->nWords,
+                                 tuples);
+        NsInt count = 0;
+        for (NsDeque<NsUInt>::const_iterator t = tuples.begin();
+             t != tuples.end(); ++t) {
+                NsIndex i;
+                for (i = 0; i < VarArr.size(); ++i) {
+                        if (!VarArr[i].contains(*store->cellBegin(*t, i)))
+                                break;
+                }
+                if (i == VarArr.size())
+                        ++count;
         }
+        return count;
 }
 
+/// Removes the values whose combinations with the values of the
+/// other variables are all conflicts
+///
+/// The values of a variable are examined only if the combinations of
+/// the values of the other variables are not more than the valid
+/// conflicts.
 void Ns_ConstrTable::ArcConsConflicts(void)
 {
-        // Delete conflicting values when one unbound variable exists
-        NsIndex lastUnboundIndex = NsINDEX_INF;
-        for (NsIndex i = 0; i < VarArr.size(); ++i) {
-                // Check if current variable is the last one
-                if (i == VarArr.size() - 1 && lastUnboundIndex == NsINDEX_INF) {
-                        lastUnboundIndex = i;
-                } else if (!VarArr[i].isBound()) {
-                        // Do nothing for more than one unbound vars
-                        if (lastUnboundIndex != NsINDEX_INF)
+        NsDeque<NsInt> forbidden;
+        // The combinations decrease even if no tuple is invalidated
+        do {
+                validTuplesModified = false;
+                if (validTuples.empty()) {
+                        VarArr[0].manager().entail(this);
+                        return;
+                }
+                for (NsIndex i = 0; i < VarArr.size(); ++i) {
+                        NsIntVar& X = VarArr[i];
+                        // The combinations of the other variables' values
+                        NsInt combinations = 1;
+                        for (NsDeque<NsIntVar*>::const_iterator Y =
+                                 distinctVars.begin();
+                             Y != distinctVars.end() &&
+                             combinations <= nValidTuples;
+                             ++Y) {
+                                if (*Y != &X)
+                                        combinations *= (*Y)->size();
+                        }
+                        if (combinations > nValidTuples)
+                                continue;
+                        forbidden.clear();
+                        for (NsIntVar::const_iterator val = X.begin();
+                             val != X.end(); ++val) {
+                                Ns_UNORDERED_MAP<NsInt, NsUInt>::const_iterator
+                                    mask = index->masksOfValues[i].find(*val);
+                                if (mask != index->masksOfValues[i].end() &&
+                                    conflicts[mask->second] >= combinations &&
+                                    conflictsInDomains(mask->second) ==
+                                        combinations)
+                                        forbidden.push_back(*val);
+                        }
+                        for (NsDeque<NsInt>::const_iterator val =
+                                 forbidden.begin();
+                             val != forbidden.end(); ++val) {
+                                if (!X.removeSingle(*val, this))
+                                        return;
+                                // The revisions skip the values that
+                                // the constraint itself removes
+                                removeValue(&X, *val);
+                        }
+                }
+        } while (validTuplesModified);
+}
+
+/// Removes the values of the only unbound variable that form a
+/// conflict with the values of the bound variables
+///
+/// It is used for the conflicts with stars or sets of values, as the
+/// combinations that they stand for cannot be counted per value.
+void Ns_ConstrTable::ArcConsLastUnbound(void)
+{
+        validTuplesModified = false;
+        if (validTuples.empty()) {
+                VarArr[0].manager().entail(this);
+                return;
+        }
+        NsIntVar* Unbound = 0;
+        for (NsDeque<NsIntVar*>::const_iterator Y = distinctVars.begin();
+             Y != distinctVars.end(); ++Y) {
+                if (!(*Y)->isBound()) {
+                        if (Unbound != 0)
                                 return;
-                        lastUnboundIndex = i;
+                        Unbound = *Y;
                 }
         }
-        // Iterate through the tuples of conflicting values
-        for (NsDeque<NsDeque<NsInt>>::const_iterator tuple = table.begin();
-             tuple != table.end(); ++tuple) {
-                // Iterate through the values for each tuple
-                NsDeque<NsInt>::size_type i = 0;
-                for (; i < tuple->size(); ++i) {
-                        if (i != lastUnboundIndex &&
-                            (*tuple)[i] != VarArr[i].value())
-                                break; // Break when the tuple doesn't match
+        NsDeque<NsUInt> tuples;
+        validTuples.elements(tuples);
+        NsDeque<NsInt> values, forbidden;
+        for (NsDeque<NsUInt>::const_iterator t = tuples.begin();
+             t != tuples.end(); ++t) {
+                NsDeque<NsIntVar*>::const_iterator Y = distinctVars.begin();
+                for (; Y != distinctVars.end(); ++Y) {
+                        if (*Y == Unbound)
+                                continue;
+                        values.clear();
+                        allowedValues(*t, **Y, values);
+                        if (values.empty())
+                                break;
                 }
-                if (i == tuple->size()) {
-                        // All the VarArr values matched the tuple!
-                        // Removing the conflicting value
-                        VarArr[lastUnboundIndex].removeSingle(
-                            (*tuple)[lastUnboundIndex], this);
+                if (Y != distinctVars.end())
+                        continue;
+                if (Unbound == 0) {
+                        // All the variables form a conflict
+                        VarArr[0].removeAll();
+                        return;
                 }
+                allowedValues(*t, *Unbound, forbidden);
+        }
+        for (NsDeque<NsInt>::const_iterator val = forbidden.begin();
+             val != forbidden.end(); ++val) {
+                if (Unbound->contains(*val) &&
+                    !Unbound->removeSingle(*val, this))
+                        return;
         }
 }
 
@@ -741,13 +1824,30 @@ void Ns_ConstrTable::ArcCons(void)
 {
         if (isSupportsTable)
                 ArcConsSupports();
-        else
+        else if (countsConflicts())
                 ArcConsConflicts();
+        else
+                ArcConsLastUnbound();
 }
 
-void Ns_ConstrTable::LocalArcCons(Ns_QueueItem& /*Qitem*/)
+/// Invalidates the tuples with the removed value
+///
+/// The tuples of the multi-value cells are examined after the last
+/// removed value of the queue item, in order to be searched once.
+void Ns_ConstrTable::updateLocally(Ns_QueueItem& Qitem)
 {
-        ArcCons();
+        removeValue(Qitem.getVarFired(), Qitem.getW());
+        if (Qitem.lastRemovedValueFor(this))
+                keepDomainTuples(Qitem.getVarFired());
+}
+
+/// Invalidates the tuples with the removed value, and searches for the
+/// unsupported values after the last removed value of the queue item
+void Ns_ConstrTable::LocalArcCons(Ns_QueueItem& Qitem)
+{
+        updateLocally(Qitem);
+        if (Qitem.lastRemovedValueFor(this))
+                ArcCons();
 }
 
 void Ns_ConstrElement::ArcCons(void)
@@ -894,6 +1994,98 @@ void Ns_ConstrVarArrElement::LocalArcCons(Ns_QueueItem& /*Qitem*/)
         ArcCons();
 }
 
+/// Appends a nogood, which is watched by the next ArcCons() call
+void Ns_ConstrNogoods::add(const NsDeque<Literal>& nogood)
+{
+        literals.insert(literals.end(), nogood.begin(), nogood.end());
+        starts.push_back(literals.size());
+}
+
+/// Watches two literals of the nogood that do not hold
+///
+/// If there are not two, then the value of the first literal
+/// is removed. The constraint is attached to the variables of
+/// the nogood here, and not in add(), because the number of the
+/// live constraints of a variable is restored on backtracking.
+void Ns_ConstrNogoods::watch(const NsIndex nogood)
+{
+        NsIndex first = starts[nogood];
+        NsIndex end = starts[nogood + 1];
+        for (NsIndex i = first; i < end; ++i) {
+                Ns_pointer_t varPointer = (Ns_pointer_t)literals[i].var;
+                if (watches.count(varPointer) == 0) {
+                        // The first nogood of the variable
+                        watches[varPointer];
+                        literals[i].var->addConstraint(this);
+                }
+        }
+        NsIndex nWatches = 0;
+        for (NsIndex i = first; i < end && nWatches < 2; ++i) {
+                if (!literals[i].holds()) {
+                        std::swap(literals[first + nWatches], literals[i]);
+                        ++nWatches;
+                }
+        }
+        if (nWatches < 2) {
+                literals[first].var->removeSingle(literals[first].value, this);
+                return;
+        }
+        watches[(Ns_pointer_t)literals[first].var].push_back(nogood);
+        watches[(Ns_pointer_t)literals[first + 1].var].push_back(nogood);
+}
+
+/// Watches the nogoods that have been added since the last call
+///
+/// It is called at the root of the search, where the removals
+/// of the values of the unit nogoods are never restored.
+void Ns_ConstrNogoods::ArcCons(void)
+{
+        for (; nWatched < size(); ++nWatched)
+                watch(nWatched);
+}
+
+void Ns_ConstrNogoods::LocalArcCons(Ns_QueueItem& Qitem)
+{
+        NsIntVar* V = Qitem.getVarFired();
+        if (!V->isBound())
+                return;
+        VarPointerIndices_t::iterator watching =
+            watches.find((Ns_pointer_t)V);
+        if (watching == watches.end())
+                return;
+        NsDeque<NsIndex>& watchers = watching->second;
+        NsIndex kept = 0;
+        for (NsIndex w = 0; w < watchers.size(); ++w) {
+                NsIndex nogood = watchers[w];
+                NsIndex first = starts[nogood];
+                NsIndex end = starts[nogood + 1];
+                // The literal of V is placed first
+                if (literals[first].var != V)
+                        std::swap(literals[first], literals[first + 1]);
+                bool moved = false;
+                if (literals[first].value == V->value()) {
+                        // The literal holds; another one is watched
+                        for (NsIndex i = first + 2; i < end; ++i) {
+                                if (!literals[i].holds()) {
+                                        std::swap(literals[first], literals[i]);
+                                        watches[(Ns_pointer_t)literals[first]
+                                                    .var]
+                                            .push_back(nogood);
+                                        moved = true;
+                                        break;
+                                }
+                        }
+                        if (!moved) {
+                                literals[first + 1].var->removeSingle(
+                                    literals[first + 1].value, this);
+                        }
+                }
+                if (!moved)
+                        watchers[kept++] = nogood;
+        }
+        watchers.resize(kept);
+}
+
 /// @{
 /// @name Representation of higher order constraints in a graph
 
@@ -37,26 +37,566 @@ inline bool isContinuous(const NsInt minVal, const NsInt maxVal,
         return (diff + 1 == setCount);
 }
 
+/// The number of bits that a machine word can hold
+const NsUInt WORD_BITS = CHAR_BIT * sizeof(size_t);
+
+/// Returns a machine word having set only the bits [fromBit..toBit]
+inline size_t rangeMask(const NsUInt fromBit, const NsUInt toBit)
+{
+        return ((~static_cast<size_t>(0u) >> (WORD_BITS - 1 - toBit)) &
+                (~static_cast<size_t>(0u) << fromBit));
+}
+
+/// Returns the position of the lowest set bit of a non-zero machine word
+inline NsUInt lowestBit(const size_t word)
+{
+#ifdef __GNUC__
+        return __builtin_ctzll(word);
+#else
+        NsUInt nbit = 0;
+        for (size_t w = word; !(w & 1u); w >>= 1)
+                ++nbit;
+        return nbit;
+#endif
+}
+
+/// Returns the position of the highest set bit of a non-zero machine word
+inline NsUInt highestBit(const size_t word)
+{
+#ifdef __GNUC__
+        return (CHAR_BIT * sizeof(unsigned long long) - 1 -
+                __builtin_clzll(word));
+#else
+        NsUInt nbit = 0;
+        for (size_t w = word >> 1; w != 0; w >>= 1)
+                ++nbit;
+        return nbit;
+#endif
+}
+
+/// Returns the number of the set bits of a machine word
+inline NsUInt bitsCount(const size_t word)
+{
+#ifdef __GNUC__
+        return __builtin_popcountll(word);
+#else
+        NsUInt count = 0;
+        for (size_t w = word; w != 0; w &= w - 1)
+                ++count;
+        return count;
+#endif
+}
+
+/// Returns the first set bit in [fromBit..toBit], or NsUPLUS_INF if none
+NsUInt firstSetBit(const NsDeque<size_t>& machw, const NsUInt fromBit,
+                   const NsUInt toBit)
+{
+        NsUInt mw = fromBit / WORD_BITS;
+        NsUInt lastWord = toBit / WORD_BITS;
+        size_t word =
+            machw[mw] & (~static_cast<size_t>(0u) << fromBit % WORD_BITS);
+        while (word == 0u) {
+                if (mw == lastWord)
+                        return NsUPLUS_INF;
+                word = machw[++mw];
+        }
+        NsUInt nbit = mw * WORD_BITS + lowestBit(word);
+        return ((nbit <= toBit) ? nbit : NsUPLUS_INF);
+}
+
+/// Returns the last set bit in [fromBit..toBit], or NsUPLUS_INF if none
+NsUInt lastSetBit(const NsDeque<size_t>& machw, const NsUInt fromBit,
+                  const NsUInt toBit)
+{
+        NsUInt mw = toBit / WORD_BITS;
+        NsUInt firstWord = fromBit / WORD_BITS;
+        size_t word = machw[mw] & rangeMask(0, toBit % WORD_BITS);
+        while (word == 0u) {
+                if (mw == firstWord)
+                        return NsUPLUS_INF;
+                word = machw[--mw];
+        }
+        NsUInt nbit = mw * WORD_BITS + highestBit(word);
+        return ((nbit >= fromBit) ? nbit : NsUPLUS_INF);
+}
+
+/// Returns the first unset bit in [fromBit..toBit], or NsUPLUS_INF if none
+NsUInt firstUnsetBit(const NsDeque<size_t>& machw, const NsUInt fromBit,
+                     const NsUInt toBit)
+{
+        NsUInt mw = fromBit / WORD_BITS;
+        NsUInt lastWord = toBit / WORD_BITS;
+        size_t word =
+            ~machw[mw] & (~static_cast<size_t>(0u) << fromBit % WORD_BITS);
+        while (word == 0u) {
+                if (mw == lastWord)
+                        return NsUPLUS_INF;
+                word = ~machw[++mw];
+        }
+        NsUInt nbit = mw * WORD_BITS + lowestBit(word);
+        return ((nbit <= toBit) ? nbit : NsUPLUS_INF);
+}
+
+/// Describes an arbitrary set of values as an array of machine words
+///
+/// If the i-th bit is active, the set contains firstVal + i.
+class WordsMask {
+
+    private:
+        NsInt firstVal;
+
+        const NsDeque<size_t>& words;
+
+    public:
+        WordsMask(const NsInt firstVal_init, const NsDeque<size_t>& words_init)
+          : firstVal(firstVal_init), words(words_init)
+        {
+        }
+
+        /// Returns a machine word whose i-th bit is active if the set
+        /// contains val + i
+        size_t bitsFrom(const NsInt val) const
+        {
+                if (words.empty())
+                        return 0u;
+                if (val < firstVal) {
+                        NsUInt shift = correspondingBit(firstVal, val);
+                        return ((shift < WORD_BITS) ? words[0] << shift : 0u);
+                }
+                NsUInt nbit = correspondingBit(val, firstVal);
+                NsUInt mw = nbit / WORD_BITS;
+                if (mw >= words.size())
+                        return 0u;
+                size_t bits = words[mw] >> nbit % WORD_BITS;
+                if (nbit % WORD_BITS != 0 && mw + 1 < words.size())
+                        bits |= words[mw + 1] << (WORD_BITS - nbit % WORD_BITS);
+                return bits;
+        }
+
+        bool contains(const NsInt val) const
+        {
+                if (val < firstVal)
+                        return false;
+                NsUInt nbit = correspondingBit(val, firstVal);
+                if (nbit / WORD_BITS >= words.size())
+                        return false;
+                return ((words[nbit / WORD_BITS] >> nbit % WORD_BITS) & 1u);
+        }
+
+        /// Returns the smallest value of the set that is greater than val
+        NsInt next(const NsInt val) const
+        {
+                NsUInt nbit =
+                    (val < firstVal) ? 0 : correspondingBit(val, firstVal) + 1;
+                NsUInt nBits = words.size() * WORD_BITS;
+                if (nbit >= nBits)
+                        return NsPLUS_INF;
+                nbit = firstSetBit(words, nbit, nBits - 1);
+                return ((nbit == NsUPLUS_INF) ? NsPLUS_INF : firstVal + nbit);
+        }
+
+        /// Returns the greatest value of a non-empty set
+        NsInt max(void) const
+        {
+                return (firstVal +
+                        lastSetBit(words, 0, words.size() * WORD_BITS - 1));
+        }
+
+        /// Returns the smallest missing value in (val..max()), or NsPLUS_INF
+        NsInt nextGap(const NsInt val) const
+        {
+                NsUInt nbit = correspondingBit(val, firstVal) + 1;
+                NsUInt maxbit = correspondingBit(max(), firstVal);
+                if (nbit >= maxbit)
+                        return NsPLUS_INF;
+                nbit = firstUnsetBit(words, nbit, maxbit);
+                return ((nbit == NsUPLUS_INF) ? NsPLUS_INF : firstVal + nbit);
+        }
+};
+
+/// Returns the smallest value after val that the set lacks
+///
+/// The set should contain val.
+template <typename Set>
+NsInt nextMissing(const Set& set, const NsInt val)
+{
+        NsInt gap = set.nextGap(val);
+        return ((gap == NsPLUS_INF) ? set.max() + 1 : gap);
+}
+
+/// The order of the intervals of an interval list
+inline bool lastBefore(const Ns_BitSet::Interval& interval, const NsInt val)
+{
+        return (interval.last < val);
+}
+
 } // end namespace
 
 /// Constructs the domain [minDom_init..maxDom_init]
 Ns_BitSet::Ns_BitSet(NsProblemManager& pm_init, const NsInt minDom_init,
-                     const NsInt maxDom_init)
+                     const NsInt maxDom_init,
+                     const Representation representation_init)
   : pm(&pm_init),
+    representation(representation_init),
     minDom(minDom_init),
     minVal(minDom_init),
     maxVal(maxDom_init),
     nBits(correspondingBit(maxVal, minDom) + 1),
-    setCount(nBits)
+    setCount(nBits),
+    nWords(0),
+    trailWords(false),
+    trailStamp(0),
+    nTrailStamps(0),
+    singleWordStamp(0)
 {
         assert_Ns(NsMINUS_INF < minDom_init && minDom_init <= maxDom_init &&
-                      maxDom_init < NsPLUS_INF,
+                      maxDom_init < NsSTAR,
                   "Ns_BitSet::Ns_BitSet: Domain out of range");
         // Make 'lastSaveId' dirty as the domain has not been saved
         lastSaveId.id = NsUPLUS_INF;
         // Initialize 'lastSaveId.level' to prevent
         // valgrind from reporting a warning
         lastSaveId.level = 0;
+        if (representation == SPARSE_SET && nBits - 1 >= MAX_BITSET_SPAN) {
+                // The arrays would take too much memory, while a bit-set
+                // turns into an interval list if it gets holes
+                representation = BIT_SET;
+        }
+        if (representation == SPARSE_SET) {
+                denseValues.resize(nBits);
+                positions.resize(nBits);
+                for (NsUInt i = 0; i < nBits; ++i) {
+                        denseValues[i] = minDom + static_cast<NsInt>(i);
+                        positions[i] = i;
+                }
+        }
+}
+
+/// Makes the domain transparent to backtracking for the current search node
+void Ns_BitSet::transparent(void)
+{
+        lastSaveId = pm->getCurrentHistoryId();
+        trailWords = false;
+}
+
+/// Saves the machine word for backtracking, if it has not been saved
+/// since the last save of the domain
+void Ns_BitSet::saveWord(const NsUInt mw)
+{
+        if (!trailWords)
+                return;
+        if (nWords > 1 && wordStamps.empty())
+                wordStamps.assign(nWords, 0);
+        if (wordStamp(mw) != trailStamp) {
+                pm->saveBitsetWord(*this, mw);
+                wordStamp(mw) = trailStamp;
+        }
+}
+
+/// Saves the domain for future backtracking purposes, if not already saved
+void Ns_BitSet::save(void)
+{
+        if (!pm->isCurrentHistoryId(lastSaveHistoryId())) {
+                pm->saveBitsetDomain(*this);
+                trailWords = true;
+                trailStamp = ++nTrailStamps;
+        }
+}
+
+/// Creates the machine words of a domain that has been an interval so far
+void Ns_BitSet::createWords(void)
+{
+        // The machine words will be discarded altogether on backtracking
+        trailWords = false;
+        if (correspondingBit(maxVal, minVal) >= MAX_BITSET_SPAN) {
+                // A bit per value would take too much memory
+                representation = INTERVAL_LIST;
+                Interval whole = {minVal, maxVal};
+                intervals.push_back(whole);
+                return;
+        }
+        minDom = minVal;
+        nBits = correspondingBit(maxVal, minDom) + 1;
+        nWords = (nBits - 1) / MW_BITS + 1;
+        if (nWords == 1) {
+                singleWord = rangeMask(0, nBits - 1);
+        } else {
+                machw.resize(nWords);
+                for (NsUInt i = 0; i < nWords; ++i)
+                        machw[i] = ~static_cast<size_t>(0u);
+                // Set the bits of the last machine word
+                if (nBits % MW_BITS != 0)
+                        machw[nWords - 1] = rangeMask(0, nBits % MW_BITS - 1);
+        }
+}
+
+/// Returns true if the sparse set contains val, which is in [minVal..maxVal]
+bool Ns_BitSet::sparseContains(const NsInt val) const
+{
+        return (positions[correspondingBit(val, minDom)] < setCount);
+}
+
+/// Exchanges the positions of the i-th and the j-th values of the sparse set
+void Ns_BitSet::sparseSwap(const NsUInt i, const NsUInt j)
+{
+        NsInt val = denseValues[i];
+        denseValues[i] = denseValues[j];
+        denseValues[j] = val;
+        positions[correspondingBit(denseValues[i], minDom)] = i;
+        positions[correspondingBit(val, minDom)] = j;
+}
+
+/// Returns the minimum value of the sparse set that is not less than val
+///
+/// It examines either the values from val up to maxVal or the
+/// values of the set, whichever are fewer.
+NsInt Ns_BitSet::sparseFirstFrom(NsInt val) const
+{
+        if (correspondingBit(maxVal, val) < setCount) {
+                while (!sparseContains(val))
+                        ++val;
+                return val;
+        }
+        NsInt first = maxVal;
+        for (NsUInt i = 0; i < setCount; ++i) {
+                if (val <= denseValues[i] && denseValues[i] < first)
+                        first = denseValues[i];
+        }
+        return first;
+}
+
+/// Returns the maximum value of the sparse set that is not greater than val
+NsInt Ns_BitSet::sparseLastUpTo(NsInt val) const
+{
+        if (correspondingBit(val, minVal) < setCount) {
+                while (!sparseContains(val))
+                        --val;
+                return val;
+        }
+        NsInt last = minVal;
+        for (NsUInt i = 0; i < setCount; ++i) {
+                if (last < denseValues[i] && denseValues[i] <= val)
+                        last = denseValues[i];
+        }
+        return last;
+}
+
+/// Removes the values of the sparse set that are in [rangeMin..rangeMax]
+///
+/// The range should be inside [minVal..maxVal], without covering it.
+void Ns_BitSet::sparseRemoveRange(const NsInt rangeMin, const NsInt rangeMax)
+{
+        if (correspondingBit(rangeMax, rangeMin) < setCount) {
+                for (NsInt val = rangeMin; val <= rangeMax; ++val) {
+                        NsUInt i = positions[correspondingBit(val, minDom)];
+                        if (i < setCount)
+                                sparseSwap(i, --setCount);
+                }
+        } else {
+                // Scanning downwards, each value swapped into
+                // the i-th position has been already examined
+                for (NsUInt i = setCount; i-- > 0;) {
+                        if (rangeMin <= denseValues[i] &&
+                            denseValues[i] <= rangeMax)
+                                sparseSwap(i, --setCount);
+                }
+        }
+        if (rangeMin == minVal)
+                minVal = sparseFirstFrom(rangeMax + 1);
+        else if (rangeMax == maxVal)
+                maxVal = sparseLastUpTo(rangeMin - 1);
+}
+
+/// Returns a machine word whose i-th bit is active if the sparse set
+/// contains val+i, for val in [minVal..maxVal]
+size_t Ns_BitSet::sparseBitsFrom(const NsInt val) const
+{
+        if (isContinuous(minVal, maxVal, setCount))
+                return ~static_cast<size_t>(0u);
+        NsUInt span = correspondingBit(maxVal, val);
+        if (span > MW_BITS - 1)
+                span = MW_BITS - 1;
+        size_t bits = 0u;
+        for (NsUInt i = 0; i <= span; ++i) {
+                if (sparseContains(val + static_cast<NsInt>(i)))
+                        bits |= static_cast<size_t>(1u) << i;
+        }
+        return bits;
+}
+
+/// Keeps only the values of the sparse set that are contained in 'mask'
+///
+/// Returns false, without changing the domain, if no value is kept.
+template <typename Mask>
+bool Ns_BitSet::sparseKeepOnly(const Mask& mask)
+{
+        // Gather the values to be removed after the kept ones; the
+        // first 'setCount' values remain the same set meanwhile
+        NsUInt kept = setCount;
+        for (NsUInt i = setCount; i-- > 0;) {
+                if (!mask.contains(denseValues[i]))
+                        sparseSwap(i, --kept);
+        }
+        if (kept == 0)
+                return false;
+        if (kept == setCount)
+                return true;
+        save();
+        setCount = kept;
+        minVal = maxVal = denseValues[0];
+        for (NsUInt i = 1; i < setCount; ++i) {
+                if (denseValues[i] < minVal)
+                        minVal = denseValues[i];
+                else if (denseValues[i] > maxVal)
+                        maxVal = denseValues[i];
+        }
+        return true;
+}
+
+/// Saves an interval of the list before its edit, or after its insertion
+void Ns_BitSet::saveInterval(const NsUInt index, const IntervalEdit edit)
+{
+        if (trailWords)
+                pm->saveBitsetInterval(*this, index, edit);
+}
+
+/// Reverts an edit of the interval list, in order to backtrack
+void Ns_BitSet::undoInterval(const NsUInt index, const IntervalEdit edit,
+                             const Interval& oldInterval)
+{
+        switch (edit) {
+        case INTERVAL_CHANGED:
+                intervals[index] = oldInterval;
+                break;
+        case INTERVAL_INSERTED:
+                intervals.erase(intervals.begin() + index);
+                break;
+        case INTERVAL_ERASED:
+                intervals.insert(intervals.begin() + index, oldInterval);
+                break;
+        }
+}
+
+/// Returns the index of the first interval that ends at or after val
+///
+/// The binary search takes logarithmic time.
+NsUInt Ns_BitSet::intervalFrom(const NsInt val) const
+{
+        return (std::lower_bound(intervals.begin(), intervals.end(), val,
+                                 lastBefore) -
+                intervals.begin());
+}
+
+/// Removes the values of the interval list that are in [rangeMin..rangeMax]
+///
+/// The range should be inside [minVal..maxVal], without covering it.
+void Ns_BitSet::intervalRemoveRange(const NsInt rangeMin,
+                                    const NsInt rangeMax)
+{
+        NsUInt first = intervalFrom(rangeMin);
+        NsUInt end = first;
+        for (; end < intervals.size() && intervals[end].first <= rangeMax;
+             ++end) {
+                NsInt from = std::max(intervals[end].first, rangeMin);
+                NsInt to = std::min(intervals[end].last, rangeMax);
+                setCount -= correspondingBit(to, from) + 1;
+        }
+        if (rangeMin == minVal) {
+                // The intervals below the bounds are left intact
+                NsUInt i = intervalFrom(rangeMax + 1);
+                minVal = std::max(intervals[i].first, rangeMax + 1);
+                return;
+        }
+        if (rangeMax == maxVal) {
+                maxVal = (intervals[first].first < rangeMin)
+                             ? rangeMin - 1
+                             : intervals[first - 1].last;
+                return;
+        }
+        // Edit the intervals backwards, to keep the indices of
+        // the unprocessed ones valid
+        for (NsUInt i = end; i-- > first;) {
+                Interval& interval = intervals[i];
+                if (interval.first < rangeMin && rangeMax < interval.last) {
+                        Interval upper = {rangeMax + 1, interval.last};
+                        saveInterval(i, INTERVAL_CHANGED);
+                        interval.last = rangeMin - 1;
+                        intervals.insert(intervals.begin() + i + 1, upper);
+                        saveInterval(i + 1, INTERVAL_INSERTED);
+                } else if (interval.first < rangeMin) {
+                        saveInterval(i, INTERVAL_CHANGED);
+                        interval.last = rangeMin - 1;
+                } else if (rangeMax < interval.last) {
+                        saveInterval(i, INTERVAL_CHANGED);
+                        interval.first = rangeMax + 1;
+                } else {
+                        saveInterval(i, INTERVAL_ERASED);
+                        intervals.erase(intervals.begin() + i);
+                }
+        }
+}
+
+/// Returns a machine word whose i-th bit is active if the interval list
+/// contains val+i, for val in [minVal..maxVal]
+size_t Ns_BitSet::intervalBitsFrom(const NsInt val) const
+{
+        NsInt lastVal = (correspondingBit(maxVal, val) < MW_BITS)
+                            ? maxVal
+                            : val + static_cast<NsInt>(MW_BITS - 1);
+        size_t bits = 0u;
+        for (NsUInt i = intervalFrom(val);
+             i < intervals.size() && intervals[i].first <= lastVal; ++i) {
+                NsInt from = std::max(intervals[i].first, val);
+                NsInt to = std::min(intervals[i].last, lastVal);
+                bits |= rangeMask(correspondingBit(from, val),
+                                  correspondingBit(to, val));
+        }
+        return bits;
+}
+
+/// Returns the first value, not less than val, that both the domain and
+/// 'mask' contain, or NsPLUS_INF if there is no such value
+template <typename Mask>
+NsInt Ns_BitSet::firstCommon(const Mask& mask, NsInt val) const
+{
+        if (val < minVal)
+                val = minVal;
+        while (val <= maxVal) {
+                if (!contains(val))
+                        val = next(val);
+                else if (mask.contains(val))
+                        return val;
+                else
+                        val = mask.next(val);
+        }
+        return NsPLUS_INF;
+}
+
+/// Keeps only the values of the domain that are contained in 'mask'
+///
+/// It removes each range of values that 'mask' lacks at once, in
+/// order not to visit every value of a wide domain. 'Mask' should
+/// provide the contains(), next(), nextGap() and max() methods.
+/// Returns false, without changing the domain, if no value is kept.
+template <typename Mask>
+bool Ns_BitSet::keepOnlyRuns(const Mask& mask)
+{
+        NsInt val = firstCommon(mask, minVal);
+        if (val == NsPLUS_INF)
+                return false;
+        removeRange(NsMINUS_INF, val - 1);
+        for (;;) {
+                NsInt gap = nextMissing(mask, val);
+                if (gap > maxVal)
+                        break;
+                val = firstCommon(mask, gap);
+                if (val == NsPLUS_INF) {
+                        removeRange(gap, NsPLUS_INF);
+                        break;
+                }
+                removeRange(gap, val - 1);
+        }
+        return true;
 }
 
 /// Removes a range/interval of values
@@ -69,14 +609,17 @@ bool Ns_BitSet::removeRange(NsInt rangeMin, NsInt rangeMax)
         if (rangeMax < minVal || maxVal < rangeMin)
                 return true;
         // The domain is going to be changed...
-        // Save the domain for future backtracking purposes
-        if (!pm->isCurrentHistoryId(lastSaveHistoryId()))
-                pm->saveBitsetDomain(*this);
+        save();
         if (rangeMin < minVal)
                 rangeMin = minVal;
         if (rangeMax > maxVal)
                 rangeMax = maxVal;
-        if (machw.empty()) { // Bounds Consistency
+        if (representation == SPARSE_SET) {
+                sparseRemoveRange(rangeMin, rangeMax);
+                return true;
+        }
+        if (representation == BIT_SET && nWords == 0) {
+                // Bounds Consistency
                 if (rangeMin <= minVal) {
                         setCount -= rangeMax + 1 - minVal;
                         minVal = rangeMax + 1;
@@ -85,73 +628,193 @@ bool Ns_BitSet::removeRange(NsInt rangeMin, NsInt rangeMax)
                         setCount -= maxVal - (rangeMin - 1);
                         maxVal = rangeMin - 1;
                         return true;
+                }
+                createWords();
+        }
+        if (representation == INTERVAL_LIST) {
+                intervalRemoveRange(rangeMin, rangeMax);
+                return true;
+        }
+        NsUInt firstBit = correspondingBit(rangeMin, minDom);
+        NsUInt lastBit = correspondingBit(rangeMax, minDom);
+        assert_Ns(lastBit < nBits, "Ns_BitSet::removeRange: Machine word out "
+                                   "of '*this' range");
+        if (nWords == 1) {
+                size_t removed = singleWord & rangeMask(firstBit, lastBit);
+                if (removed == 0u)
+                        return true;
+                saveWord(0);
+                singleWord &= ~removed;
+                setCount -= bitsCount(removed);
+                minVal = minDom + lowestBit(singleWord);
+                maxVal = minDom + highestBit(singleWord);
+                return true;
+        }
+        // Clear the range word by word, using a mask for
+        // the first and the last (partially covered) words
+        NsUInt firstWord = firstBit / MW_BITS;
+        NsUInt lastWord = lastBit / MW_BITS;
+        for (NsUInt mw = firstWord; mw <= lastWord; ++mw) {
+                size_t removed =
+                    machw[mw] &
+                    rangeMask((mw == firstWord) ? firstBit % MW_BITS : 0,
+                              (mw == lastWord) ? lastBit % MW_BITS
+                                               : MW_BITS - 1);
+                if (removed != 0u) {
+                        saveWord(mw);
+                        machw[mw] &= ~removed;
+                        setCount -= bitsCount(removed);
+                }
+        }
+        if (rangeMin == minVal) {
+                minVal = minDom + firstSetBit(machw, lastBit + 1,
+                                              correspondingBit(maxVal, minDom));
+        } else if (rangeMax == maxVal) {
+                maxVal = minDom + lastSetBit(machw,
+                                             correspondingBit(minVal, minDom),
+                                             firstBit - 1);
+        }
+        return true;
+}
+
+/// Returns a machine word whose i-th bit is active if the domain contains val+i
+size_t Ns_BitSet::bitsFrom(const NsInt val) const
+{
+        if (val > maxVal)
+                return 0u;
+        // The values before minVal correspond to zeros
+        NsUInt shift = 0;
+        NsInt firstVal = val;
+        if (val < minVal) {
+                shift = correspondingBit(minVal, val);
+                if (shift >= MW_BITS)
+                        return 0u;
+                firstVal = minVal;
+        }
+        size_t bits;
+        if (representation == SPARSE_SET) {
+                bits = sparseBitsFrom(firstVal);
+        } else if (representation == INTERVAL_LIST) {
+                bits = intervalBitsFrom(firstVal);
+        } else if (nWords == 0) {
+                bits = ~static_cast<size_t>(0u);
+        } else {
+                NsUInt nbit = correspondingBit(firstVal, minDom);
+                if (nWords == 1) {
+                        bits = singleWord >> nbit;
                 } else {
-                        // Create the array 'machw'
-                        minDom = minVal;
-                        nBits = correspondingBit(maxVal, minDom) + 1;
-                        machw.resize((nBits - 1) / MW_BITS + 1);
-                        for (NsUInt i = 0; i < machw.size(); ++i)
-                                machw[i] = ~static_cast<size_t>(0u);
-                        // Set the bits of the last machine word
-                        if (nBits % MW_BITS != 0) {
-                                for (size_t bit = static_cast<size_t>(1)
-                                                  << (nBits % MW_BITS);
-                                     bit != 0; bit <<= 1) {
-                                        machw[machw.size() - 1] &= ~bit;
-                                }
+                        NsUInt mw = nbit / MW_BITS;
+                        bits = machw[mw] >> nbit % MW_BITS;
+                        if (nbit % MW_BITS != 0 && mw + 1 < nWords) {
+                                bits |= machw[mw + 1]
+                                        << (MW_BITS - nbit % MW_BITS);
                         }
-                        // Continue on resetting the value...
                 }
         }
-        bool changedMinVal = false, changedMaxVal = false;
-        for (NsInt val = rangeMin; val <= rangeMax; ++val) {
-                NsUInt nbit = correspondingBit(val, minDom);
-                NsUInt mw = nbit / MW_BITS;
-                assert_Ns(minVal <= val && val <= maxVal && nbit < nBits,
-                          "Ns_BitSet::removeRange: Machine word out of '*this' "
-                          "range");
-                if (machw[mw] == 0u) {
-                        // Speedup by means of comparing the whole word
-                        if (MW_BITS - nbit % MW_BITS >
-                            static_cast<NsUInt>(rangeMax - val)) {
+        bits <<= shift;
+        // The values after maxVal correspond to zeros
+        NsUInt span = correspondingBit(maxVal, val);
+        if (span < MW_BITS - 1)
+                bits &= rangeMask(0, span);
+        return bits;
+}
+
+/// Keeps only the values of the domain that are contained in 'mask'
+///
+/// 'Mask' should provide a bitsFrom() method like Ns_BitSet's.
+/// Returns false, without changing the domain, if no value is kept.
+template <typename Mask>
+bool Ns_BitSet::keepOnly(const Mask& mask)
+{
+        if (representation == SPARSE_SET)
+                return sparseKeepOnly(mask);
+        if (representation == INTERVAL_LIST ||
+            (nWords == 0 &&
+             correspondingBit(maxVal, minVal) >= MAX_BITSET_SPAN))
+                return keepOnlyRuns(mask);
+        // Find the new bounds of the domain
+        NsUInt span = correspondingBit(maxVal, minVal);
+        NsInt newMin = NsPLUS_INF;
+        for (NsUInt offset = 0; offset <= span; offset += MW_BITS) {
+                NsInt val = minVal + offset;
+                size_t common = bitsFrom(val) & mask.bitsFrom(val);
+                if (common != 0u) {
+                        newMin = val + lowestBit(common);
+                        break;
+                }
+                if (span - offset < MW_BITS)
+                        break;
+        }
+        if (newMin == NsPLUS_INF)
+                return false;
+        NsInt newMax = newMin;
+        for (NsUInt offset = span;; offset -= MW_BITS) {
+                NsUInt start = (offset >= MW_BITS - 1) ? offset - (MW_BITS - 1)
+                                                       : 0;
+                NsInt val = minVal + start;
+                size_t common = bitsFrom(val) & mask.bitsFrom(val) &
+                                rangeMask(0, offset - start);
+                if (common != 0u) {
+                        newMax = val + highestBit(common);
+                        break;
+                }
+                if (start == 0)
+                        break;
+        }
+        // Cut the bounds and then the intermediate values
+        removeRange(NsMINUS_INF, newMin - 1);
+        removeRange(newMax + 1, NsPLUS_INF);
+        if (minVal == maxVal)
+                return true;
+        NsUInt firstBit, lastBit;
+        if (nWords == 0) {
+                // Check if the interval should get holes
+                span = correspondingBit(maxVal, minVal);
+                bool holes = false;
+                for (NsUInt offset = 0; !holes; offset += MW_BITS) {
+                        size_t needed =
+                            (span - offset < MW_BITS - 1)
+                                ? rangeMask(0, span - offset)
+                                : ~static_cast<size_t>(0u);
+                        holes = ((mask.bitsFrom(minVal + offset) & needed) !=
+                                 needed);
+                        if (span - offset < MW_BITS)
                                 break;
-                        }
-                        val += MW_BITS - nbit % MW_BITS - 1;
-                        // '-1' above is used to compensate
-                        // the for's '++val' increment.
-                } else if (machw[mw] == ~static_cast<size_t>(0u) &&
-                           nbit % MW_BITS == 0 &&
-                           val + static_cast<NsInt>(MW_BITS) - 1 <= rangeMax) {
-                        // Speedup by means of comparing the whole word
-                        machw[mw] = 0u;
-                        setCount -= MW_BITS;
-                        if (val == minVal)
-                                changedMinVal = true;
-                        val += MW_BITS - 1;
-                        // '-1' above is used to compensate
-                        // the for's '++val' increment.
-                        if (val == maxVal)
-                                changedMaxVal = true;
-                } else {
-                        size_t mwbit = static_cast<size_t>(1)
-                                       << (nbit % MW_BITS);
-                        if (machw[mw] & mwbit) {
-                                machw[mw] &= ~mwbit;
-                                --setCount;
-                                if (val == minVal)
-                                        changedMinVal = true;
-                                if (val == maxVal)
-                                        changedMaxVal = true;
-                        }
+                }
+                if (!holes)
+                        return true;
+                save();
+                createWords();
+        }
+        firstBit = correspondingBit(minVal, minDom);
+        lastBit = correspondingBit(maxVal, minDom);
+        for (NsUInt mw = firstBit / MW_BITS; mw <= lastBit / MW_BITS; ++mw) {
+                size_t& word = (nWords == 1) ? singleWord : machw[mw];
+                size_t removed =
+                    word & ~mask.bitsFrom(minDom + static_cast<NsInt>(
+                                                       mw * MW_BITS));
+                if (removed != 0u) {
+                        save();
+                        saveWord(mw);
+                        word &= ~removed;
+                        setCount -= bitsCount(removed);
                 }
         }
-        if (changedMinVal)
-                minVal = next(minVal);
-        if (changedMaxVal)
-                maxVal = previous(maxVal);
         return true;
 }
 
+/// Keeps only the values that 'domain' contains too
+bool Ns_BitSet::intersect(const Ns_BitSet& domain)
+{
+        return keepOnly(domain);
+}
+
+/// Keeps only the values firstVal + i, for each active i-th bit of 'mask'
+bool Ns_BitSet::intersect(const NsInt firstVal, const NsDeque<size_t>& mask)
+{
+        return keepOnly(WordsMask(firstVal, mask));
+}
+
 NsInt Ns_BitSet::previous(const NsInt val) const
 {
         if (val <= minVal)
@@ -160,36 +823,20 @@ NsInt Ns_BitSet::previous(const NsInt val) const
                 return maxVal;
         if (isContinuous(minVal, maxVal, setCount))
                 return (val - 1); // Bounds Consistency
+        if (representation == SPARSE_SET)
+                return sparseLastUpTo(val - 1);
+        if (representation == INTERVAL_LIST) {
+                NsUInt i = intervalFrom(val - 1);
+                return ((intervals[i].first < val) ? val - 1
+                                                   : intervals[i - 1].last);
+        }
         NsUInt nbit = correspondingBit(val, minDom) - 1;
-        NsInt mw = nbit / MW_BITS;
-        size_t mwbit = static_cast<size_t>(1) << (nbit % MW_BITS);
         assert_Ns(nbit < nBits,
                   "Ns_BitSet::previous: Machine word out of '*this' range");
-        if (machw[mw] == 0u) {
-                // Speedup by means of comparing the whole word
-                nbit = mw * MW_BITS - 1;
-        } else {
-                for (/*VOID*/; mwbit != 0; mwbit >>= 1) {
-                        if (machw[mw] & mwbit)
-                                return (nbit + minDom);
-                        --nbit;
-                }
-        }
-        --mw;
-        for (/*VOID*/; mw >= 0; --mw) {
-                if (machw[mw] == 0u) {
-                        // Speedup by means of comparing the whole word
-                        nbit -= MW_BITS;
-                } else {
-                        for (mwbit = static_cast<size_t>(1) << (MW_BITS - 1);
-                             mwbit != 0; mwbit >>= 1) {
-                                if (machw[mw] & mwbit)
-                                        return (nbit + minDom);
-                                --nbit;
-                        }
-                }
-        }
-        throw NsException("Ns_BitSet::previous: Should not reach here");
+        if (nWords == 1)
+                return (minDom + highestBit(singleWord & rangeMask(0, nbit)));
+        return (minDom +
+                lastSetBit(machw, correspondingBit(minVal, minDom), nbit));
 }
 
 NsInt Ns_BitSet::next(const NsInt val) const
@@ -200,35 +847,22 @@ NsInt Ns_BitSet::next(const NsInt val) const
                 return minVal;
         if (isContinuous(minVal, maxVal, setCount))
                 return (val + 1); // Bounds Consistency
+        if (representation == SPARSE_SET)
+                return sparseFirstFrom(val + 1);
+        if (representation == INTERVAL_LIST) {
+                NsUInt i = intervalFrom(val + 1);
+                return ((intervals[i].first > val) ? intervals[i].first
+                                                   : val + 1);
+        }
         NsUInt nbit = correspondingBit(val, minDom) + 1;
-        NsUInt mw = nbit / MW_BITS;
-        size_t mwbit = static_cast<size_t>(1) << (nbit % MW_BITS);
         assert_Ns(nbit < nBits,
                   "Ns_BitSet::next: Machine word out of '*this' range");
-        if (machw[mw] == 0u) {
-                // Speedup by means of comparing the whole word
-                nbit = (mw + 1) * MW_BITS;
-        } else {
-                for (/*VOID*/; mwbit != 0; mwbit <<= 1) {
-                        if (machw[mw] & mwbit)
-                                return (nbit + minDom);
-                        ++nbit;
-                }
+        if (nWords == 1) {
+                return (minDom + lowestBit(singleWord &
+                                           (~static_cast<size_t>(0u) << nbit)));
         }
-        ++mw;
-        for (/*VOID*/; mw < machw.size(); ++mw) {
-                if (machw[mw] == 0u) {
-                        // Speedup by means of comparing the whole word
-                        nbit += MW_BITS;
-                } else {
-                        for (mwbit = 1; mwbit != 0; mwbit <<= 1) {
-                                if (machw[mw] & mwbit)
-                                        return (nbit + minDom);
-                                ++nbit;
-                        }
-                }
-        }
-        throw NsException("Ns_BitSet::next: Should not reach here");
+        return (minDom +
+                firstSetBit(machw, nbit, correspondingBit(maxVal, minDom)));
 }
 
 NsInt Ns_BitSet::nextGap(const NsInt val) const
@@ -237,41 +871,35 @@ NsInt Ns_BitSet::nextGap(const NsInt val) const
             isContinuous(minVal, maxVal, setCount)) { // Bounds Consistency
                 return NsPLUS_INF;
         }
+        if (representation == SPARSE_SET) {
+                NsInt gap = ((val < minVal) ? minVal : val) + 1;
+                while (gap < maxVal && sparseContains(gap))
+                        ++gap;
+                return ((gap < maxVal) ? gap : NsPLUS_INF);
+        }
+        if (representation == INTERVAL_LIST) {
+                NsInt gap = ((val < minVal) ? minVal : val) + 1;
+                NsUInt i = intervalFrom(gap);
+                if (intervals[i].first <= gap)
+                        gap = intervals[i].last + 1;
+                return ((gap < maxVal) ? gap : NsPLUS_INF);
+        }
         NsUInt nbit;
         if (val < minVal)
                 nbit = correspondingBit(minVal, minDom) + 1;
         else
                 nbit = correspondingBit(val, minDom) + 1;
-        NsUInt mw = nbit / MW_BITS;
-        size_t mwbit = static_cast<size_t>(1) << (nbit % MW_BITS);
         NsUInt maxbit = correspondingBit(maxVal, minDom);
         assert_Ns(maxbit < nBits && nbit < nBits,
                   "Ns_BitSet::nextGap: Machine word out of '*this' range");
-        if (machw[mw] == ~static_cast<size_t>(0u)) {
-                // Speedup by means of comparing the whole word
-                nbit = (mw + 1) * MW_BITS;
+        NsUInt gapbit;
+        if (nWords == 1) {
+                size_t gaps = ~singleWord & rangeMask(nbit, maxbit);
+                gapbit = (gaps == 0u) ? NsUPLUS_INF : lowestBit(gaps);
         } else {
-                for (/*VOID*/; mwbit != 0 && nbit <= maxbit; mwbit <<= 1) {
-                        if (!(machw[mw] & mwbit))
-                                return (nbit + minDom);
-                        ++nbit;
-                }
+                gapbit = firstUnsetBit(machw, nbit, maxbit);
         }
-        ++mw;
-        for (/*VOID*/; mw < machw.size(); ++mw) {
-                if (machw[mw] == ~static_cast<size_t>(0u)) {
-                        // Speedup by means of comparing the whole word
-                        nbit += MW_BITS;
-                } else {
-                        for (mwbit = 1; mwbit != 0 && nbit <= maxbit;
-                             mwbit <<= 1) {
-                                if (!(machw[mw] & mwbit))
-                                        return (nbit + minDom);
-                                ++nbit;
-                        }
-                }
-        }
-        return NsPLUS_INF;
+        return ((gapbit == NsUPLUS_INF) ? NsPLUS_INF : minDom + gapbit);
 }
 
 /// Returns true if the domain contains the range [rangeMin..rangeMax]
@@ -283,26 +911,27 @@ bool Ns_BitSet::containsRange(const NsInt rangeMin, const NsInt rangeMax) const
                 return false;
         if (isContinuous(minVal, maxVal, setCount))
                 return true; // Bounds Consistency
-        for (NsInt val = rangeMin; val <= rangeMax; ++val) {
-                NsUInt nbit = correspondingBit(val, minDom);
-                NsUInt mw = nbit / MW_BITS;
-                assert_Ns(nbit < nBits, "Ns_BitSet::containsRange: Machine "
-                                        "word out of '*this' range");
-                if (machw[mw] == ~static_cast<size_t>(0u)) {
-                        // Speedup by means of comparing the whole word
-                        if (MW_BITS - nbit % MW_BITS >
-                            static_cast<NsUInt>(rangeMax - val)) {
-                                break;
-                        }
-                        val += MW_BITS - nbit % MW_BITS - 1;
-                        // '-1' above is used to compensate
-                        // the for's '++val' increment.
-                } else {
-                        size_t mwbit = static_cast<size_t>(1)
-                                       << (nbit % MW_BITS);
-                        if (!(machw[mw] & mwbit))
+        if (representation == SPARSE_SET) {
+                if (correspondingBit(rangeMax, rangeMin) >= setCount)
+                        return false;
+                for (NsInt val = rangeMin; val <= rangeMax; ++val) {
+                        if (!sparseContains(val))
                                 return false;
                 }
+                return true;
         }
-        return true;
+        if (representation == INTERVAL_LIST) {
+                NsUInt i = intervalFrom(rangeMin);
+                return (intervals[i].first <= rangeMin &&
+                        rangeMax <= intervals[i].last);
+        }
+        NsUInt firstBit = correspondingBit(rangeMin, minDom);
+        NsUInt lastBit = correspondingBit(rangeMax, minDom);
+        assert_Ns(lastBit < nBits, "Ns_BitSet::containsRange: Machine word "
+                                   "out of '*this' range");
+        if (nWords == 1) {
+                size_t mask = rangeMask(firstBit, lastBit);
+                return ((singleWord & mask) == mask);
+        }
+        return (firstUnsetBit(machw, firstBit, lastBit) == NsUPLUS_INF);
 }
@@ -554,6 +554,47 @@ NsIntVar& Ns_ExprSum::post(void) const
 
 namespace {
 
+void exprLinear_post_constr(NsIntVar& VarX, const NsDeque<NsInt>& coeffs,
+                            NsIntVarArray& VarArr)
+{
+        Ns_Constraint* newConstr =
+            new Ns_ConstrXeqLinear(&VarX, coeffs, &VarArr);
+        VarX.addConstraint(newConstr);
+        for (NsIndex i = 0; i < VarArr.size(); ++i) {
+                if (coeffs[i] != 0)
+                        VarArr[i].addConstraint(newConstr);
+        }
+        VarArr.addConstraint();
+        newConstr->ArcCons();
+        VarX.manager().recordConstraint(newConstr);
+}
+
+} // end namespace
+
+void Ns_ExprLinear::post(NsIntVar& VarX) const
+{
+        assert_Ns(!VarArr.empty(),
+                  "Cannot get the weighted sum of an empty array");
+        NsInt summin, summax;
+        array_linear_min_max(coeffs, VarArr, summin, summax);
+        VarX = NsIntVar(VarArr[0].manager(), summin, summax);
+        exprLinear_post_constr(VarX, coeffs, VarArr);
+}
+
+NsIntVar& Ns_ExprLinear::post(void) const
+{
+        assert_Ns(!VarArr.empty(),
+                  "Cannot get the weighted sum of an empty array");
+        NsInt summin, summax;
+        array_linear_min_max(coeffs, VarArr, summin, summax);
+        NsIntVar* VarX = new NsIntVar(VarArr[0].manager(), summin, summax);
+        exprLinear_post_constr(*VarX, coeffs, VarArr);
+        VarX->manager().recordIntermediateVar(VarX);
+        return *VarX;
+}
+
+namespace {
+
 void array_elements_min_max(const NsDeque<NsInt>& intArray, NsIntVar& VarIndex,
                             NsInt& minElement, NsInt& maxElement)
 {
@@ -982,7 +1023,9 @@ Ns_Constraint* Ns_ExprConstrAllDiff::postConstraint(bool positively) const
         if (VarArr.size() <= Capacity || (Capacity == 0 && VarArr.size() <= 1))
                 return 0; // no constraint
         Ns_Constraint* newConstr;
-        if (Capacity == 0)
+        if (domainConsistency)
+                newConstr = new Ns_ConstrAllDiffDomain(&VarArr);
+        else if (Capacity == 0)
                 newConstr = new Ns_ConstrAllDiff(&VarArr); // default case
         else
                 newConstr = new Ns_ConstrAllDiffStrong(&VarArr, Capacity);
@@ -996,10 +1039,17 @@ Ns_Constraint* Ns_ExprConstrTable::postConstraint(bool positively) const
 {
         assert_Ns(positively,
                   "Ns_ExprConstrTable::postConstraint: 'positively'==false");
-        if (VarArr.empty() && table.empty())
-                return 0; // no constraint
-        Ns_Constraint* newConstr =
-            new Ns_ConstrTable(VarArr, table, isSupportsTable);
+        Ns_Constraint* newConstr;
+        if (table != 0) {
+                if (VarArr.empty() && table->empty())
+                        return 0; // no constraint
+                newConstr = new Ns_ConstrTable(VarArr, *table, isSupportsTable);
+        } else {
+                if (VarArr.empty() && compressedTable->empty())
+                        return 0; // no constraint
+                newConstr = new Ns_ConstrTable(VarArr, *compressedTable,
+                                               isSupportsTable);
+        }
         for (NsIntVarArray::iterator X = VarArr.begin(); X != VarArr.end(); ++X)
                 X->addConstraint(newConstr);
         VarArr.addConstraint();
@@ -50,10 +50,13 @@ void NsIntVar::removeAll(void)
 }
 
 /// A bound (min or max) of the domain has been changed by the constraint constr
-void Ns_QueueItem::boundChangedBy(const Ns_Constraint* constr)
+///
+/// 'events' tells which bounds, as Ns_Constraint::EventType flags.
+void Ns_QueueItem::boundChangedBy(const Ns_Constraint* constr,
+                                  const int events)
 {
         removedBoundRec.boundChangedBy(
-            constr, varFired->manager().numConstraintChecks());
+            constr, varFired->manager().numConstraintChecks(), events);
 }
 
 /// Adds the tuple (removedValue, constraintThatRemovedIt) of the removedValues
@@ -69,14 +72,18 @@ bool NsIntVar::removeRange(const NsInt first, const NsInt last,
 {
         bool rangeEmpty = true;
         // Check for bounds modifications.
-        if ((first <= min() && min() <= last) ||
-            (first <= max() && max() <= last)) {
+        int events = 0;
+        if (first <= min() && min() <= last)
+                events |= Ns_Constraint::MIN_EVENT;
+        if (first <= max() && max() <= last)
+                events |= Ns_Constraint::MAX_EVENT;
+        if (events != 0) {
                 rangeEmpty = false;
                 if (queueItem == 0) {
                         pm->getQueue().push(Ns_QueueItem(this));
                         queueItem = &pm->getQueue().back();
                 }
-                queueItem->boundChangedBy(constr);
+                queueItem->boundChangedBy(constr, events);
         }
         // Check for modifications of the intermediate values of the
         // domain, if necessary. (E.g. when they must be stored for arc
@@ -102,19 +109,133 @@ bool NsIntVar::removeRange(const NsInt first, const NsInt last,
                 }
         }
         if (!rangeEmpty) {
+                NsUInt oldSize = size();
                 if (!domain.removeRange(first, last)) {
                         pm->foundAnInconsistency();
                         return false;
                 } else {
                         modified = true;
+                        shrunk(oldSize);
                 }
         }
         return true;
 }
 
+/// Records the bounds modification (if any) after a removal of many values
+///
+/// 'kept' is false if the removal would empty the domain.
+bool NsIntVar::bulkRemoved(const bool kept, const NsInt oldMin,
+                           const NsInt oldMax, const NsUInt oldSize,
+                           const Ns_Constraint* constr, bool& modified)
+{
+        if (!kept) {
+                pm->foundAnInconsistency();
+                return false;
+        }
+        if (size() != oldSize) {
+                modified = true;
+                shrunk(oldSize);
+                int events = 0;
+                if (min() != oldMin)
+                        events |= Ns_Constraint::MIN_EVENT;
+                if (max() != oldMax)
+                        events |= Ns_Constraint::MAX_EVENT;
+                if (events != 0) {
+                        if (queueItem == 0) {
+                                pm->getQueue().push(Ns_QueueItem(this));
+                                queueItem = &pm->getQueue().back();
+                        }
+                        queueItem->boundChangedBy(constr, events);
+                }
+        }
+        return true;
+}
+
+bool NsIntVar::intersect(const NsIntVar& V, const Ns_Constraint* constr,
+                         bool& modified)
+{
+        if (storeRemovedValues()) {
+                // Each removed value has to be recorded
+                if (!removeRange(NsMINUS_INF, V.min() - 1, constr, modified) ||
+                    !removeRange(V.max() + 1, NsPLUS_INF, constr, modified))
+                        return false;
+                for (const_gap_iterator gap = V.gap_begin();
+                     gap != V.gap_end(); ++gap) {
+                        if (!removeRange(*gap, *gap, constr, modified))
+                                return false;
+                }
+                return true;
+        }
+        NsInt oldMin = min(), oldMax = max();
+        NsUInt oldSize = size();
+        return bulkRemoved(domain.intersect(V.domain), oldMin, oldMax, oldSize,
+                           constr, modified);
+}
+
+bool NsIntVar::intersect(const NsInt firstVal, const NsDeque<size_t>& mask,
+                         const Ns_Constraint* constr, bool& modified)
+{
+        if (storeRemovedValues()) {
+                // Each removed value has to be recorded
+                const NsUInt mwBits = CHAR_BIT * sizeof(size_t);
+                for (NsInt val = min(); val != NsPLUS_INF; val = next(val)) {
+                        NsUInt nbit = val - firstVal;
+                        if (val < firstVal || nbit / mwBits >= mask.size() ||
+                            !((mask[nbit / mwBits] >> nbit % mwBits) & 1u)) {
+                                if (!removeRange(val, val, constr, modified))
+                                        return false;
+                        }
+                }
+                return true;
+        }
+        NsInt oldMin = min(), oldMax = max();
+        NsUInt oldSize = size();
+        return bulkRemoved(domain.intersect(firstVal, mask), oldMin, oldMax,
+                           oldSize, constr, modified);
+}
+
+/// Informs the heaps that contain the variable that its domain shrunk
+void NsIntVar::updateFirstFailHeaps(void)
+{
+        for (FirstFailLink* link = firstFailLinks; link != 0;
+             link = link->next) {
+                link->heap->update(link->index);
+        }
+}
+
+/// Updates the search history of the variable after its domain shrunk
+void NsIntVar::shrunk(const NsUInt oldSize)
+{
+        if (firstFailLinks != 0)
+                updateFirstFailHeaps();
+        pm->domainShrunk();
+        if (!pm->learnsFromSearch())
+                return;
+        // The activity is bumped once per goal
+        if (activityTime != pm->numGoals()) {
+                activityScore = activity() + 1;
+                activityTime = pm->numGoals();
+        }
+        pm->searchSpaceReduced(oldSize, size());
+}
+
+double NsIntVar::activity(void) const
+{
+        if (activityScore == 0)
+                return 0;
+        return (activityScore *
+                std::pow(pm->activityDecay(), pm->numGoals() - activityTime));
+}
+
 void NsIntVar::addConstraint(Ns_Constraint* constr)
 {
-        constraints.push_back(ConstraintAndFailure(constr));
+        constraints.push_back(
+            ConstraintAndFailure(constr, constr->subscribedEvents(*this)));
+        // Place it before the constraints that have been entailed
+        std::swap(constraints[liveConstraints], constraints.back());
+        ++liveConstraints;
+        constr->scope.push_back(this);
+        weightedDegree += constr->weight;
         assert_Ns(constr->varsInvolvedIn() >= 1,
                   "NsIntVar::addConstraint: Wrong 'varsInvolvedIn' constraint "
                   "'constr'");
@@ -124,13 +245,24 @@ void NsIntVar::addConstraint(Ns_Constraint* constr)
 }
 
 NsIntVar::NsIntVar(NsProblemManager& pm_init, const NsInt min_init,
-                   const NsInt max_init)
+                   const NsInt max_init,
+                   const Ns_BitSet::Representation representation)
   : pm(&pm_init),
-    domain(pm_init, min_init, max_init),
+    domain(pm_init, min_init, max_init, representation),
+    liveConstraints(0),
     arcsConnectedTo(0),
     constraintNeedsRemovedValues(false),
-    queueItem(0)
+    weightedDegree(0),
+    activityScore(0),
+    activityTime(0),
+    impactScore(0),
+    impactSamples(0),
+    queueItem(0),
+    firstFailLinks(0)
 {
+        // Make 'liveConstraintsSaveId' dirty as it has not been saved
+        liveConstraintsSaveId.id = NsUPLUS_INF;
+        liveConstraintsSaveId.level = 0;
         pm->addVar(this);
 }
 
@@ -154,15 +286,26 @@ NsIntVar& NsIntVar::operator=(const Ns_Expression& expr)
         return *this;
 }
 
+void NsIntVar::dropConstraint(const NsIndex index)
+{
+        if (!pm->isCurrentHistoryId(liveConstraintsSaveId)) {
+                pm->saveLiveConstraints(*this);
+                liveConstraintsSaveId = pm->getCurrentHistoryId();
+        }
+        weightedDegree -= constraints[index].constr->weight;
+        --liveConstraints;
+        std::swap(constraints[index], constraints[liveConstraints]);
+}
+
 /// Makes variable transparent to backtracking/store; useful for temporary ones
 void NsIntVar::transparent(void)
 {
-        domain.lastSaveHistoryId() = manager().getCurrentHistoryId();
+        domain.transparent();
         manager().removeLastVar();
 }
 
 NsIntVarArray::NsIntVarArray(const Ns_ExpressionArray& expr)
-  : addedConstraint(false)
+  : addedConstraint(false), firstFailHeap(0)
 {
         expr.post(*this);
 }
@@ -215,3 +358,279 @@ void NsIntVarArray::push_back(const Ns_Expression& expr)
                   "because a constraint has been already imposed on the array");
         PointArray.push_back(&expr.post());
 }
+
+NsIndex NsIntVarArray::firstFailIndex(void) const
+{
+        if (PointArray.empty())
+                return NsINDEX_INF;
+        if (firstFailHeap == 0 || !firstFailHeap->orders(*this)) {
+                firstFailHeap = new Ns_FirstFailHeap(PointArray);
+                PointArray.front()->manager().recordFirstFailHeap(
+                    firstFailHeap);
+        }
+        return firstFailHeap->top();
+}
+
+void NsIntVarArray::firstFailIndices(NsDeque<NsIndex>& indices) const
+{
+        indices.clear();
+        if (firstFailIndex() != NsINDEX_INF)
+                firstFailHeap->minima(indices);
+}
+
+namespace {
+
+/// Chooses among the candidates of a heuristic that have the same score
+///
+/// When restarts are enabled, each of the tied candidates is
+/// chosen with the same probability (reservoir sampling);
+/// otherwise the first one is kept.
+class TieBreaker {
+
+    private:
+        /// The manager whose generator breaks the ties; null if the
+        /// first candidate is kept
+        NsProblemManager* pm;
+
+        /// The number of the candidates with the best score so far
+        unsigned long ties;
+
+    public:
+        TieBreaker(const NsIntVarArray& VarArr)
+          : pm((!VarArr.empty() && VarArr[0].manager().randomTies())
+                   ? &VarArr[0].manager()
+                   : 0),
+            ties(1)
+        {
+        }
+
+        /// True if the candidate should replace the best one so far
+        bool prefers(const bool better, const bool equal)
+        {
+                if (better) {
+                        ties = 1;
+                        return true;
+                }
+                if (!equal || pm == 0)
+                        return false;
+                ++ties;
+                return (pm->randomTie(ties) == 0);
+        }
+};
+
+/// The index of the unbound variable with the smallest domain size
+/// per degree
+///
+/// The degree is the weighted degree if 'weighted' is true,
+/// otherwise the number of the live constraints. A zero degree
+/// counts as one. Ties are broken in favor of the smallest index.
+NsIndex minSizePerDegree(const NsIntVarArray& VarArr, const bool weighted)
+{
+        TieBreaker tie(VarArr);
+        NsIndex index = NsINDEX_INF;
+        double minRatio = 0;
+        for (NsIndex i = 0; i < VarArr.size(); ++i) {
+                const NsIntVar& V = VarArr[i];
+                if (V.isBound())
+                        continue;
+                double degree =
+                    (weighted) ? V.weightedDegree : V.liveConstraints;
+                double ratio = V.size() / ((degree == 0) ? 1 : degree);
+                if (index == NsINDEX_INF ||
+                    tie.prefers(ratio < minRatio, ratio == minRatio)) {
+                        minRatio = ratio;
+                        index = i;
+                }
+        }
+        return index;
+}
+
+} // end namespace
+
+NsIndex NsIntVarArray::activityIndex(void) const
+{
+        if (!empty())
+                (*this)[0].manager().learnFromSearch();
+        TieBreaker tie(*this);
+        NsIndex index = NsINDEX_INF;
+        double maxRatio = 0;
+        NsUInt minSize = 0;
+        for (NsIndex i = 0; i < size(); ++i) {
+                const NsIntVar& V = (*this)[i];
+                if (V.isBound())
+                        continue;
+                double ratio = V.activity() / V.size();
+                if (index == NsINDEX_INF ||
+                    tie.prefers(ratio > maxRatio || (ratio == maxRatio &&
+                                                     V.size() < minSize),
+                                ratio == maxRatio && V.size() == minSize)) {
+                        maxRatio = ratio;
+                        minSize = V.size();
+                        index = i;
+                }
+        }
+        return index;
+}
+
+NsIndex NsIntVarArray::impactIndex(void) const
+{
+        if (!empty())
+                (*this)[0].manager().learnFromSearch();
+        TieBreaker tie(*this);
+        NsIndex index = NsINDEX_INF;
+        double minSpace = 0;
+        for (NsIndex i = 0; i < size(); ++i) {
+                const NsIntVar& V = (*this)[i];
+                if (V.isBound())
+                        continue;
+                double space = V.size() * (1 - V.impact());
+                if (index == NsINDEX_INF ||
+                    tie.prefers(space < minSpace, space == minSpace)) {
+                        minSpace = space;
+                        index = i;
+                }
+        }
+        return index;
+}
+
+NsIndex NsIntVarArray::domWdegIndex(void) const
+{
+        return minSizePerDegree(*this, true);
+}
+
+NsIndex NsIntVarArray::domDegIndex(void) const
+{
+        return minSizePerDegree(*this, false);
+}
+
+Ns_FirstFailHeap::Ns_FirstFailHeap(const Ns_PointArray_t& vars_init)
+  : pm(vars_init.front()->manager()),
+    vars(vars_init),
+    keys(vars.size()),
+    heap(vars.size()),
+    position(vars.size())
+{
+        for (NsIndex i = 0; i < vars.size(); ++i) {
+                links.push_back(
+                    NsIntVar::FirstFailLink(this, i, vars[i]->firstFailLinks));
+                vars[i]->firstFailLinks = &links.back();
+        }
+        build();
+}
+
+/// Fills the heap with the current domain sizes, in linear time
+void Ns_FirstFailHeap::build(void)
+{
+        heapSize = 0;
+        for (NsIndex i = 0; i < vars.size(); ++i) {
+                keys[i] = vars[i]->size();
+                if (vars[i]->isBound()) {
+                        position[i] = -1;
+                } else {
+                        heap[heapSize] = i;
+                        position[i] = heapSize;
+                        ++heapSize;
+                }
+        }
+        for (NsInt pos = heapSize / 2 - 1; pos >= 0; --pos)
+                siftDown(pos);
+        builtId = pm.getCurrentHistoryId();
+}
+
+/// Puts the i-th variable in the pos-th place of the heap
+void Ns_FirstFailHeap::place(const NsInt pos, const NsInt i)
+{
+        pm.saveValue(heap[pos]);
+        heap[pos] = i;
+        pm.saveValue(position[i]);
+        position[i] = pos;
+}
+
+void Ns_FirstFailHeap::siftUp(NsInt pos)
+{
+        NsInt i = heap[pos];
+        NsInt parent;
+        if (pos == 0 || !precedes(i, heap[parent = (pos - 1) / 2]))
+                return;
+        do {
+                place(pos, heap[parent]);
+                pos = parent;
+        } while (pos > 0 && precedes(i, heap[parent = (pos - 1) / 2]));
+        place(pos, i);
+}
+
+void Ns_FirstFailHeap::siftDown(NsInt pos)
+{
+        NsInt i = heap[pos];
+        NsInt child;
+        bool moved = false;
+        while ((child = 2 * pos + 1) < heapSize) {
+                if (child + 1 < heapSize &&
+                    precedes(heap[child + 1], heap[child]))
+                        ++child;
+                if (!precedes(heap[child], i))
+                        break;
+                place(pos, heap[child]);
+                pos = child;
+                moved = true;
+        }
+        if (moved)
+                place(pos, i);
+}
+
+/// Moves the i-th variable after its domain has shrunk
+///
+/// The domain sizes only decrease in a search subtree, so the
+/// variable can only rise in the heap, unless it is bound.
+void Ns_FirstFailHeap::update(const NsIndex i)
+{
+        if (position[i] < 0 || !pm.isValidHistoryId(builtId))
+                return;
+        if (!vars[i]->isBound()) {
+                pm.saveValue(keys[i]);
+                keys[i] = vars[i]->size();
+                siftUp(position[i]);
+                return;
+        }
+        // Replace the bound variable with the last one of the heap
+        NsInt pos = position[i];
+        pm.saveValue(position[i]);
+        position[i] = -1;
+        pm.saveValue(heapSize);
+        --heapSize;
+        if (pos == heapSize)
+                return;
+        NsInt last = heap[heapSize];
+        place(pos, last);
+        siftDown(pos);
+        siftUp(position[last]);
+}
+
+/// The index of the unbound variable with the smallest domain
+NsIndex Ns_FirstFailHeap::top(void)
+{
+        if (!pm.isValidHistoryId(builtId))
+                build();
+        return ((heapSize == 0) ? NsINDEX_INF : heap[0]);
+}
+
+/// Collects the variables that have the same domain size as top()
+///
+/// They form a subtree under the root of the heap.
+void Ns_FirstFailHeap::minima(NsDeque<NsIndex>& indices)
+{
+        if (top() == NsINDEX_INF)
+                return;
+        NsDeque<NsInt> toVisit;
+        toVisit.push_back(0);
+        while (!toVisit.empty()) {
+                NsInt pos = toVisit.back();
+                toVisit.pop_back();
+                if (pos >= heapSize || keys[heap[pos]] != keys[heap[0]])
+                        continue;
+                indices.push_back(heap[pos]);
+                toVisit.push_back(2 * pos + 1);
+                toVisit.push_back(2 * pos + 2);
+        }
+        std::sort(indices.begin(), indices.end());
+}
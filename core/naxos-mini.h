@@ -30,8 +30,10 @@
 #include <iostream>
 #include <list>
 #include <queue>
+#include <random>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 #include <unordered_map>
 #include <unordered_set>
@@ -93,6 +95,12 @@ const NsInt NsMINUS_INF = LONG_MIN;
 const NsInt NsPLUS_INF = LONG_MAX;
 const NsUInt NsUPLUS_INF = ULONG_MAX;
 
+/// A table cell that matches any value
+///
+/// It is not a valid domain value, as the domains lie between
+/// NsMINUS_INF and NsSTAR, exclusive.
+const NsInt NsSTAR = NsPLUS_INF - 1;
+
 /// @}
 
 class NsIntVar;
@@ -367,16 +375,58 @@ class NsProblemManager;
 
 class Ns_QueueItem;
 
+class Ns_FirstFailHeap;
+
 /// Class describing the domain of a constrained variable as a bit-set
 ///
 /// A bit-set is used to hold its values. If the i-th bit is
 /// active, then the domain contains the value minDom + i.
 class Ns_BitSet {
 
+    public:
+        /// The data structures that can hold the values of a domain
+        enum Representation {
+
+                /// An array of machine words having one bit per value
+                BIT_SET,
+
+                /// An array of the values, whose first 'setCount' elements
+                /// are the values of the domain, plus the position of each
+                /// value into it. A value is removed in constant time, by
+                /// swapping it after the last value of the domain, and
+                /// backtracking has only to restore 'setCount'.
+                SPARSE_SET,
+
+                /// An array of the disjoint intervals of values, in
+                /// ascending order. A bit-set domain turns into an
+                /// interval list when its span is too wide for a bit per
+                /// value. The intervals out of [minVal..maxVal] are
+                /// obsolete, in order to change the bounds without editing
+                /// the array.
+                INTERVAL_LIST
+        };
+
+        /// The range of values [first..last] of an interval list
+        struct Interval {
+
+                NsInt first;
+                NsInt last;
+        };
+
+        /// The modifications of an interval list that are undone on
+        /// backtracking
+        enum IntervalEdit {
+                INTERVAL_CHANGED,
+                INTERVAL_INSERTED,
+                INTERVAL_ERASED
+        };
+
     private:
         /// The problem manager to which the domain belongs to
         NsProblemManager* pm;
 
+        Representation representation;
+
         /// The initial minimum value of the domain
         NsInt minDom;
 
@@ -392,15 +442,121 @@ class Ns_BitSet {
         /// Number of the active bits (values) of the domain
         NsUInt setCount;
 
-        /// An array consisting of machine words: the bits for the bitset
+        /// Number of the machine words holding the bits
+        ///
+        /// It is zero while the domain is an interval, i.e. when
+        /// there is no need to keep its bits.
+        NsUInt nWords;
+
+        /// The bits of a domain that fit into one machine word
+        ///
+        /// Small domains keep their bits here, in order to avoid
+        /// the heap and the indirection of 'machw'.
+        size_t singleWord;
+
+        /// An array consisting of machine words: the bits for the bitset,
+        /// when they do not fit into 'singleWord'
         NsDeque<size_t> machw;
 
+        /// The values of a sparse set; the first 'setCount' of them
+        /// constitute the domain and the rest have been removed
+        ///
+        /// It stays empty, without allocating memory, for the other
+        /// representations.
+        std::vector<NsInt> denseValues;
+
+        /// The index into 'denseValues' of each value minus 'minDom'
+        std::vector<NsUInt> positions;
+
+        /// The intervals of an interval list
+        ///
+        /// It stays empty, without allocating memory, for the other
+        /// representations.
+        std::vector<Interval> intervals;
+
+        /// The widest span of a domain with holes that gets a bit per
+        /// value, or of a sparse set
+        static const NsUInt MAX_BITSET_SPAN = 1u << 16;
+
         /// The number of bits that a machine word can hold
         static const NsUInt MW_BITS = CHAR_BIT * sizeof(size_t);
 
         /// The 'timestamp' that can be used in chronological backtracking
         Ns_HistoryId_t lastSaveId;
 
+        /// True if the changed machine words, or intervals, should be saved
+        /// for backtracking
+        ///
+        /// It is false when the domain is transparent to backtracking, or
+        /// when the machine words (or intervals) have been created after the
+        /// last save, as restoring the saved state will then discard them.
+        bool trailWords;
+
+        /// Identifies the last save of the domain, in order to know
+        /// which machine words have been trailed since then
+        NsUInt trailStamp;
+
+        /// The number of the saves of the domain so far
+        ///
+        /// It is not restored on backtracking, so that each save
+        /// gets a different 'trailStamp'.
+        NsUInt nTrailStamps;
+
+        /// The 'trailStamp' when the single machine word was last trailed
+        NsUInt singleWordStamp;
+
+        /// The 'trailStamp' when each machine word of 'machw' was
+        /// last trailed
+        ///
+        /// It is allocated when the first word of 'machw' is trailed,
+        /// as the words of most domains are never trailed.
+        std::vector<NsUInt> wordStamps;
+
+        NsUInt& wordStamp(const NsUInt mw)
+        {
+                return (nWords == 1) ? singleWordStamp : wordStamps[mw];
+        }
+
+        void saveWord(const NsUInt mw);
+
+        void save(void);
+
+        void createWords(void);
+
+        template <typename Mask>
+        bool keepOnly(const Mask& mask);
+
+        bool sparseContains(const NsInt val) const;
+
+        void sparseSwap(const NsUInt i, const NsUInt j);
+
+        NsInt sparseFirstFrom(NsInt val) const;
+
+        NsInt sparseLastUpTo(NsInt val) const;
+
+        void sparseRemoveRange(const NsInt rangeMin, const NsInt rangeMax);
+
+        size_t sparseBitsFrom(const NsInt val) const;
+
+        template <typename Mask>
+        bool sparseKeepOnly(const Mask& mask);
+
+        void saveInterval(const NsUInt index, const IntervalEdit edit);
+
+        NsUInt intervalFrom(const NsInt val) const;
+
+        bool intervalContains(const NsInt val) const;
+
+        void intervalRemoveRange(const NsInt rangeMin, const NsInt rangeMax);
+
+        size_t intervalBitsFrom(const NsInt val) const;
+
+        template <typename Mask>
+        NsInt firstCommon(const Mask& mask, NsInt val) const;
+
+        template <typename Mask>
+        bool keepOnlyRuns(const Mask& mask);
+
     public:
         /// Returns the 'lastSaveId'
         Ns_HistoryId_t& lastSaveHistoryId(void)
@@ -408,12 +564,88 @@ class Ns_BitSet {
                 return lastSaveId;
         }
 
+        /// The domain state, except for the machine words, saved for
+        /// backtracking purposes
+        struct State {
+
+                Representation representation;
+                NsInt minDom;
+                NsInt minVal;
+                NsInt maxVal;
+                NsUInt nBits;
+                NsUInt setCount;
+                NsUInt nWords;
+                Ns_HistoryId_t lastSaveId;
+                bool trailWords;
+                NsUInt trailStamp;
+        };
+
+        State state(void) const
+        {
+                State st;
+                st.representation = representation;
+                st.minDom = minDom;
+                st.minVal = minVal;
+                st.maxVal = maxVal;
+                st.nBits = nBits;
+                st.setCount = setCount;
+                st.nWords = nWords;
+                st.lastSaveId = lastSaveId;
+                st.trailWords = trailWords;
+                st.trailStamp = trailStamp;
+                return st;
+        }
+
+        void restore(const State& st)
+        {
+                representation = st.representation;
+                if (representation != INTERVAL_LIST && !intervals.empty())
+                        intervals.clear();
+                minDom = st.minDom;
+                minVal = st.minVal;
+                maxVal = st.maxVal;
+                nBits = st.nBits;
+                setCount = st.setCount;
+                nWords = st.nWords;
+                if (nWords == 0 && !machw.empty()) {
+                        machw.clear();
+                        wordStamps.clear();
+                }
+                lastSaveId = st.lastSaveId;
+                trailWords = st.trailWords;
+                trailStamp = st.trailStamp;
+        }
+
+        size_t word(const NsUInt mw) const
+        {
+                return (nWords == 1) ? singleWord : machw[mw];
+        }
+
+        void restoreWord(const NsUInt mw, const size_t mwValue)
+        {
+                if (nWords == 1)
+                        singleWord = mwValue;
+                else
+                        machw[mw] = mwValue;
+        }
+
+        const Interval& interval(const NsUInt index) const
+        {
+                return intervals[index];
+        }
+
+        void undoInterval(const NsUInt index, const IntervalEdit edit,
+                          const Interval& oldInterval);
+
+        void transparent(void);
+
         Ns_BitSet(void)
         {
         }
 
         Ns_BitSet(NsProblemManager& pm_init, const NsInt minDom_init,
-                  const NsInt maxDom_init);
+                  const NsInt maxDom_init,
+                  const Representation representation_init = BIT_SET);
 
         Ns_BitSet* clone(void)
         {
@@ -448,8 +680,19 @@ class Ns_BitSet {
 
         bool containsRange(const NsInt rangeMin, const NsInt rangeMax) const;
 
+        bool contains(const NsInt val) const
+        {
+                return containsRange(val, val);
+        }
+
         bool removeRange(NsInt rangeMin, NsInt rangeMax);
 
+        size_t bitsFrom(const NsInt val) const;
+
+        bool intersect(const Ns_BitSet& domain);
+
+        bool intersect(const NsInt firstVal, const NsDeque<size_t>& mask);
+
         /// Generic function to print a domain
         friend std::ostream& operator<<(std::ostream& os,
                                         const Ns_BitSet& domain);
@@ -651,6 +894,82 @@ class Ns_BitSet {
                 }
         };
 
+        /// Iterates through the values of the domain in an arbitrary order
+        ///
+        /// For a sparse set, it visits only the values of the domain,
+        /// without skipping the removed ones.
+        class const_unordered_iterator {
+
+            private:
+                const Ns_BitSet* domain;
+                NsInt currVal;
+                NsUInt index;
+
+            public:
+                const_unordered_iterator(void) : domain(0)
+                {
+                }
+
+                const_unordered_iterator(const Ns_BitSet& domain_init)
+                  : domain(&domain_init), currVal(domain->min()), index(0)
+                {
+                        if (domain->representation == SPARSE_SET)
+                                currVal = domain->denseValues[index];
+                }
+
+                bool operator==(const const_unordered_iterator& b) const
+                {
+                        assert_Ns(domain != 0, "Ns_BitSet::const_unordered_"
+                                               "iterator::==: Uninitialized "
+                                               "'*this'");
+                        return (currVal == b.currVal);
+                }
+
+                bool operator!=(const const_unordered_iterator& b) const
+                {
+                        assert_Ns(domain != 0, "Ns_BitSet::const_unordered_"
+                                               "iterator::!=: Uninitialized "
+                                               "'*this'");
+                        return !(*this == b);
+                }
+
+                NsInt operator*(void)const
+                {
+                        assert_Ns(domain != 0, "Ns_BitSet::const_unordered_"
+                                               "iterator::*: Uninitialized "
+                                               "'*this'");
+                        assert_Ns(currVal != NsPLUS_INF,
+                                  "Ns_BitSet::const_unordered_iterator::*: Bad "
+                                  "request '*(something.end())'");
+                        return currVal;
+                }
+
+                const_unordered_iterator& end(void)
+                {
+                        assert_Ns(domain != 0, "Ns_BitSet::const_unordered_"
+                                               "iterator::end: Uninitialized "
+                                               "'*this'");
+                        currVal = NsPLUS_INF;
+                        return *this;
+                }
+
+                const_unordered_iterator& operator++(void)
+                {
+                        assert_Ns(domain != 0, "Ns_BitSet::const_unordered_"
+                                               "iterator::++: Uninitialized "
+                                               "'*this'");
+                        if (domain->representation == SPARSE_SET) {
+                                ++index;
+                                currVal = (index < domain->setCount)
+                                              ? domain->denseValues[index]
+                                              : NsPLUS_INF;
+                        } else {
+                                currVal = domain->next(currVal);
+                        }
+                        return *this;
+                }
+        };
+
         const const_iterator begin(void) const
         {
                 return const_iterator(*this);
@@ -683,6 +1002,17 @@ class Ns_BitSet {
                 const_gap_iterator iterEnd(*this);
                 return iterEnd.end();
         }
+
+        const const_unordered_iterator unordered_begin(void) const
+        {
+                return const_unordered_iterator(*this);
+        }
+
+        const const_unordered_iterator unordered_end(void) const
+        {
+                const_unordered_iterator iterEnd(*this);
+                return iterEnd.end();
+        }
 };
 
 std::ostream& operator<<(std::ostream& os, const Ns_BitSet& domain);
@@ -745,19 +1075,51 @@ class NsIntVar {
                 return iterEnd.end();
         }
 
+        typedef Ns_BitSet::const_unordered_iterator const_unordered_iterator;
+
+        /// Iterates through the values in an arbitrary order, which is
+        /// faster for a sparse set domain
+        const const_unordered_iterator unordered_begin(void) const
+        {
+                return const_unordered_iterator(domain);
+        }
+
+        const const_unordered_iterator unordered_end(void) const
+        {
+                const_unordered_iterator iterEnd(domain);
+                return iterEnd.end();
+        }
+
         /// @}
 
         /// Dummy constructor for the declaration of an uninitialized NsIntVar
         NsIntVar(void)
           : pm(0),
+            liveConstraints(0),
             arcsConnectedTo(0),
             constraintNeedsRemovedValues(false),
-            queueItem(0)
+            weightedDegree(0),
+            activityScore(0),
+            activityTime(0),
+            impactScore(0),
+            impactSamples(0),
+            queueItem(0),
+            firstFailLinks(0)
         {
+                liveConstraintsSaveId.id = NsUPLUS_INF;
+                liveConstraintsSaveId.level = 0;
         }
 
+        /// Constructs the variable with the domain [min_init..max_init]
+        ///
+        /// A Ns_BitSet::SPARSE_SET representation suits a medium-size
+        /// domain whose values are removed one by one and iterated often.
+        /// A sparse set of more than 65536 values falls back to
+        /// Ns_BitSet::BIT_SET.
         NsIntVar(NsProblemManager& pm_init, const NsInt min_init,
-                 const NsInt max_init);
+                 const NsInt max_init,
+                 const Ns_BitSet::Representation representation =
+                     Ns_BitSet::BIT_SET);
 
         NsIntVar(const Ns_Expression& expr);
 
@@ -796,6 +1158,40 @@ class NsIntVar {
         bool removeRange(const NsInt first, const NsInt last,
                          const Ns_Constraint* c, bool& modified);
 
+        /// Removes the values that the domain of V does not contain
+        bool intersect(const NsIntVar& V, const Ns_Constraint* c)
+        {
+                bool modifiedFoo;
+                return intersect(V, c, modifiedFoo);
+        }
+
+        bool intersect(const NsIntVar& V, const Ns_Constraint* c,
+                       bool& modified);
+
+        /// Removes the values that are not described by the bits of 'mask'
+        ///
+        /// If the i-th bit of the machine words array 'mask' is
+        /// active, then the value firstVal + i is kept.
+        bool intersect(const NsInt firstVal, const NsDeque<size_t>& mask,
+                       const Ns_Constraint* c)
+        {
+                bool modifiedFoo;
+                return intersect(firstVal, mask, c, modifiedFoo);
+        }
+
+        bool intersect(const NsInt firstVal, const NsDeque<size_t>& mask,
+                       const Ns_Constraint* c, bool& modified);
+
+    private:
+        bool bulkRemoved(const bool kept, const NsInt oldMin,
+                         const NsInt oldMax, const NsUInt oldSize,
+                         const Ns_Constraint* constr, bool& modified);
+
+        void updateFirstFailHeaps(void);
+
+        void shrunk(const NsUInt oldSize);
+
+    public:
         /// @}
 
         /// Assigns a value to the constrained variable
@@ -876,9 +1272,14 @@ class NsIntVar {
                 /// The inconsistencies that constr provoked
                 unsigned long failures;
 
+                /// The events of the variable that constr subscribes to,
+                /// as Ns_Constraint::EventType flags
+                int events;
+
                 /// Constructor
-                ConstraintAndFailure(Ns_Constraint* constr_init)
-                  : constr(constr_init), failures(0)
+                ConstraintAndFailure(Ns_Constraint* constr_init,
+                                     const int events_init)
+                  : constr(constr_init), failures(0), events(events_init)
                 {
                 }
         };
@@ -886,7 +1287,20 @@ class NsIntVar {
         /// An array of the constraints that the variable is involved in
         NsDeque<ConstraintAndFailure> constraints;
 
+        /// The number of the first 'constraints' that are not entailed
+        ///
+        /// The propagation moves an entailed constraint after them,
+        /// in order to iterate only through the live ones. The number
+        /// is restored on backtracking.
+        NsIndex liveConstraints;
+
+        /// Moves the entailed constraint at index after the live ones
+        void dropConstraint(const NsIndex index);
+
     private:
+        /// The search node where 'liveConstraints' has been saved
+        Ns_HistoryId_t liveConstraintsSaveId;
+
         /// The number of other variables connected to this via constraints
         int arcsConnectedTo;
 
@@ -907,6 +1321,61 @@ class NsIntVar {
         /// Adds a constraint to the collection of constraints of the variable
         void addConstraint(Ns_Constraint* c);
 
+        /// The sum of the weights of the live constraints of the
+        /// variable
+        ///
+        /// It is updated by Ns_Constraint::increaseWeight() and
+        /// dropConstraint(), and restored together with
+        /// 'liveConstraints', so that the dom/wdeg heuristic reads it
+        /// in constant time.
+        unsigned long weightedDegree;
+
+        /// @}
+
+        /// @{
+        /// @name Search history for the activity- and impact-based heuristics
+
+    private:
+        /// The activity at the time 'activityTime'
+        double activityScore;
+
+        /// The number of the goals executed until the last update
+        /// of 'activityScore'
+        unsigned long activityTime;
+
+        /// The mean of the impacts of the assignments of the variable
+        double impactScore;
+
+        /// The number of the impacts that 'impactScore' averages
+        unsigned long impactSamples;
+
+    public:
+        /// How often the domain shrank recently
+        ///
+        /// It is increased by one for each goal during which the
+        /// domain shrank, and it decays by the factor of
+        /// NsProblemManager::activityDecay() after each goal.
+        double activity(void) const;
+
+        /// The mean reduction of the search space that the
+        /// assignments of the variable provoked
+        ///
+        /// An impact is 1 - P'/P, where P is the product of the
+        /// domain sizes of the problem before an assignment, and P'
+        /// after its propagation. A failed assignment has impact 1.
+        /// It is 0 if the variable has not been assigned yet.
+        double impact(void) const
+        {
+                return impactScore;
+        }
+
+        /// Adds an impact of an assignment of the variable to its mean
+        void addImpact(const double newImpact)
+        {
+                ++impactSamples;
+                impactScore += (newImpact - impactScore) / impactSamples;
+        }
+
         /// @}
 
         /// Points to the item in the AC queue that refers to the variable
@@ -914,6 +1383,32 @@ class NsIntVar {
         /// If there is no such item, the pointer is null.
         Ns_QueueItem* queueItem;
 
+        /// A node of the list of the Ns_FirstFailHeap's that contain
+        /// the variable
+        struct FirstFailLink {
+
+                /// The heap that should be updated when the domain shrinks
+                Ns_FirstFailHeap* heap;
+
+                /// The index of the variable in the array of the heap
+                NsIndex index;
+
+                /// The next heap that contains the variable
+                FirstFailLink* next;
+
+                /// Constructor
+                FirstFailLink(Ns_FirstFailHeap* heap_init,
+                              const NsIndex index_init,
+                              FirstFailLink* next_init)
+                  : heap(heap_init), index(index_init), next(next_init)
+                {
+                }
+        };
+
+        /// The heaps that order the variable among the unbound ones of
+        /// an array; null if there is none
+        FirstFailLink* firstFailLinks;
+
         void transparent(void);
 };
 
@@ -932,8 +1427,14 @@ class NsIntVarArray {
 
         bool addedConstraint;
 
+        /// Orders the unbound variables by their domain sizes, as soon
+        /// as firstFailIndex() is called
+        ///
+        /// It is a cache, therefore it is modified by const methods.
+        mutable Ns_FirstFailHeap* firstFailHeap;
+
     public:
-        NsIntVarArray(void) : addedConstraint(false)
+        NsIntVarArray(void) : addedConstraint(false), firstFailHeap(0)
         {
         }
 
@@ -1195,6 +1696,114 @@ class NsIntVarArray {
         {
                 return PointArray.empty();
         }
+
+        /// The index of the unbound variable with the smallest domain
+        ///
+        /// Ties are broken in favor of the smallest index. If every
+        /// variable is bound, NsINDEX_INF is returned. The first call
+        /// takes linear time; the next ones take constant time, as the
+        /// variables keep a heap updated while their domains shrink.
+        NsIndex firstFailIndex(void) const;
+
+        /// Collects, in ascending order, the indices of all the
+        /// unbound variables that have the smallest domain size
+        void firstFailIndices(NsDeque<NsIndex>& indices) const;
+
+        /// The index of the unbound variable with the smallest ratio of
+        /// domain size to weighted degree (dom/wdeg heuristic)
+        ///
+        /// The weights of the non-entailed constraints count the
+        /// inconsistencies they provoked. If every variable is bound,
+        /// NsINDEX_INF is returned.
+        NsIndex domWdegIndex(void) const;
+
+        /// The index of the unbound variable with the smallest ratio of
+        /// domain size to the number of its non-entailed constraints
+        /// (dom/deg heuristic)
+        NsIndex domDegIndex(void) const;
+
+        /// The index of the unbound variable with the greatest ratio
+        /// of activity to domain size (activity-based search)
+        ///
+        /// Ties are broken in favor of the smallest domain. The
+        /// first call starts the recording of the search history.
+        NsIndex activityIndex(void) const;
+
+        /// The index of the unbound variable with the smallest
+        /// estimated search space after its assignment
+        /// (impact-based search)
+        ///
+        /// The estimation is the domain size times one minus the
+        /// mean impact of the variable. The first call starts the
+        /// recording of the search history.
+        NsIndex impactIndex(void) const;
+};
+
+/// The unbound variables of an array, in a binary heap ordered by
+/// their domain sizes
+///
+/// A variable updates its position in O(log n) time whenever
+/// its domain shrinks, and it leaves the heap when it is bound.
+/// The modifications of the heap are saved via
+/// NsProblemManager::saveValue(), so backtracking restores them.
+class Ns_FirstFailHeap {
+
+    private:
+        NsProblemManager& pm;
+
+        /// The variables of the array, in its order
+        Ns_PointArray_t vars;
+
+        /// The nodes of the lists that connect the variables to this heap
+        NsDeque<NsIntVar::FirstFailLink> links;
+
+        /// The domain size of each variable, as recorded in the heap
+        NsDeque<size_t> keys;
+
+        /// The indices of the unbound variables in heap order
+        NsDeque<NsInt> heap;
+
+        /// The place of each variable in 'heap', or -1 if it is bound
+        NsDeque<NsInt> position;
+
+        /// The number of the unbound variables in 'heap'
+        NsInt heapSize;
+
+        /// The search node where the heap has been built
+        ///
+        /// When this node is popped, the heap is out of date, and
+        /// it is built again on demand.
+        Ns_HistoryId_t builtId;
+
+        bool precedes(const NsInt i, const NsInt j) const
+        {
+                return (keys[i] < keys[j] || (keys[i] == keys[j] && i < j));
+        }
+
+        void place(const NsInt pos, const NsInt i);
+
+        void siftUp(NsInt pos);
+
+        void siftDown(NsInt pos);
+
+        void build(void);
+
+    public:
+        Ns_FirstFailHeap(const Ns_PointArray_t& vars_init);
+
+        /// True if the heap contains exactly the variables of VarArr
+        bool orders(const NsIntVarArray& VarArr) const
+        {
+                return (VarArr.size() == vars.size() &&
+                        &VarArr[0] == vars.front() &&
+                        &VarArr[vars.size() - 1] == vars.back());
+        }
+
+        void update(const NsIndex i);
+
+        NsIndex top(void);
+
+        void minima(NsDeque<NsIndex>& indices);
 };
 
 std::ostream& operator<<(std::ostream& os, const NsIntVarArray& VarArr);
@@ -1230,12 +1839,44 @@ class Ns_Constraint {
         /// constraint took place
         unsigned long lastConstraintCheckTime;
 
+        /// True if the constraint waits in a queue of the constraint-centric
+        /// propagation engine
+        bool inConstraintQueue;
+
+        /// True if every combination of the current values of the
+        /// variables satisfies the constraint
+        ///
+        /// It is set via NsProblemManager::entail() and it is reset
+        /// on backtracking.
+        bool entailed;
+
+        /// The weight of the constraint for the dom/wdeg heuristic
+        ///
+        /// It starts from 1 and it is increased each time the
+        /// constraint provokes an inconsistency during search. It is
+        /// not restored on backtracking.
+        unsigned long weight;
+
+        /// The variables that the constraint has been added to
+        ///
+        /// A vector is preferred to an NsDeque, because there can
+        /// be millions of (binary) constraints.
+        std::vector<NsIntVar*> scope;
+
         /// Constructor
         Ns_Constraint(void)
-          : lastConstraintCheckTime(0), revisionType(BOUNDS_CONSISTENCY)
+          : lastConstraintCheckTime(0),
+            inConstraintQueue(false),
+            entailed(false),
+            weight(1),
+            revisionType(BOUNDS_CONSISTENCY)
         {
         }
 
+        void increaseWeight(void);
+
+        void recordFailure(void);
+
         /// @{
         /// @name AC algorithm methods
 
@@ -1271,28 +1912,112 @@ class Ns_Constraint {
         /// constraint
         ConsistencyType revisionType;
 
-        /// Writes a constraint-edge representation into a graph file, with a
-        /// format supported by Graphviz
-        virtual void toGraphFile(std::ofstream& fileConstraintsGraph) const
-        {
-                assert_Ns(
-                    fileConstraintsGraph.good(),
-                    "Ns_Constraint::toGraphFile: Problem writing to file");
-                fileConstraintsGraph
-                    << "\n\t"
-                    << "// Unimplemented constraint representation\n";
-        }
+        /// The modifications of a domain (events) that may wake up a
+        /// constraint, combined as bit flags
+        enum EventType {
 
-        /// The destructor of an abstract class should be virtual
-        virtual ~Ns_Constraint(void)
-        {
-        }
-};
+                /// The variable has been bound to a value
+                FIX_EVENT = 1,
 
-class Ns_ConstrXlessthanY : public Ns_Constraint {
+                /// The minimum of the domain has been increased
+                MIN_EVENT = 2,
 
-    private:
-        NsIntVar *VarX, *VarY;
+                /// The maximum of the domain has been decreased
+                MAX_EVENT = 4,
+
+                /// Any of the bounds has been modified
+                BOUNDS_EVENT = MIN_EVENT | MAX_EVENT,
+
+                /// Any value has been removed; only the VALUE_CONSISTENCY
+                /// constraints are informed about the values removed
+                /// inside the bounds
+                DOMAIN_EVENT = BOUNDS_EVENT | 8
+        };
+
+        /// Returns the events of Var that the constraint subscribes to
+        ///
+        /// It is called when the constraint is attached to Var. The
+        /// propagation skips the constraint when none of these events
+        /// has fired. A variable that has been bound has also fired a
+        /// MIN_EVENT or a MAX_EVENT.
+        virtual int subscribedEvents(const NsIntVar& /*Var*/) const
+        {
+                return ((revisionType == VALUE_CONSISTENCY) ? DOMAIN_EVENT
+                                                            : BOUNDS_EVENT);
+        }
+
+        /// The priority classes of the constraint-centric propagation
+        ///
+        /// A constraint is revised only when there are no pending
+        /// constraints of a higher priority class.
+        enum PriorityClass {
+
+                /// A cheap revision, e.g. for two or three variables
+                CHEAP_PRIORITY,
+
+                /// A revision in time linear to the number of the variables
+                LINEAR_PRIORITY,
+
+                /// An expensive revision of a global constraint
+                EXPENSIVE_PRIORITY,
+
+                /// The number of the priority classes
+                N_PRIORITY_CLASSES
+        };
+
+        /// Returns how soon the constraint should be revised, compared
+        /// to other ones, by the constraint-centric propagation
+        virtual PriorityClass priorityClass(void) const
+        {
+                return ((varsInvolvedIn() <= 3) ? CHEAP_PRIORITY
+                                                : LINEAR_PRIORITY);
+        }
+
+        /// True if the constraint keeps an internal state that is
+        /// updated by LocalArcCons() for each modified variable
+        ///
+        /// ArcCons() cannot replace LocalArcCons() for such a
+        /// constraint; therefore the constraint-centric propagation
+        /// still revises it per modified variable, unless it is of
+        /// EXPENSIVE_PRIORITY. Then, the propagation only updates its
+        /// state via updateLocally(), and queues it in order to be
+        /// revised via ArcCons() after the cheaper constraints.
+        virtual bool revisedLocally(void) const
+        {
+                return false;
+        }
+
+        /// Updates the internal state of a constraint that is revised
+        /// locally, for the modification of Qitem, without revising it
+        virtual void updateLocally(Ns_QueueItem& /*Qitem*/)
+        {
+                throw NsException("Ns_Constraint::updateLocally: A "
+                                  "constraint revised locally with "
+                                  "EXPENSIVE_PRIORITY should implement it");
+        }
+
+        /// Writes a constraint-edge representation into a graph file, with a
+        /// format supported by Graphviz
+        virtual void toGraphFile(std::ofstream& fileConstraintsGraph) const
+        {
+                assert_Ns(
+                    fileConstraintsGraph.good(),
+                    "Ns_Constraint::toGraphFile: Problem writing to file");
+                fileConstraintsGraph
+                    << "\n\t"
+                    << "// Unimplemented constraint representation\n";
+        }
+
+        /// The destructor of an abstract class should be virtual
+        virtual ~Ns_Constraint(void)
+        {
+        }
+};
+
+class Ns_ConstrXlessthanY : public Ns_Constraint {
+
+    private:
+        NsIntVar *VarX, *VarY;
 
     public:
         Ns_ConstrXlessthanY(NsIntVar* X, NsIntVar* Y) : VarX(X), VarY(Y)
@@ -1308,6 +2033,14 @@ class Ns_ConstrXlessthanY : public Ns_Constraint {
                 return 2;
         }
 
+        /// Only a greater min of X or a smaller max of Y can be
+        /// propagated; X and Y may be the same variable
+        virtual int subscribedEvents(const NsIntVar& Var) const
+        {
+                return (((&Var == VarX) ? MIN_EVENT : 0) |
+                        ((&Var == VarY) ? MAX_EVENT : 0));
+        }
+
         virtual void toGraphFile(std::ofstream& fileConstraintsGraph) const
         {
                 fileConstraintsGraph << "\n\tVar" << VarX << " -> Var" << VarY
@@ -1337,6 +2070,14 @@ class Ns_ConstrXlesseqthanY : public Ns_Constraint {
                 return 2;
         }
 
+        /// Only a greater min of X or a smaller max of Y can be
+        /// propagated; X and Y may be the same variable
+        virtual int subscribedEvents(const NsIntVar& Var) const
+        {
+                return (((&Var == VarX) ? MIN_EVENT : 0) |
+                        ((&Var == VarY) ? MAX_EVENT : 0));
+        }
+
         virtual void toGraphFile(std::ofstream& fileConstraintsGraph) const
         {
                 fileConstraintsGraph << "\n\tVar" << VarX << " -> Var" << VarY
@@ -2174,6 +2915,36 @@ class Ns_ConstrXeqSum : public Ns_Constraint {
         NsIntVarArray* VarArr;
         NsIndex start, length;
 
+        /// The bounds of each term, as they have been added to the sums
+        ///
+        /// A revision adds only the difference between the current
+        /// bounds of the modified term and these ones to the sums.
+        NsDeque<NsInt> termMin, termMax;
+
+        /// The sum of the minimums and the sum of the maximums of the
+        /// terms, as recorded in 'termMin' and 'termMax'
+        NsInt sumMin, sumMax;
+
+        /// An upper bound for the difference max-min of every term
+        ///
+        /// The terms are scanned only if it exceeds the distance of a
+        /// bound of VarX from the opposite sum.
+        NsInt maxSpan;
+
+        /// The search node where the sums have been saved
+        Ns_HistoryId_t lastSaveId;
+
+        typedef Ns_UNORDERED_MAP<Ns_pointer_t, NsDeque<NsIndex>>
+            VarPointerIndices_t;
+
+        /// The positions into 'termMin' of each variable
+        VarPointerIndices_t VarPointerIndices;
+
+        void initSums(void);
+        void saveSums(void);
+        void updateTerm(const NsIndex i);
+        void prune(bool scanTerms);
+
     public:
         Ns_ConstrXeqSum(NsIntVar* X, NsIntVarArray* VarArr_init);
         Ns_ConstrXeqSum(NsIntVar* X, NsIntVarArray* VarArr_init,
@@ -2190,6 +2961,76 @@ class Ns_ConstrXeqSum : public Ns_Constraint {
                                                VarArr, this, "sum");
         }
 
+        virtual bool revisedLocally(void) const
+        {
+                return true;
+        }
+
+        virtual void ArcCons(void);
+        virtual void LocalArcCons(Ns_QueueItem& Qitem);
+};
+
+/// The constraint VarX = sum of coeffs[i] * VarArr[i]
+///
+/// It keeps the bounds of the weighted terms incrementally, like
+/// Ns_ConstrXeqSum, and avoids an intermediate variable per term.
+class Ns_ConstrXeqLinear : public Ns_Constraint {
+
+    private:
+        NsIntVar* VarX;
+        NsIntVarArray* VarArr;
+
+        /// The variables with a nonzero coefficient
+        NsDeque<NsIntVar*> terms;
+
+        /// The nonzero coefficients of 'terms'
+        NsDeque<NsInt> coeffs;
+
+        /// The bounds of each weighted term coeffs[i] * terms[i], as
+        /// they have been added to the sums
+        NsDeque<NsInt> termMin, termMax;
+
+        /// The sum of the minimums and the sum of the maximums of the
+        /// weighted terms, as recorded in 'termMin' and 'termMax'
+        NsInt sumMin, sumMax;
+
+        /// An upper bound for the difference max-min of every weighted
+        /// term
+        NsInt maxSpan;
+
+        /// The search node where the sums have been saved
+        Ns_HistoryId_t lastSaveId;
+
+        typedef Ns_UNORDERED_MAP<Ns_pointer_t, NsDeque<NsIndex>>
+            VarPointerIndices_t;
+
+        /// The positions into 'terms' of each variable
+        VarPointerIndices_t VarPointerIndices;
+
+        void saveSums(void);
+        void updateTerm(const NsIndex i);
+        void prune(bool scanTerms);
+
+    public:
+        Ns_ConstrXeqLinear(NsIntVar* X, const NsDeque<NsInt>& coeffs_init,
+                           NsIntVarArray* VarArr_init);
+
+        virtual int varsInvolvedIn(void) const
+        {
+                return (1 + terms.size());
+        }
+
+        virtual void toGraphFile(std::ofstream& fileConstraintsGraph) const
+        {
+                Ns_globalConstraintToGraphFile(fileConstraintsGraph, VarX,
+                                               VarArr, this, "linear");
+        }
+
+        virtual bool revisedLocally(void) const
+        {
+                return true;
+        }
+
         virtual void ArcCons(void);
         virtual void LocalArcCons(Ns_QueueItem& Qitem);
 };
@@ -2243,6 +3084,12 @@ class Ns_ConstrXneqY : public Ns_Constraint {
                 return 2;
         }
 
+        /// A value is removed only when the other variable is bound
+        virtual int subscribedEvents(const NsIntVar& /*Var*/) const
+        {
+                return FIX_EVENT;
+        }
+
         virtual void toGraphFile(std::ofstream& fileConstraintsGraph) const
         {
                 fileConstraintsGraph << "\n\tVar" << VarX << " -> Var" << VarY
@@ -2296,6 +3143,11 @@ class Ns_ConstrAllDiff : public Ns_Constraint {
                 return VarArr->size();
         }
 
+        virtual int subscribedEvents(const NsIntVar& /*Var*/) const
+        {
+                return FIX_EVENT;
+        }
+
         virtual void toGraphFile(std::ofstream& fileConstraintsGraph) const
         {
                 Ns_arrayConstraintToGraphFile(fileConstraintsGraph, VarArr,
@@ -2326,7 +3178,7 @@ class Ns_ConstrAllDiffStrong : public Ns_Constraint {
 
                 groupedNsIntVar(NsIntVar& Var_init)
                   : Var(Var_init),
-                    vGroup(Var.manager(), FIRST_GROUP, NsPLUS_INF - 1)
+                    vGroup(Var.manager(), FIRST_GROUP, NsSTAR - 1)
                 {
                 }
 
@@ -2371,154 +3223,608 @@ class Ns_ConstrAllDiffStrong : public Ns_Constraint {
                 return VarArr.size();
         }
 
+        virtual bool revisedLocally(void) const
+        {
+                return true;
+        }
+
         virtual void ArcCons(void);
         virtual void LocalArcCons(Ns_QueueItem& Qitem);
 };
 
-class Ns_ConstrTable : public Ns_Constraint {
+/// AllDifferent with domain consistency
+///
+/// A matching between the variables and the values is kept from the
+/// previous revision. It is repaired only for the variables that lost
+/// their matched values, by augmenting paths. As in Regin's algorithm,
+/// a value is removed if its edge is not in the matching, and if it
+/// does not belong to a strongly connected component or to an
+/// alternating path towards a free value.
+class Ns_ConstrAllDiffDomain : public Ns_Constraint {
 
     private:
-        NsIntVarArray& VarArr;
-        const NsDeque<NsDeque<NsInt>>& table;
-        const bool isSupportsTable;
+        NsIntVarArray* VarArr;
+
+        /// The values of the initial domains
+        NsDeque<NsInt> values;
+
+        /// The index of each value into 'values'
+        Ns_UNORDERED_MAP<NsInt, NsIndex> valueIndices;
+
+        static const NsIndex UNMATCHED = static_cast<NsIndex>(-1);
+
+        /// The index of the value matched to each variable
+        NsDeque<NsIndex> varMatch;
+
+        /// The position of the variable matched to each value
+        NsDeque<NsIndex> valueMatch;
+
+        /// The last search for an augmenting path that visited each
+        /// value
+        NsDeque<unsigned long> valueVisit;
+
+        unsigned long nAugmentations;
+
+        bool augment(const NsIndex x);
+        bool repairMatching(void);
+        bool removeUnmatchableValues(void);
 
     public:
-        Ns_ConstrTable(NsIntVarArray& VarArr_init,
-                       const NsDeque<NsDeque<NsInt>>& table_init,
-                       const bool isSupportsTable_init);
+        Ns_ConstrAllDiffDomain(NsIntVarArray* VarArr_init);
 
         virtual int varsInvolvedIn(void) const
         {
-                return VarArr.size();
+                return VarArr->size();
+        }
+
+        virtual PriorityClass priorityClass(void) const
+        {
+                return EXPENSIVE_PRIORITY;
         }
 
         virtual void toGraphFile(std::ofstream& fileConstraintsGraph) const
         {
-                Ns_arrayConstraintToGraphFile(fileConstraintsGraph, &VarArr,
-                                              this, "table");
+                Ns_arrayConstraintToGraphFile(fileConstraintsGraph, VarArr,
+                                              this, "!=");
         }
 
         virtual void ArcCons(void);
-        virtual void ArcConsSupports(void);
-        virtual void ArcConsConflicts(void);
         virtual void LocalArcCons(Ns_QueueItem& Qitem);
 };
 
-class Ns_ConstrElement : public Ns_Constraint {
+/// The valid tuples of a table constraint, as a reversible sparse bit-set
+///
+/// The i-th bit is active if the i-th tuple is valid. The indices of
+/// the nonzero machine words are kept in the first 'limit' elements
+/// of 'index', in order to skip the zero words. The modified words and
+/// 'limit' are restored on backtracking.
+class Ns_TupleSet {
 
     private:
-        NsIntVar* VarIndex;
-        const NsDeque<NsInt>& intArray;
-        NsIntVar* VarValue;
+        NsDeque<size_t> words;
+
+        NsDeque<NsUInt> index;
+
+        /// The number of the nonzero words
+        NsInt limit;
+
+        /// The search node where 'limit' has been saved
+        Ns_HistoryId_t limitSaveId;
+
+        void saveLimit(NsProblemManager& pm);
+        void replaceWord(NsProblemManager& pm, const NsInt i,
+                         const size_t remaining);
 
     public:
-        Ns_ConstrElement(NsIntVar* VarIndex_init,
-                         const NsDeque<NsInt>& intArray_init,
-                         NsIntVar* VarValue_init)
-          : VarIndex(VarIndex_init),
-            intArray(intArray_init),
-            VarValue(VarValue_init)
-        {
-                revisionType = VALUE_CONSISTENCY;
-                assert_Ns(&VarIndex->manager() == &VarValue->manager(),
-                          "Ns_ConstrElement::Ns_ConstrElement: All the "
-                          "variables of a constraint must belong to the same "
-                          "NsProblemManager");
-                assert_Ns(
-                    !intArray.empty(),
-                    "Ns_ConstrElement::Ns_ConstrElement: Empty element array");
-        }
+        /// The number of the bits that a machine word can hold
+        static const NsUInt MW_BITS = CHAR_BIT * sizeof(size_t);
 
-        virtual int varsInvolvedIn(void) const
-        {
-                return 2;
-        }
+        /// Constructs the set of the tuples i with valid[i] == true
+        void init(const NsDeque<bool>& valid);
 
-        virtual void toGraphFile(std::ofstream& fileConstraintsGraph) const
+        bool empty(void) const
         {
-                fileConstraintsGraph << "\n\tVar" << VarValue << " -> Var"
-                                     << VarIndex << " [label=\"element\"];\n";
+                return (limit == 0);
         }
 
-        virtual void ArcCons(void);
-        virtual void LocalArcCons(Ns_QueueItem& Qitem);
+        /// Removes the tuples of the mask, which consists of the
+        /// machine words masks[offset], masks[offset+1], ...
+        ///
+        /// Returns true if the set has been modified. If 'removed' is
+        /// given, the removed tuples are appended to it.
+        bool removeMask(NsProblemManager& pm, const NsDeque<size_t>& masks,
+                        const NsUInt offset, NsDeque<NsUInt>* removed = 0);
+
+        /// Keeps only the tuples of the mask, which has a machine
+        /// word for each word of the set
+        ///
+        /// Returns true if the set has been modified.
+        bool intersectWith(NsProblemManager& pm, const NsDeque<size_t>& mask);
+
+        /// True if the set has a common tuple with the mask
+        ///
+        /// The search starts from the word 'residue', which is
+        /// updated with the word where the common tuple has been found.
+        bool intersects(const NsDeque<size_t>& masks, const NsUInt offset,
+                        NsUInt& residue) const;
+
+        /// Appends to 'tuples' all the tuples of the set
+        void elements(NsDeque<NsUInt>& tuples) const;
+
+        /// Appends to 'tuples' the tuples that the set has in common
+        /// with the mask
+        void commonTuples(const NsDeque<size_t>& masks, const NsUInt offset,
+                          NsDeque<NsUInt>& tuples) const;
 };
 
-class Ns_ConstrVarArrElement : public Ns_Constraint {
+class Ns_TableIndex;
+
+/// An immutable table of tuples, stored row-major into contiguous
+/// memory
+///
+/// Each cell is a sorted set of values. A plain table has exactly one
+/// value per cell, and a star cell is the set {NsSTAR}. The stores
+/// are interned by NsProblemManager, so that the table constraints
+/// with the same tuples share one store and its indexes.
+class Ns_TupleStore {
 
     private:
-        NsIntVarArray& VarArr;
-        NsIntVar& VarIndex;
-        NsIntVar& VarValue;
+        NsIndex arity;
+
+        NsIndex nTuples;
+
+        /// The values of all the cells, one cell after the other
+        std::vector<NsInt> values;
+
+        /// The beginning of each cell into 'values', plus the end of
+        /// the last cell; it is empty for a plain table
+        std::vector<NsUInt> cellStarts;
+
+        /// True if each cell is a single value other than NsSTAR
+        bool plain;
+
+        size_t hashValue;
+
+        /// The indexes for each pattern of repeated variables
+        NsDeque<Ns_TableIndex*> indexes;
+
+        void computeHash(void);
 
     public:
-        Ns_ConstrVarArrElement(NsIntVarArray& VarArr_init,
-                               NsIntVar& VarIndex_init, NsIntVar& VarValue_init)
-          : VarArr(VarArr_init),
-            VarIndex(VarIndex_init),
-            VarValue(VarValue_init)
+        Ns_TupleStore(const NsDeque<NsDeque<NsInt>>& table,
+                      const NsIndex arity_init);
+
+        Ns_TupleStore(const NsDeque<NsDeque<NsDeque<NsInt>>>& table,
+                      const NsIndex arity_init);
+
+        ~Ns_TupleStore(void);
+
+        NsIndex size(void) const
         {
-                revisionType = BIDIRECTIONAL_CONSISTENCY;
-                assert_Ns(&VarIndex.manager() == &VarValue.manager(),
-                          "Ns_ConstrVarArrElement::Ns_ConstrVarArrElement: All "
-                          "the variables of a constraint must belong to the "
-                          "same NsProblemManager");
-                for (NsIntVarArray::iterator V = VarArr.begin();
-                     V != VarArr.end(); ++V) {
-                        assert_Ns(&VarIndex.manager() == &V->manager(),
-                                  "Ns_ConstrVarArrElement::Ns_"
-                                  "ConstrVarArrElement: All the variables of a "
-                                  "constraint must belong to the same "
-                                  "NsProblemManager");
-                }
-                assert_Ns(!VarArr.empty(),
-                          "Ns_ConstrVarArrElement::Ns_ConstrVarArrElement: "
-                          "Empty element array");
+                return nTuples;
         }
 
-        virtual int varsInvolvedIn(void) const
+        size_t hash(void) const
         {
-                return (VarArr.size() + 2);
+                return hashValue;
         }
 
-        virtual void toGraphFile(std::ofstream& fileConstraintsGraph) const
+        bool operator==(const Ns_TupleStore& other) const
         {
-                Ns_elementConstraintToGraphFile(fileConstraintsGraph, VarIndex,
-                                                VarValue, VarArr, this);
+                return (arity == other.arity && nTuples == other.nTuples &&
+                        values == other.values &&
+                        cellStarts == other.cellStarts);
         }
 
-        virtual void ArcCons(void);
-        virtual void LocalArcCons(Ns_QueueItem& Qitem);
-};
+        bool isPlain(void) const
+        {
+                return plain;
+        }
 
-class Ns_ExprYplusC : public Ns_Expression {
+        const NsInt* cellBegin(const NsIndex t, const NsIndex i) const
+        {
+                return values.data() +
+                       (cellStarts.empty() ? t * arity + i
+                                           : cellStarts[t * arity + i]);
+        }
 
-    private:
-        NsIntVar& VarY;
-        NsInt C;
+        const NsInt* cellEnd(const NsIndex t, const NsIndex i) const
+        {
+                return values.data() + (cellStarts.empty()
+                                            ? t * arity + i + 1
+                                            : cellStarts[t * arity + i + 1]);
+        }
 
-    public:
-        Ns_ExprYplusC(NsIntVar& Y, const NsInt C_init) : VarY(Y), C(C_init)
+        bool cellIsStar(const NsIndex t, const NsIndex i) const
         {
+                return (cellBegin(t, i) != cellEnd(t, i) &&
+                        *cellBegin(t, i) == NsSTAR);
         }
 
-        virtual void post(NsIntVar& VarX) const;
-        virtual NsIntVar& post(void) const;
+        bool cellContains(const NsIndex t, const NsIndex i,
+                          const NsInt val) const
+        {
+                return (cellIsStar(t, i) ||
+                        std::binary_search(cellBegin(t, i), cellEnd(t, i),
+                                           val));
+        }
+
+        /// The index of the table for the variables' repetitions,
+        /// where firstPositions[i] is the first position of the
+        /// variable of the i-th position
+        const Ns_TableIndex& index(const NsDeque<NsIndex>& firstPositions);
 };
 
-inline Ns_ExprYplusC operator+(NsIntVar& Y, const NsInt C)
-{
-        return Ns_ExprYplusC(Y, C);
-}
+/// The bit-masks of the tuples of an Ns_TupleStore that match each
+/// value of each position
+///
+/// The index does not depend on the domains, so that it is shared by
+/// all the table constraints with the same tuples and the same
+/// repeated variables. The cells of a repeated variable are replaced
+/// by their intersection.
+class Ns_TableIndex {
 
-inline Ns_ExprYplusC operator+(const Ns_Expression& Yexpr, const NsInt C)
-{
-        return (Yexpr.post() + C);
-}
+    public:
+        const NsDeque<NsIndex> firstPositions;
 
-inline Ns_ExprYplusC operator+(const NsInt C, const Ns_Expression& Yexpr)
-{
-        return (Yexpr.post() + C);
+        /// The number of the machine words of a mask
+        NsUInt nWords;
+
+        NsUInt nMasks;
+
+        /// The masks of the tuples matching each value; the words of
+        /// the r-th mask begin at r*nWords
+        NsDeque<size_t> tupleMasks;
+
+        /// For each position, the number of the mask of each value;
+        /// the mask of NsSTAR has the tuples that match any value
+        NsDeque<Ns_UNORDERED_MAP<NsInt, NsUInt>> masksOfValues;
+
+        /// False for the tuples whose cells for a repeated variable
+        /// have no common value, or which repeat a previous tuple of
+        /// a plain table
+        NsDeque<bool> consistent;
+
+        /// True for each position where a cell matches more than one
+        /// value
+        ///
+        /// The removal of a value does not invalidate the tuples of
+        /// such a position, which are intersected instead with the
+        /// masks of the remaining values.
+        NsDeque<bool> multiValueCells;
+
+        /// The number of the mask for each cell of a plain table; the
+        /// numbers of the t-th tuple begin at t*firstPositions.size()
+        NsDeque<NsUInt> masksOfTuples;
+
+        Ns_TableIndex(const Ns_TupleStore& store,
+                      const NsDeque<NsIndex>& firstPositions_init);
+
+    private:
+        void addToMask(const NsIndex t, const NsIndex i, const NsInt val,
+                       const bool isPlain);
+};
+
+/// Table constraint
+///
+/// A supports table is filtered with the Compact-Table algorithm.
+/// The tuples that contain each value of each variable are kept as a
+/// bit-mask, into an Ns_TableIndex. The masks of the removed values
+/// are removed from the valid tuples, and then the values without a
+/// valid tuple are removed.
+///
+/// A conflicts table keeps the valid tuples in the same way, plus the
+/// number of the valid conflicts of each value. A value is removed
+/// when its conflicts are as many as the combinations of the values
+/// of the other variables. As the count may include conflicts with
+/// values whose removal is still in the queue, the conflicts inside
+/// the current domains are then counted one by one.
+///
+/// The tuples may contain NsSTAR cells, or, in a compressed table,
+/// sets of values. A tuple of them is set in the mask of each value
+/// that its cell matches, so that the table is filtered without
+/// being expanded. The conflicts of such a table cannot be counted
+/// per value, as a tuple stands for many combinations; they prune
+/// the last unbound variable instead.
+class Ns_ConstrTable : public Ns_Constraint {
+
+    private:
+        NsIntVarArray& VarArr;
+
+        const Ns_TupleStore* store;
+
+        const Ns_TableIndex* index;
+
+        const bool isSupportsTable;
+
+        /// The tuples that contain only values of the domains
+        Ns_TupleSet validTuples;
+
+        /// The word where a support has been last found, for each mask
+        NsDeque<NsUInt> residues;
+
+        typedef Ns_UNORDERED_MAP<Ns_pointer_t, NsDeque<NsIndex>>
+            VarPointerIndices_t;
+
+        /// The positions of each variable into VarArr
+        VarPointerIndices_t VarPointerIndices;
+
+        /// True if 'validTuples' have been modified since the last
+        /// removal of unsupported values
+        bool validTuplesModified;
+
+        /// The number of the valid tuples of a conflicts table
+        NsInt nValidTuples;
+
+        /// The number of the valid conflicts for the value of each mask
+        NsDeque<NsInt> conflicts;
+
+        /// The variables of VarArr, without repetitions
+        NsDeque<NsIntVar*> distinctVars;
+
+        bool hasAllowedValue(const NsIndex t, NsIntVar& Var) const;
+        void allowedValues(const NsIndex t, NsIntVar& Var,
+                           NsDeque<NsInt>& values) const;
+
+        /// The conflicts are counted per value only for a plain table
+        bool countsConflicts(void) const
+        {
+                return (!isSupportsTable && store->isPlain());
+        }
+
+        void init(Ns_TupleStore* newStore);
+        void removeValue(const NsIntVar* Var, const NsInt val);
+        void keepDomainTuples(const NsIntVar* Var);
+        bool supported(const NsIndex i, const NsInt val);
+
+        NsInt conflictsInDomains(const NsUInt mask) const;
+        void ArcConsLastUnbound(void);
+
+    public:
+        Ns_ConstrTable(NsIntVarArray& VarArr_init,
+                       const NsDeque<NsDeque<NsInt>>& table,
+                       const bool isSupportsTable_init);
+
+        Ns_ConstrTable(NsIntVarArray& VarArr_init,
+                       const NsDeque<NsDeque<NsDeque<NsInt>>>& table,
+                       const bool isSupportsTable_init);
+
+        virtual int varsInvolvedIn(void) const
+        {
+                return VarArr.size();
+        }
+
+        virtual PriorityClass priorityClass(void) const
+        {
+                return EXPENSIVE_PRIORITY;
+        }
+
+        /// The valid tuples are updated for each removed value
+        virtual bool revisedLocally(void) const
+        {
+                return true;
+        }
+
+        virtual void updateLocally(Ns_QueueItem& Qitem);
+
+        virtual void toGraphFile(std::ofstream& fileConstraintsGraph) const
+        {
+                Ns_arrayConstraintToGraphFile(fileConstraintsGraph, &VarArr,
+                                              this, "table");
+        }
+
+        virtual void ArcCons(void);
+        virtual void ArcConsSupports(void);
+        virtual void ArcConsConflicts(void);
+        virtual void LocalArcCons(Ns_QueueItem& Qitem);
+};
+
+class Ns_ConstrElement : public Ns_Constraint {
+
+    private:
+        NsIntVar* VarIndex;
+        const NsDeque<NsInt>& intArray;
+        NsIntVar* VarValue;
+
+    public:
+        Ns_ConstrElement(NsIntVar* VarIndex_init,
+                         const NsDeque<NsInt>& intArray_init,
+                         NsIntVar* VarValue_init)
+          : VarIndex(VarIndex_init),
+            intArray(intArray_init),
+            VarValue(VarValue_init)
+        {
+                revisionType = VALUE_CONSISTENCY;
+                assert_Ns(&VarIndex->manager() == &VarValue->manager(),
+                          "Ns_ConstrElement::Ns_ConstrElement: All the "
+                          "variables of a constraint must belong to the same "
+                          "NsProblemManager");
+                assert_Ns(
+                    !intArray.empty(),
+                    "Ns_ConstrElement::Ns_ConstrElement: Empty element array");
+        }
+
+        virtual int varsInvolvedIn(void) const
+        {
+                return 2;
+        }
+
+        virtual void toGraphFile(std::ofstream& fileConstraintsGraph) const
+        {
+                fileConstraintsGraph << "\n\tVar" << VarValue << " -> Var"
+                                     << VarIndex << " [label=\"element\"];\n";
+        }
+
+        virtual void ArcCons(void);
+        virtual void LocalArcCons(Ns_QueueItem& Qitem);
+};
+
+class Ns_ConstrVarArrElement : public Ns_Constraint {
+
+    private:
+        NsIntVarArray& VarArr;
+        NsIntVar& VarIndex;
+        NsIntVar& VarValue;
+
+    public:
+        Ns_ConstrVarArrElement(NsIntVarArray& VarArr_init,
+                               NsIntVar& VarIndex_init, NsIntVar& VarValue_init)
+          : VarArr(VarArr_init),
+            VarIndex(VarIndex_init),
+            VarValue(VarValue_init)
+        {
+                revisionType = BIDIRECTIONAL_CONSISTENCY;
+                assert_Ns(&VarIndex.manager() == &VarValue.manager(),
+                          "Ns_ConstrVarArrElement::Ns_ConstrVarArrElement: All "
+                          "the variables of a constraint must belong to the "
+                          "same NsProblemManager");
+                for (NsIntVarArray::iterator V = VarArr.begin();
+                     V != VarArr.end(); ++V) {
+                        assert_Ns(&VarIndex.manager() == &V->manager(),
+                                  "Ns_ConstrVarArrElement::Ns_"
+                                  "ConstrVarArrElement: All the variables of a "
+                                  "constraint must belong to the same "
+                                  "NsProblemManager");
+                }
+                assert_Ns(!VarArr.empty(),
+                          "Ns_ConstrVarArrElement::Ns_ConstrVarArrElement: "
+                          "Empty element array");
+        }
+
+        virtual int varsInvolvedIn(void) const
+        {
+                return (VarArr.size() + 2);
+        }
+
+        virtual void toGraphFile(std::ofstream& fileConstraintsGraph) const
+        {
+                Ns_elementConstraintToGraphFile(fileConstraintsGraph, VarIndex,
+                                                VarValue, VarArr, this);
+        }
+
+        virtual void ArcCons(void);
+        virtual void LocalArcCons(Ns_QueueItem& Qitem);
+};
+
+/// The nogoods recorded on the restarts of the search
+///
+/// Each nogood is a set of assignments Var = value that cannot
+/// hold at the same time. Two assignments of each nogood that
+/// do not hold are watched; when a watched one holds, another
+/// one is watched instead. If every other assignment holds, the
+/// value of the last one is removed. The watches need not be
+/// restored on backtracking, as an assignment that does not
+/// hold keeps not holding.
+class Ns_ConstrNogoods : public Ns_Constraint {
+
+    public:
+        /// The assignment of value to var
+        struct Literal {
+
+                NsIntVar* var;
+
+                NsInt value;
+
+                Literal(NsIntVar* var_init, const NsInt value_init)
+                  : var(var_init), value(value_init)
+                {
+                }
+
+                bool holds(void) const
+                {
+                        return (var->isBound() && var->value() == value);
+                }
+        };
+
+    private:
+        /// The literals of all the nogoods, one nogood after the other
+        ///
+        /// The first two literals of a nogood are the watched ones.
+        NsDeque<Literal> literals;
+
+        /// The position of the first literal of each nogood in
+        /// 'literals', plus the size of 'literals' at the end
+        NsDeque<NsIndex> starts;
+
+        /// The number of the nogoods that have been watched
+        NsIndex nWatched;
+
+        typedef Ns_UNORDERED_MAP<Ns_pointer_t, NsDeque<NsIndex>>
+            VarPointerIndices_t;
+
+        /// The nogoods that watch a literal of each variable
+        VarPointerIndices_t watches;
+
+        void watch(const NsIndex nogood);
+
+    public:
+        Ns_ConstrNogoods(void) : nWatched(0)
+        {
+                starts.push_back(0);
+        }
+
+        void add(const NsDeque<Literal>& nogood);
+
+        /// The number of the nogoods
+        NsIndex size(void) const
+        {
+                return (starts.size() - 1);
+        }
+
+        virtual int varsInvolvedIn(void) const
+        {
+                return scope.size();
+        }
+
+        /// A literal holds only when its variable is bound
+        virtual int subscribedEvents(const NsIntVar& /*Var*/) const
+        {
+                return FIX_EVENT;
+        }
+
+        virtual PriorityClass priorityClass(void) const
+        {
+                return CHEAP_PRIORITY;
+        }
+
+        /// Only the watches of the modified variable are checked
+        virtual bool revisedLocally(void) const
+        {
+                return true;
+        }
+
+        virtual void ArcCons(void);
+        virtual void LocalArcCons(Ns_QueueItem& Qitem);
+};
+
+class Ns_ExprYplusC : public Ns_Expression {
+
+    private:
+        NsIntVar& VarY;
+        NsInt C;
+
+    public:
+        Ns_ExprYplusC(NsIntVar& Y, const NsInt C_init) : VarY(Y), C(C_init)
+        {
+        }
+
+        virtual void post(NsIntVar& VarX) const;
+        virtual NsIntVar& post(void) const;
+};
+
+inline Ns_ExprYplusC operator+(NsIntVar& Y, const NsInt C)
+{
+        return Ns_ExprYplusC(Y, C);
+}
+
+inline Ns_ExprYplusC operator+(const Ns_Expression& Yexpr, const NsInt C)
+{
+        return (Yexpr.post() + C);
+}
+
+inline Ns_ExprYplusC operator+(const NsInt C, const Ns_Expression& Yexpr)
+{
+        return (Yexpr.post() + C);
 }
 
 inline Ns_ExprYplusC operator+(const NsInt C, NsIntVar& Y)
@@ -2981,6 +4287,32 @@ inline Ns_ExprSum NsSum(NsIntVarArray& Arr, const NsIndex start,
         return Ns_ExprSum(Arr, start, length);
 }
 
+class Ns_ExprLinear : public Ns_Expression {
+
+    private:
+        const NsDeque<NsInt>& coeffs;
+        NsIntVarArray& VarArr;
+
+    public:
+        Ns_ExprLinear(const NsDeque<NsInt>& coeffs_init,
+                      NsIntVarArray& VarArr_init)
+          : coeffs(coeffs_init), VarArr(VarArr_init)
+        {
+                assert_Ns(coeffs.size() == VarArr.size(),
+                          "Ns_ExprLinear::Ns_ExprLinear: 'coeffs' and "
+                          "'VarArr' should have the same size");
+        }
+
+        virtual void post(NsIntVar& VarX) const;
+        virtual NsIntVar& post(void) const;
+};
+
+/// The weighted sum of coeffs[0] * Arr[0] + ... + coeffs[n-1] * Arr[n-1]
+inline Ns_ExprLinear NsLinear(const NsDeque<NsInt>& coeffs, NsIntVarArray& Arr)
+{
+        return Ns_ExprLinear(coeffs, Arr);
+}
+
 /// An abstract expression having to do with arrays of constrained variables
 class Ns_ExpressionArray {
 
@@ -3222,10 +4554,15 @@ class Ns_ExprConstrAllDiff : public Ns_ExprConstr {
     private:
         NsIntVarArray& VarArr;
         const unsigned long Capacity;
+        const bool domainConsistency;
 
     public:
-        Ns_ExprConstrAllDiff(NsIntVarArray& Arr, const unsigned long Cap)
-          : Ns_ExprConstr(true), VarArr(Arr), Capacity(Cap)
+        Ns_ExprConstrAllDiff(NsIntVarArray& Arr, const unsigned long Cap,
+                             const bool domainConsistency_init = false)
+          : Ns_ExprConstr(true),
+            VarArr(Arr),
+            Capacity(Cap),
+            domainConsistency(domainConsistency_init)
         {
         }
 
@@ -3247,7 +4584,8 @@ class Ns_ExprConstrTable : public Ns_ExprConstr {
 
     private:
         NsIntVarArray& VarArr;
-        const NsDeque<NsDeque<NsInt>>& table;
+        const NsDeque<NsDeque<NsInt>>* table;
+        const NsDeque<NsDeque<NsDeque<NsInt>>>* compressedTable;
         const bool isSupportsTable;
 
     public:
@@ -3256,7 +4594,19 @@ class Ns_ExprConstrTable : public Ns_ExprConstr {
                            const bool isSupportsTable_init)
           : Ns_ExprConstr(true),
             VarArr(Arr),
-            table(table_init),
+            table(&table_init),
+            compressedTable(0),
+            isSupportsTable(isSupportsTable_init)
+        {
+        }
+
+        Ns_ExprConstrTable(NsIntVarArray& Arr,
+                           const NsDeque<NsDeque<NsDeque<NsInt>>>& table_init,
+                           const bool isSupportsTable_init)
+          : Ns_ExprConstr(true),
+            VarArr(Arr),
+            table(0),
+            compressedTable(&table_init),
             isSupportsTable(isSupportsTable_init)
         {
         }
@@ -3560,6 +4910,27 @@ inline Ns_ExprConstrAllDiff NsAllDiff(NsIntVarArray& Arr,
         return Ns_ExprConstrAllDiff(Arr, Capacity);
 }
 
+/// The consistency levels of NsAllDiff
+enum NsAllDiffConsistency {
+
+        /// The value of a bound variable is removed from the others
+        NsALLDIFF_VALUES,
+
+        /// Bounds consistency, as with Capacity 1
+        NsALLDIFF_BOUNDS,
+
+        /// Domain consistency, via a bipartite matching
+        NsALLDIFF_DOMAINS
+};
+
+inline Ns_ExprConstrAllDiff NsAllDiff(NsIntVarArray& Arr,
+                                      const NsAllDiffConsistency consistency)
+{
+        return Ns_ExprConstrAllDiff(Arr, (consistency == NsALLDIFF_VALUES) ? 0
+                                                                           : 1,
+                                    consistency == NsALLDIFF_DOMAINS);
+}
+
 inline Ns_ExprConstrTable NsSupports(NsIntVarArray& Arr,
                                      const NsDeque<NsDeque<NsInt>>& table)
 {
@@ -3572,6 +4943,18 @@ inline Ns_ExprConstrTable NsConflicts(NsIntVarArray& Arr,
         return Ns_ExprConstrTable(Arr, table, false);
 }
 
+inline Ns_ExprConstrTable
+NsSupports(NsIntVarArray& Arr, const NsDeque<NsDeque<NsDeque<NsInt>>>& table)
+{
+        return Ns_ExprConstrTable(Arr, table, true);
+}
+
+inline Ns_ExprConstrTable
+NsConflicts(NsIntVarArray& Arr, const NsDeque<NsDeque<NsDeque<NsInt>>>& table)
+{
+        return Ns_ExprConstrTable(Arr, table, false);
+}
+
 inline Ns_ExprConstrYorZ NsIfThen(const Ns_ExprConstr& Yexpr,
                                   const Ns_ExprConstr& Zexpr)
 {
@@ -3739,11 +5122,7 @@ class NsgSetValue : public NsGoal {
         {
         }
 
-        NsGoal* GOAL(void)
-        {
-                Var.set(value);
-                return 0;
-        }
+        NsGoal* GOAL(void);
 };
 
 /// A goal that removes a value from the domain of a given constrained variable
@@ -3759,11 +5138,7 @@ class NsgRemoveValue : public NsGoal {
         {
         }
 
-        NsGoal* GOAL(void)
-        {
-                Var.remove(value);
-                return 0;
-        }
+        NsGoal* GOAL(void);
 };
 
 /// A goal that tries to instantiate a constrained variable
@@ -3796,28 +5171,63 @@ class NsgInDomain : public NsGoal {
 /// The generalization of NsgInDomain that applies to arrays
 ///
 /// It uses NsgInDomain to iteratively instantiate each variable
-/// of the array. The next variable that is chosen is the one
-/// having the minimum domain size (according to the
+/// of the array. By default, the next variable that is chosen is
+/// the one having the minimum domain size (according to the
 /// 'first-fail' heuristic).
 class NsgLabeling : public NsGoal {
 
+    public:
+        /// The heuristics that choose the next variable
+        enum VarOrder {
+
+                /// The smallest domain first
+                FIRST_FAIL,
+
+                /// The smallest domain size per weighted degree; the
+                /// constraints that provoke failures weigh more
+                DOM_WDEG,
+
+                /// The smallest domain size per number of live constraints
+                DOM_DEG,
+
+                /// The most active variable per domain size
+                ACTIVITY,
+
+                /// The smallest search space estimated from the impacts
+                IMPACT
+        };
+
     private:
         NsIntVarArray& VarArr;
 
+        VarOrder order;
+
     public:
-        NsgLabeling(NsIntVarArray& VarArr_init) : VarArr(VarArr_init)
+        NsgLabeling(NsIntVarArray& VarArr_init,
+                    const VarOrder order_init = FIRST_FAIL)
+          : VarArr(VarArr_init), order(order_init)
         {
         }
 
         NsGoal* GOAL(void)
         {
-                NsIndex index = NsINDEX_INF;
-                NsUInt minDom = NsUPLUS_INF;
-                for (NsIndex i = 0; i < VarArr.size(); ++i) {
-                        if (!VarArr[i].isBound() && VarArr[i].size() < minDom) {
-                                minDom = VarArr[i].size();
-                                index = i;
-                        }
+                NsIndex index;
+                switch (order) {
+                case DOM_WDEG:
+                        index = VarArr.domWdegIndex();
+                        break;
+                case DOM_DEG:
+                        index = VarArr.domDegIndex();
+                        break;
+                case ACTIVITY:
+                        index = VarArr.activityIndex();
+                        break;
+                case IMPACT:
+                        index = VarArr.impactIndex();
+                        break;
+                default:
+                        index = VarArr.firstFailIndex();
+                        break;
                 }
                 if (index == NsINDEX_INF)
                         return 0;
@@ -3878,18 +5288,23 @@ class Ns_QueueItem {
                 /// The domain removal serial number
                 unsigned long removalTime;
 
+                /// The MIN_EVENT and MAX_EVENT flags of the modifications
+                int events;
+
                 /// Constructor
-                RemovedBoundRecord_t(void) : removedBound(false)
+                RemovedBoundRecord_t(void) : removedBound(false), events(0)
                 {
                 }
 
                 /// Records a bounds modification
                 void boundChangedBy(const Ns_Constraint* constrFired_init,
-                                    const unsigned long removalTime_init)
+                                    const unsigned long removalTime_init,
+                                    const int events_init)
                 {
                         constrFired = constrFired_init;
                         removedBound = true;
                         removalTime = removalTime_init;
+                        events |= events_init;
                 }
         };
 
@@ -3899,6 +5314,14 @@ class Ns_QueueItem {
         /// An array that records the values removed from the domain of varFired
         NsDeque<RemovedValueRecord_t> removedValues;
 
+        /// True if any of the subscribed events has fired
+        bool fired(const int subscribedEvents) const
+        {
+                return ((removedBoundRec.events & subscribedEvents) != 0 ||
+                        ((subscribedEvents & Ns_Constraint::FIX_EVENT) != 0 &&
+                         varFired->isBound()));
+        }
+
     public:
         /// Constructor
         Ns_QueueItem(NsIntVar* varFired_init)
@@ -3915,23 +5338,59 @@ class Ns_QueueItem {
                 // the first being examined now by the AC algorithm.
         }
 
-        void boundChangedBy(const Ns_Constraint* constr);
+        void boundChangedBy(const Ns_Constraint* constr, const int events);
 
         void add(const NsInt removedVal,
                  const Ns_Constraint* constrThatRemovedIt);
 
         Ns_Constraint* getNextConstraint(void);
 
-        /// Returns the variable that fired the constraint propagation
-        NsIntVar* getVarFired(void) const
+        /// Returns the variable that fired the constraint propagation
+        NsIntVar* getVarFired(void) const
+        {
+                return varFired;
+        }
+
+        /// Returns the value that has been removed from the variable
+        NsInt getW(void) const
+        {
+                return removedValues[currentRemovedValue - 1].value;
+        }
+
+        /// True if getW() is the last removed value that constr is
+        /// going to be revised for, via this queue item
+        ///
+        /// The values that constr itself has removed are skipped.
+        bool lastRemovedValueFor(const Ns_Constraint* constr) const
+        {
+                for (NsDeque<RemovedValueRecord_t>::size_type i =
+                         currentRemovedValue;
+                     i < removedValues.size(); ++i) {
+                        if (removedValues[i].constrFired != constr)
+                                return false;
+                }
+                return true;
+        }
+
+        /// The index in 'varFired->constraints' of constr, which is
+        /// being revised via this queue item
+        NsIndex revisedConstraint(const Ns_Constraint* constr) const
         {
-                return varFired;
+                // The following statement 'corrects' currentConstr,
+                // which has been increased, unless the revision needs
+                // the removed values.
+                return ((constr->revisionType ==
+                         Ns_Constraint::VALUE_CONSISTENCY)
+                            ? currentConstr
+                            : currentConstr - 1);
         }
 
-        /// Returns the value that has been removed from the variable
-        NsInt getW(void) const
+        /// Records that constr provoked an inconsistency, when it was
+        /// revised for varFired
+        void failedBy(Ns_Constraint* constr) const
         {
-                return removedValues[currentRemovedValue - 1].value;
+                ++varFired->constraints[revisedConstraint(constr)].failures;
+                constr->increaseWeight();
         }
 
         /// When a constraint provokes an inconsistency, then its rank (index in
@@ -3940,12 +5399,7 @@ class Ns_QueueItem {
         /// heuristic)
         void resortConstraints(const Ns_Constraint* constr) const
         {
-                // The following statement 'corrects' currentConstr
-                // by assigning the proper value to constrFailed.
-                long constrFailed =
-                    (constr->revisionType == Ns_Constraint::VALUE_CONSISTENCY)
-                        ? currentConstr
-                        : currentConstr - 1;
+                long constrFailed = revisedConstraint(constr);
                 ++varFired->constraints[constrFailed].failures;
                 for (long c = constrFailed - 1; c >= 0; --c) {
                         if (varFired->constraints[c].failures <
@@ -4351,12 +5805,53 @@ struct Ns_SearchNode {
         /// All the goals of this list should be satisfied
         Ns_StackGoals stackAND;
 
+        /// A decision of the search path, for the nogoods extraction
+        struct Decision {
+
+                /// The variable assigned, or null for a modification
+                /// that is not an assignment
+                NsIntVar* var;
+
+                NsInt value;
+
+                /// True if the search below the node has refuted
+                /// the assignment, instead of imposing it
+                bool refuted;
+
+                Decision(NsIntVar* var_init, const NsInt value_init,
+                         const bool refuted_init)
+                  : var(var_init), value(value_init), refuted(refuted_init)
+                {
+                }
+        };
+
+        /// The decisions taken in the node, in chronological order
+        ///
+        /// They are recorded only when restarts are enabled.
+        std::vector<Decision> decisions;
+
+        /// False if a goal below the node failed by itself, so
+        /// that the search has not refuted the node
+        bool refutable;
+
+        /// The assignment that the node has been created for
+        ///
+        /// Its variable is null if the first decision of the node
+        /// is not an assignment.
+        Decision firstAssignment(void) const
+        {
+                if (decisions.empty() || decisions.front().refuted)
+                        return Decision(0, 0, false);
+                return decisions.front();
+        }
+
         /// Constructor
         Ns_SearchNode(NsGoal* goalNextChoice_init,
                       Ns_StackSearch::goal_iterator git,
                       const unsigned long descBorn_init)
           : goalNextChoice(goalNextChoice_init),
             delayedGoal(git),
+            refutable(true),
             children(0),
             timeBorn(clock()),
             descBorn(descBorn_init),
@@ -4365,44 +5860,261 @@ struct Ns_SearchNode {
         {
         }
 
-        /// Describes a tuple (BitsetDomainPointer, BitsetDomain)
+        /// Describes a tuple (BitsetDomainPointer, BitsetDomainState)
         class BitsetCopy {
 
             private:
                 /// Pointer to a bit-set domain
                 Ns_BitSet* bitsetDomainPointer;
 
-                /// A copy of the above instance--created for future
-                /// backtracking reasons
-                Ns_BitSet bitsetDomainCopy;
+                /// The bounds and counters of the above instance--kept for
+                /// future backtracking reasons
+                Ns_BitSet::State bitsetDomainState;
 
             public:
-                /// Copy-constructor
                 BitsetCopy(Ns_BitSet& bitsetDomain)
                   : bitsetDomainPointer(&bitsetDomain),
-                    bitsetDomainCopy(bitsetDomain)
+                    bitsetDomainState(bitsetDomain.state())
                 {
                 }
 
-                /// Restores the copy back to the original domain place (i.e.
+                /// Restores the state back to the original domain place (i.e.
                 /// pointer)
                 void restore(void)
                 {
-                        *bitsetDomainPointer = bitsetDomainCopy;
+                        bitsetDomainPointer->restore(bitsetDomainState);
+                }
+        };
+
+        /// Describes a tuple (BitsetDomainPointer, WordIndex, WordValue)
+        class BitsetWordCopy {
+
+            private:
+                /// Pointer to a bit-set domain
+                Ns_BitSet* bitsetDomainPointer;
+
+                /// The position of the machine word in the bit-set
+                NsUInt index;
+
+                /// The value of the machine word before its change
+                size_t value;
+
+            public:
+                BitsetWordCopy(Ns_BitSet& bitsetDomain, const NsUInt index_init)
+                  : bitsetDomainPointer(&bitsetDomain),
+                    index(index_init),
+                    value(bitsetDomain.word(index_init))
+                {
+                }
+
+                void restore(void)
+                {
+                        bitsetDomainPointer->restoreWord(index, value);
+                }
+        };
+
+        /// Describes an edit of an interval-list domain, in order to undo it
+        class BitsetIntervalCopy {
+
+            private:
+                /// Pointer to an interval-list domain
+                Ns_BitSet* bitsetDomainPointer;
+
+                /// The position of the edited interval
+                NsUInt index;
+
+                Ns_BitSet::IntervalEdit edit;
+
+                /// The interval before its change or erasure, or the
+                /// inserted one
+                Ns_BitSet::Interval interval;
+
+            public:
+                BitsetIntervalCopy(Ns_BitSet& bitsetDomain,
+                                   const NsUInt index_init,
+                                   const Ns_BitSet::IntervalEdit edit_init)
+                  : bitsetDomainPointer(&bitsetDomain),
+                    index(index_init),
+                    edit(edit_init),
+                    interval(bitsetDomain.interval(index_init))
+                {
+                }
+
+                void restore(void)
+                {
+                        bitsetDomainPointer->undoInterval(index, edit,
+                                                          interval);
+                }
+        };
+
+        /// Describes the number of the live constraints of a variable
+        class LiveConstraintsCopy {
+
+            private:
+                NsIntVar* var;
+
+                NsIndex liveConstraints;
+
+            public:
+                LiveConstraintsCopy(NsIntVar& var_init)
+                  : var(&var_init), liveConstraints(var_init.liveConstraints)
+                {
+                }
+
+                /// The constraints that come back to life add their
+                /// weights again
+                void restore(void)
+                {
+                        for (NsIndex k = var->liveConstraints;
+                             k < liveConstraints; ++k) {
+                                var->weightedDegree +=
+                                    var->constraints[k].constr->weight;
+                        }
+                        var->liveConstraints = liveConstraints;
+                }
+        };
+
+        /// Describes an integer or a machine word of the internal state
+        /// of a constraint
+        template <typename TemplType>
+        class ValueCopy {
+
+            private:
+                TemplType* valuePointer;
+
+                TemplType value;
+
+            public:
+                ValueCopy(TemplType& value_init)
+                  : valuePointer(&value_init), value(value_init)
+                {
+                }
+
+                void restore(void)
+                {
+                        *valuePointer = value;
                 }
         };
 
     private:
-        /// List to contain the saved bit-set domains
-        class BitsetsStore : public NsStack<BitsetCopy> {
+        /// Trail to contain the saved states, machine words and interval
+        /// edits of bit-sets
+        class BitsetsStore {
+
+            private:
+                NsStack<BitsetCopy> bitsets;
+
+                NsStack<BitsetWordCopy> words;
+
+                NsStack<BitsetIntervalCopy> intervals;
 
             public:
+                void push(const BitsetCopy& bitsetCopy)
+                {
+                        bitsets.push(bitsetCopy);
+                }
+
+                void push(const BitsetWordCopy& wordCopy)
+                {
+                        words.push(wordCopy);
+                }
+
+                void push(const BitsetIntervalCopy& intervalCopy)
+                {
+                        intervals.push(intervalCopy);
+                }
+
+                void clear(void)
+                {
+                        intervals.clear();
+                        words.clear();
+                        bitsets.clear();
+                }
+
                 /// Restores all the saved bit-set domains
+                ///
+                /// The machine words and the interval edits are restored
+                /// first, in the reverse order they were saved, because
+                /// restoring a bit-set state may discard them.
+                void restore(void)
+                {
+                        while (!words.empty()) {
+                                words.top().restore();
+                                words.pop();
+                        }
+                        while (!intervals.empty()) {
+                                intervals.top().restore();
+                                intervals.pop();
+                        }
+                        while (!bitsets.empty()) {
+                                bitsets.top().restore();
+                                bitsets.pop();
+                        }
+                }
+        };
+
+        /// Trail to contain the constraints that have been entailed, the
+        /// variables that dropped them and the internal states of the
+        /// constraints
+        class ConstraintsStore {
+
+            private:
+                NsStack<Ns_Constraint*> entailed;
+
+                NsStack<LiveConstraintsCopy> liveConstraints;
+
+                NsStack<ValueCopy<NsInt>> values;
+
+                NsStack<ValueCopy<size_t>> words;
+
+            public:
+                void push(Ns_Constraint* constr)
+                {
+                        entailed.push(constr);
+                }
+
+                void push(const LiveConstraintsCopy& liveCopy)
+                {
+                        liveConstraints.push(liveCopy);
+                }
+
+                void push(const ValueCopy<NsInt>& valueCopy)
+                {
+                        values.push(valueCopy);
+                }
+
+                void push(const ValueCopy<size_t>& wordCopy)
+                {
+                        words.push(wordCopy);
+                }
+
+                void clear(void)
+                {
+                        words.clear();
+                        values.clear();
+                        liveConstraints.clear();
+                        entailed.clear();
+                }
+
+                /// Revives the constraints that have been entailed and
+                /// restores their states
                 void restore(void)
                 {
-                        while (!empty()) {
-                                top().restore();
-                                pop();
+                        while (!words.empty()) {
+                                words.top().restore();
+                                words.pop();
+                        }
+                        while (!values.empty()) {
+                                values.top().restore();
+                                values.pop();
+                        }
+                        while (!liveConstraints.empty()) {
+                                liveConstraints.top().restore();
+                                liveConstraints.pop();
+                        }
+                        while (!entailed.empty()) {
+                                entailed.top()->entailed = false;
+                                entailed.pop();
                         }
                 }
         };
@@ -4411,6 +6123,10 @@ struct Ns_SearchNode {
         /// Store to keep the previous states of the modified bit-sets
         BitsetsStore bitsetsStore;
 
+        /// Store to revive the entailed constraints and restore their
+        /// states
+        ConstraintsStore constraintsStore;
+
         /// The node's children number
         NsUInt children;
 
@@ -4451,13 +6167,44 @@ class NsProblemManager {
         /// AC algorithm event-queue
         Ns_Queue_t Q;
 
+    public:
+        /// The available propagation engines
+        enum PropagationEngine {
+
+                /// Queues the modified variables and revises all the
+                /// constraints of each one (AC-5 style)
+                VARIABLE_QUEUE,
+
+                /// Queues the constraints that should be revised, once
+                /// per constraint, into a queue per priority class
+                CONSTRAINT_QUEUE
+        };
+
+    private:
+        PropagationEngine propagation;
+
+        /// The queues of the constraint-centric engine, one per priority
+        /// class
+        NsQueue<Ns_Constraint*>
+            constraintQueues[Ns_Constraint::N_PRIORITY_CLASSES];
+
+        void clearQueues(void);
+
         /// True, if an inconsistency has been found
         bool foundInconsistency;
 
         bool arcConsistent(void);
 
+        void scheduleConstraints(Ns_QueueItem& Qitem);
+
+        bool constraintsArcConsistent(void);
+
         bool backtrack(void);
 
+        bool restartSearch(void);
+
+        void recordNogoods(void);
+
         /// The list of the soft (meta)constraints to be satisfied
         NsIntVarArray vSoftConstraintsTerms;
 
@@ -4465,7 +6212,8 @@ class NsProblemManager {
         /// If a fileNameSearchGraph is provided, then a file is created with
         /// the search tree in a Graphviz supported format.
         NsProblemManager(void)
-          : foundInconsistency(false),
+          : propagation(VARIABLE_QUEUE),
+            foundInconsistency(false),
             vObjective(0),
             timeLim(0),
             firstNextSolution(true),
@@ -4475,7 +6223,20 @@ class NsProblemManager {
             nBacktracks(0),
             nGoals(0),
             nConstraintChecks(0),
-            backtrackLim(0)
+            backtrackLim(0),
+            restarts(NO_RESTARTS),
+            restartScale(0),
+            restartFactor(1),
+            restartCutoff(0),
+            restartFailures(0),
+            nRestarts(0),
+            nogoods(0),
+            decisionGoal(false),
+            goalShrinks(0),
+            learning(false),
+            decay(0.999),
+            searchSpaceReduction(0),
+            decisionVar(0)
         {
                 assert_Ns(sizeof(NsIntVar*) <= sizeof(Ns_pointer_t),
                           "NsProblemManager::NsProblemManager: Cannot run on "
@@ -4512,6 +6273,8 @@ class NsProblemManager {
                 foundInconsistency = true;
         }
 
+        void propagationEngine(const PropagationEngine engine);
+
         bool nextSolution(void);
 
         void restart(void);
@@ -4776,6 +6539,193 @@ class NsProblemManager {
 
         /// @}
 
+        /// @{
+        /// @name Restart controller members
+
+    public:
+        /// The policies that set the number of the failures after
+        /// which nextSolution() restarts the search
+        enum RestartPolicy {
+
+                /// The search is never restarted
+                NO_RESTARTS,
+
+                /// The cutoff of the i-th run is the scale times the
+                /// i-th term of the Luby sequence 1 1 2 1 1 2 4 ...
+                LUBY,
+
+                /// The cutoff is the scale times factor^i for the i-th
+                /// run, counting from zero
+                GEOMETRIC,
+
+                /// The cutoff is always the scale
+                FAIL_COUNT
+        };
+
+    private:
+        RestartPolicy restarts;
+
+        unsigned long restartScale;
+
+        double restartFactor;
+
+        /// The failures allowed for the current run
+        unsigned long restartCutoff;
+
+        /// The number of the failures when the current run began
+        unsigned long restartFailures;
+
+        unsigned long nRestarts;
+
+        void nextRestartCutoff(void);
+
+        /// The nogoods extracted on the restarts; null if there is none
+        Ns_ConstrNogoods* nogoods;
+
+        /// True if the current goal is an NsgSetValue or an
+        /// NsgRemoveValue, whose decision is recorded
+        bool decisionGoal;
+
+        /// The number of the domains that the current goal shrank
+        unsigned long goalShrinks;
+
+        void recordGoalEffect(void);
+
+        /// The generator of the random tie-breaking
+        std::minstd_rand tieGenerator;
+
+    public:
+        void restartPolicy(const RestartPolicy policy,
+                           const unsigned long scale = 100,
+                           const double factor = 1.5);
+
+        unsigned long numRestarts(void) const
+        {
+                return nRestarts;
+        }
+
+        NsIndex numNogoods(void) const
+        {
+                return ((nogoods == 0) ? 0 : nogoods->size());
+        }
+
+        /// Records that the current goal removes value from Var
+        void removalOn(NsIntVar& Var, const NsInt value)
+        {
+                decisionGoal = true;
+                if (restarts == NO_RESTARTS || !Var.contains(value))
+                        return;
+                std::vector<Ns_SearchNode::Decision>& decisions =
+                    searchNodes.top().decisions;
+                // The removal of a refuted value is implied
+                if (decisions.empty() || !decisions.back().refuted ||
+                    decisions.back().var != &Var ||
+                    decisions.back().value != value) {
+                        decisions.push_back(
+                            Ns_SearchNode::Decision(0, 0, false));
+                }
+        }
+
+        /// Counts a domain that shrank, in order to find out
+        /// whether the current goal modified any domain
+        void domainShrunk(void)
+        {
+                ++goalShrinks;
+        }
+
+        /// True if the heuristics should break their ties at random
+        ///
+        /// Then every restart explores a different search tree.
+        bool randomTies(void) const
+        {
+                return (restarts != NO_RESTARTS);
+        }
+
+        /// Seeds the random tie-breaking, in order to reproduce a search
+        void randomSeed(const unsigned long seed)
+        {
+                tieGenerator.seed(seed);
+        }
+
+        /// Returns a random number in the range [0, n)
+        unsigned long randomTie(const unsigned long n)
+        {
+                return (tieGenerator() % n);
+        }
+
+        /// @}
+
+        /// @{
+        /// @name Search history for the activity- and impact-based heuristics
+
+    private:
+        /// True if the activities and the impacts of the variables
+        /// are recorded
+        bool learning;
+
+        /// The factor that multiplies the activities after each goal
+        double decay;
+
+        /// The logarithm of P/P' for the current goal, where P is
+        /// the product of the domain sizes before the goal, and P'
+        /// the current one
+        double searchSpaceReduction;
+
+        /// The variable that the current goal assigns, if any
+        NsIntVar* decisionVar;
+
+        void recordImpact(const bool consistent);
+
+    public:
+        /// Starts recording the activities and the impacts of the
+        /// variables
+        ///
+        /// It is called by the heuristics that need them, so that
+        /// the other searches do not pay for the recording.
+        void learnFromSearch(void)
+        {
+                learning = true;
+        }
+
+        bool learnsFromSearch(void) const
+        {
+                return learning;
+        }
+
+        /// Sets the factor that multiplies the activities after each goal
+        void activityDecay(const double factor)
+        {
+                assert_Ns(0 < factor && factor <= 1,
+                          "NsProblemManager::activityDecay: The factor should "
+                          "be in the range (0,1]");
+                decay = factor;
+        }
+
+        double activityDecay(void) const
+        {
+                return decay;
+        }
+
+        /// Records that a domain size shrank from oldSize to newSize
+        void searchSpaceReduced(const NsUInt oldSize, const NsUInt newSize)
+        {
+                searchSpaceReduction += std::log(static_cast<double>(oldSize)) -
+                                        std::log(static_cast<double>(newSize));
+        }
+
+        /// Records that the current goal assigns value to Var
+        void decisionOn(NsIntVar& Var, const NsInt value)
+        {
+                decisionVar = &Var;
+                decisionGoal = true;
+                if (restarts != NO_RESTARTS && !Var.isBound()) {
+                        searchNodes.top().decisions.push_back(
+                            Ns_SearchNode::Decision(&Var, value, false));
+                }
+        }
+
+        /// @}
+
         /// @{
         /// @name Arrays of variables and constraints used for memory management
 
@@ -4784,17 +6734,31 @@ class NsProblemManager {
 
         Ns_constraints_array_t constraints;
 
+        /// The interned tables, by their hash values
+        Ns_UNORDERED_MAP<size_t, NsDeque<Ns_TupleStore*>> tupleStores;
+
+        NsDeque<Ns_FirstFailHeap*> firstFailHeaps;
+
     public:
         void recordIntermediateVar(NsIntVar* Var)
         {
                 intermediateVars.push_back(Var);
         }
 
+        /// Returns the interned store with the same tuples as
+        /// newStore, which is deleted if such a store already exists
+        Ns_TupleStore* internTupleStore(Ns_TupleStore* newStore);
+
         void recordConstraint(Ns_Constraint* newConstr)
         {
                 constraints.push_back(newConstr);
         }
 
+        void recordFirstFailHeap(Ns_FirstFailHeap* newHeap)
+        {
+                firstFailHeaps.push_back(newHeap);
+        }
+
         /// @}
 
         /// @{
@@ -4834,6 +6798,59 @@ class NsProblemManager {
                     Ns_SearchNode::BitsetCopy(bitsetDomain));
                 bitsetDomain.lastSaveHistoryId() = getCurrentHistoryId();
         }
+
+        /// Saves a machine word of the bitsetDomain before it changes
+        void saveBitsetWord(Ns_BitSet& bitsetDomain, const NsUInt mw)
+        {
+                searchNodes.top().bitsetsStore.push(
+                    Ns_SearchNode::BitsetWordCopy(bitsetDomain, mw));
+        }
+
+        /// Deactivates constr for the rest of the current search subtree
+        ///
+        /// A constraint calls it when it is satisfied by every
+        /// combination of the values of its variables. Then the
+        /// constraint is no longer revised, until backtracking.
+        void entail(Ns_Constraint* constr)
+        {
+                if (constr->entailed)
+                        return;
+                constr->entailed = true;
+                searchNodes.top().constraintsStore.push(constr);
+        }
+
+        /// Saves the number of the live constraints of var before it
+        /// changes
+        void saveLiveConstraints(NsIntVar& var)
+        {
+                searchNodes.top().constraintsStore.push(
+                    Ns_SearchNode::LiveConstraintsCopy(var));
+        }
+
+        /// Saves an integer of the state of a constraint before it
+        /// changes, in order to restore it on backtracking
+        void saveValue(NsInt& value)
+        {
+                searchNodes.top().constraintsStore.push(
+                    Ns_SearchNode::ValueCopy<NsInt>(value));
+        }
+
+        /// Saves a machine word of a bit-set of a constraint before it
+        /// changes
+        void saveValue(size_t& word)
+        {
+                searchNodes.top().constraintsStore.push(
+                    Ns_SearchNode::ValueCopy<size_t>(word));
+        }
+
+        /// Saves an interval of the bitsetDomain before it is edited
+        void saveBitsetInterval(Ns_BitSet& bitsetDomain, const NsUInt index,
+                                const Ns_BitSet::IntervalEdit edit)
+        {
+                searchNodes.top().bitsetsStore.push(
+                    Ns_SearchNode::BitsetIntervalCopy(bitsetDomain, index,
+                                                      edit));
+        }
 };
 
 } // end namespace
@@ -196,6 +196,85 @@ class Ns_ConstrCount : public Ns_Constraint {
                 return VarArr->size();
         }
 
+        virtual bool revisedLocally(void) const
+        {
+                return true;
+        }
+
+        virtual void toGraphFile(std::ofstream& fileConstraintsGraph) const
+        {
+                Ns_arrayConstraintToGraphFile(fileConstraintsGraph, VarArr,
+                                              this, "count");
+        }
+
+        virtual void ArcCons(void);
+        virtual void LocalArcCons(Ns_QueueItem& Qitem);
+};
+
+/// The global cardinality constraint, filtered via network flow
+///
+/// Each variable is matched to a value, so that every value is matched
+/// to as many variables as its occurrences. As the occurrences sum up
+/// to the number of the variables, a value is kept in a domain only if
+/// their edge belongs to the matching or to a cycle of the residual
+/// graph. With 'boundsOnly', the domains are relaxed to intervals and
+/// only their bounds are pruned. The matching is kept between the
+/// revisions and it is repaired only where it has been broken.
+class Ns_ConstrCountFlow : public Ns_Constraint {
+
+    private:
+        NsIntVarArray* VarArr;
+
+        const bool boundsOnly;
+
+        /// The sorted values to be distributed
+        NsDeque<NsInt> values;
+
+        /// The index of each value into 'values'
+        Ns_UNORDERED_MAP<NsInt, NsIndex> valueIndices;
+
+        /// The occurrences of each value
+        NsDeque<NsIndex> occurrences;
+
+        static const NsIndex UNMATCHED = static_cast<NsIndex>(-1);
+
+        /// The index of the value matched to each variable
+        NsDeque<NsIndex> varMatch;
+
+        /// The positions of the variables matched to each value
+        NsDeque<NsDeque<NsIndex>> valueMatches;
+
+        /// The last search for an augmenting path that visited each
+        /// value
+        NsDeque<unsigned long> valueVisit;
+
+        unsigned long nAugmentations;
+
+        NsIndex firstValue(const NsIntVar& X) const;
+        bool isEdge(const NsIntVar& X, const NsIndex v) const;
+        void unmatch(const NsIndex x);
+        bool augment(const NsIndex x);
+        bool repairMatching(void);
+        bool removeUnmatchableValues(void);
+        bool matchable(const NsIndex x, const NsInt val,
+                       const NsDeque<NsIndex>& component) const;
+
+    public:
+        Ns_ConstrCountFlow(NsIntVarArray* VarArr_init,
+                           const NsDeque<NsInt>& Values,
+                           const NsDeque<NsInt>& Occurrences,
+                           const bool boundsOnly_init);
+
+        virtual int varsInvolvedIn(void) const
+        {
+                return VarArr->size();
+        }
+
+        virtual PriorityClass priorityClass(void) const
+        {
+                return EXPENSIVE_PRIORITY;
+        }
+
         virtual void toGraphFile(std::ofstream& fileConstraintsGraph) const
         {
                 Ns_arrayConstraintToGraphFile(fileConstraintsGraph, VarArr,
@@ -244,6 +323,11 @@ class Ns_ConstrInverse : public Ns_Constraint {
                 return (VarArrInv->size() + VarArr->size());
         }
 
+        virtual PriorityClass priorityClass(void) const
+        {
+                return EXPENSIVE_PRIORITY;
+        }
+
         virtual void toGraphFile(std::ofstream& fileConstraintsGraph) const
         {
                 Ns_inverseConstraintToGraphFile(fileConstraintsGraph, VarArr,
@@ -254,6 +338,211 @@ class Ns_ConstrInverse : public Ns_Constraint {
         virtual void LocalArcCons(Ns_QueueItem& Qitem);
 };
 
+/// A resource with a capacity, shared by tasks that start at 'VarArr'
+///
+/// The i-th task lasts durations[i] and consumes demands[i] units of
+/// the resource while running. The profile of the compulsory parts of
+/// the tasks is swept, in order to push their bounds (time-tabling).
+/// The optional edge-finding pass also pushes a task after the end of
+/// the tasks that cannot fit together with it before their deadline.
+///
+/// The profile is kept between the revisions. When the compulsory part
+/// of a modified task does not change, neither does the profile, and
+/// only the modified task is pushed.
+class Ns_ConstrCumulative : public Ns_Constraint {
+
+    private:
+        NsIntVarArray* VarArr;
+
+        NsDeque<NsInt> durations;
+
+        NsDeque<NsInt> demands;
+
+        const NsInt capacity;
+
+        const bool edgeFinding;
+
+        /// The earliest start and the latest completion times
+        NsDeque<NsInt> est, lct;
+
+        /// The tasks sorted by the start and by the end of their
+        /// compulsory parts
+        ///
+        /// They are kept between the revisions, as they are then
+        /// almost sorted.
+        NsDeque<NsIndex> byCompulsoryStart, byCompulsoryEnd;
+
+        struct Segment_t {
+
+                NsInt start;
+
+                NsInt end;
+
+                /// The sum of the demands of the compulsory parts
+                NsInt height;
+
+                Segment_t(const NsInt start_init, const NsInt end_init,
+                          const NsInt height_init)
+                  : start(start_init), end(end_init), height(height_init)
+                {
+                }
+        };
+
+        /// The segments of the profile where the height is nonzero
+        NsDeque<Segment_t> profile;
+
+        /// The compulsory parts of the tasks in the profile with the
+        /// current 'profileStamp'
+        NsDeque<NsInt> profiledStart, profiledEnd;
+
+        /// Identifies the compulsory parts of the current search node
+        ///
+        /// It changes whenever a compulsory part changes, and it is
+        /// restored on backtracking.
+        NsInt profileStamp;
+
+        /// The number of the different 'profileStamp's so far
+        NsInt nProfileStamps;
+
+        /// The 'profileStamp' of the compulsory parts in 'profile'
+        NsInt builtProfileStamp;
+
+        /// The search node where 'profileStamp' has been saved
+        Ns_HistoryId_t lastSaveId;
+
+        typedef Ns_UNORDERED_MAP<Ns_pointer_t, NsIndex> VarIndex_t;
+
+        /// The task of each variable, or SHARED_VAR for a variable
+        /// that is the start of more than one task
+        VarIndex_t VarIndex;
+
+        static const NsIndex SHARED_VAR = NsUPLUS_INF;
+
+        void compulsoryPart(const NsIndex i, NsInt& start, NsInt& end) const;
+        bool buildProfile(void);
+        void recordProfile(void);
+        bool pushOutOfProfile(const NsIndex i, NsInt& newEst,
+                              NsInt& newLct) const;
+        bool timeTable(bool& modified);
+        bool edgeFind(bool& modified);
+
+    public:
+        Ns_ConstrCumulative(NsIntVarArray* VarArr_init,
+                            const NsDeque<NsInt>& Durations,
+                            const NsDeque<NsInt>& Demands,
+                            const NsInt capacity_init,
+                            const bool edgeFinding_init);
+
+        virtual int varsInvolvedIn(void) const
+        {
+                return VarArr->size();
+        }
+
+        virtual PriorityClass priorityClass(void) const
+        {
+                return EXPENSIVE_PRIORITY;
+        }
+
+        virtual void toGraphFile(std::ofstream& fileConstraintsGraph) const
+        {
+                Ns_arrayConstraintToGraphFile(fileConstraintsGraph, VarArr,
+                                              this, "cumulative");
+        }
+
+        virtual void ArcCons(void);
+        virtual void LocalArcCons(Ns_QueueItem& Qitem);
+};
+
+/// A unary resource, where the tasks that start at 'VarArr' never
+/// overlap
+///
+/// The i-th task lasts durations[i]. Each revision applies overload
+/// checking, detectable precedences, not-first/not-last and
+/// edge-finding, via Theta-trees in O(n log n) time. A task of zero
+/// duration is left out of the trees, and a separate check keeps it
+/// from starting strictly inside another task.
+class Ns_ConstrDisjunctive : public Ns_Constraint {
+
+    private:
+        NsIntVarArray* VarArr;
+
+        NsDeque<NsInt> durations;
+
+        /// The earliest start and the latest completion times
+        NsDeque<NsInt> est, lct;
+
+        /// The indices of the tasks of zero duration
+        NsDeque<NsIndex> instantTasks;
+
+        bool pruneInstantTasks(bool& modified);
+
+    public:
+        Ns_ConstrDisjunctive(NsIntVarArray* VarArr_init,
+                             const NsDeque<NsInt>& Durations);
+
+        virtual int varsInvolvedIn(void) const
+        {
+                return VarArr->size();
+        }
+
+        virtual PriorityClass priorityClass(void) const
+        {
+                return EXPENSIVE_PRIORITY;
+        }
+
+        virtual void toGraphFile(std::ofstream& fileConstraintsGraph) const
+        {
+                Ns_arrayConstraintToGraphFile(fileConstraintsGraph, VarArr,
+                                              this, "disjunctive");
+        }
+
+        virtual void ArcCons(void);
+        virtual void LocalArcCons(Ns_QueueItem& Qitem);
+};
+
+/// Rectangles with origins at 'VarArrX' and 'VarArrY' that never
+/// overlap
+///
+/// The i-th rectangle has width widths[i] and height heights[i]; a
+/// rectangle of zero area overlaps nothing. The compulsory parts of
+/// the rectangles forbid regions for the origins of the others, which
+/// are swept in order to push their bounds.
+class Ns_ConstrDiffn : public Ns_Constraint {
+
+    private:
+        NsIntVarArray *VarArrX, *VarArrY;
+
+        /// The sizes of the rectangles in each dimension
+        NsDeque<NsInt> sizes[2];
+
+        /// The bounds of the origins in each dimension
+        NsDeque<NsInt> lo[2], hi[2];
+
+        /// Whether 'lo' and 'hi' are the bounds where the last revision
+        /// reached its fixpoint
+        bool atFixpoint;
+
+    public:
+        Ns_ConstrDiffn(NsIntVarArray* VarArrX_init, NsIntVarArray* VarArrY_init,
+                       const NsDeque<NsInt>& Widths,
+                       const NsDeque<NsInt>& Heights);
+
+        virtual int varsInvolvedIn(void) const
+        {
+                return (VarArrX->size() + VarArrY->size());
+        }
+
+        virtual PriorityClass priorityClass(void) const
+        {
+                return EXPENSIVE_PRIORITY;
+        }
+
+        virtual void toGraphFile(std::ofstream& fileConstraintsGraph) const;
+
+        virtual void ArcCons(void);
+        virtual void LocalArcCons(Ns_QueueItem& Qitem);
+};
+
 class Ns_ExprYplusCZspecial : public Ns_Expression {
 
     private:
@@ -311,6 +600,19 @@ inline Ns_ExprInDomain NsInDomain(NsProblemManager& pm, NsDeque<NsInt>& domain,
         return Ns_ExprInDomain(pm, domain, &domainPrevious, &domainNext);
 }
 
+/// The consistency that NsCount achieves
+enum NsCountConsistency {
+
+        /// Each variable is revised against the remaining occurrences
+        NsCOUNT_VALUES,
+
+        /// The bounds are revised via the flow of the interval domains
+        NsCOUNT_BOUNDS,
+
+        /// Every value that does not belong to any solution is removed
+        NsCOUNT_DOMAINS
+};
+
 class Ns_ExprConstrCount : public Ns_ExprConstr {
 
     private:
@@ -320,20 +622,23 @@ class Ns_ExprConstrCount : public Ns_ExprConstr {
         const NsDeque<NsDeque<NsIndex>>& SplitPositions;
         const NsIndex Split;
         const NsIndex Dwin;
+        const NsCountConsistency consistency;
 
     public:
         Ns_ExprConstrCount(NsIntVarArray& Arr,
                            const NsDeque<NsInt>& Values_init,
                            const NsDeque<NsInt>& Occurrences_init,
                            const NsDeque<NsDeque<NsIndex>>& SplitPositions_init,
-                           const NsIndex Split_init, const NsIndex Dwin_init)
+                           const NsIndex Split_init, const NsIndex Dwin_init,
+                           const NsCountConsistency consistency_init)
           : Ns_ExprConstr(true),
             VarArr(Arr),
             Values(Values_init),
             Occurrences(Occurrences_init),
             SplitPositions(SplitPositions_init),
             Split(Split_init),
-            Dwin(Dwin_init)
+            Dwin(Dwin_init),
+            consistency(consistency_init)
         {
         }
 
@@ -359,7 +664,19 @@ NsCount(NsIntVarArray& Arr, const NsDeque<NsInt>& Values,
         const NsIndex Split = 0, const NsIndex Dwin = 1)
 {
         return Ns_ExprConstrCount(Arr, Values, Occurrences, SplitPositions,
-                                  Split, Dwin);
+                                  Split, Dwin, NsCOUNT_VALUES);
+}
+
+inline Ns_ExprConstrCount
+NsCount(NsIntVarArray& Arr, const NsDeque<NsInt>& Values,
+        const NsDeque<NsInt>& Occurrences,
+        const NsCountConsistency consistency,
+        const NsDeque<NsDeque<NsIndex>>& SplitPositions =
+            NsDeque<NsDeque<NsIndex>>(),
+        const NsIndex Split = 0, const NsIndex Dwin = 1)
+{
+        return Ns_ExprConstrCount(Arr, Values, Occurrences, SplitPositions,
+                                  Split, Dwin, consistency);
 }
 
 class Ns_ExprInverse : public Ns_ExpressionArray {
@@ -387,6 +704,131 @@ inline Ns_ExprInverse NsInverse(NsIntVarArray& Arr, const NsInt MaxDom)
         return Ns_ExprInverse(Arr, MaxDom);
 }
 
+class Ns_ExprConstrCumulative : public Ns_ExprConstr {
+
+    private:
+        NsIntVarArray& Starts;
+        const NsDeque<NsInt>& Durations;
+        const NsDeque<NsInt>& Demands;
+        const NsInt Capacity;
+        const bool EdgeFinding;
+
+    public:
+        Ns_ExprConstrCumulative(NsIntVarArray& Starts_init,
+                                const NsDeque<NsInt>& Durations_init,
+                                const NsDeque<NsInt>& Demands_init,
+                                const NsInt Capacity_init,
+                                const bool EdgeFinding_init)
+          : Ns_ExprConstr(true),
+            Starts(Starts_init),
+            Durations(Durations_init),
+            Demands(Demands_init),
+            Capacity(Capacity_init),
+            EdgeFinding(EdgeFinding_init)
+        {
+        }
+
+        virtual Ns_Constraint* postConstraint(bool positively) const;
+
+        virtual void postC(NsIntVar& /*VarX*/, bool /*positively*/) const
+        {
+                throw NsException("Ns_ExprConstrCumulative::postC: "
+                                  "NsCumulative cannot be used as a "
+                                  "meta-constraint");
+        }
+        virtual NsIntVar& postC(bool /*positively*/) const
+        {
+                throw NsException("Ns_ExprConstrCumulative::postC: "
+                                  "NsCumulative cannot be used as a "
+                                  "meta-constraint");
+        }
+};
+
+inline Ns_ExprConstrCumulative
+NsCumulative(NsIntVarArray& Starts, const NsDeque<NsInt>& Durations,
+             const NsDeque<NsInt>& Demands, const NsInt Capacity,
+             const bool EdgeFinding = false)
+{
+        return Ns_ExprConstrCumulative(Starts, Durations, Demands, Capacity,
+                                       EdgeFinding);
+}
+
+class Ns_ExprConstrDisjunctive : public Ns_ExprConstr {
+
+    private:
+        NsIntVarArray& Starts;
+        const NsDeque<NsInt>& Durations;
+
+    public:
+        Ns_ExprConstrDisjunctive(NsIntVarArray& Starts_init,
+                                 const NsDeque<NsInt>& Durations_init)
+          : Ns_ExprConstr(true), Starts(Starts_init), Durations(Durations_init)
+        {
+        }
+
+        virtual Ns_Constraint* postConstraint(bool positively) const;
+
+        virtual void postC(NsIntVar& /*VarX*/, bool /*positively*/) const
+        {
+                throw NsException("Ns_ExprConstrDisjunctive::postC: "
+                                  "NsDisjunctive cannot be used as a "
+                                  "meta-constraint");
+        }
+        virtual NsIntVar& postC(bool /*positively*/) const
+        {
+                throw NsException("Ns_ExprConstrDisjunctive::postC: "
+                                  "NsDisjunctive cannot be used as a "
+                                  "meta-constraint");
+        }
+};
+
+inline Ns_ExprConstrDisjunctive NsDisjunctive(NsIntVarArray& Starts,
+                                              const NsDeque<NsInt>& Durations)
+{
+        return Ns_ExprConstrDisjunctive(Starts, Durations);
+}
+
+class Ns_ExprConstrDiffn : public Ns_ExprConstr {
+
+    private:
+        NsIntVarArray& X;
+        NsIntVarArray& Y;
+        const NsDeque<NsInt>& Widths;
+        const NsDeque<NsInt>& Heights;
+
+    public:
+        Ns_ExprConstrDiffn(NsIntVarArray& X_init, NsIntVarArray& Y_init,
+                           const NsDeque<NsInt>& Widths_init,
+                           const NsDeque<NsInt>& Heights_init)
+          : Ns_ExprConstr(true),
+            X(X_init),
+            Y(Y_init),
+            Widths(Widths_init),
+            Heights(Heights_init)
+        {
+        }
+
+        virtual Ns_Constraint* postConstraint(bool positively) const;
+
+        virtual void postC(NsIntVar& /*VarX*/, bool /*positively*/) const
+        {
+                throw NsException("Ns_ExprConstrDiffn::postC: NsDiffn "
+                                  "cannot be used as a meta-constraint");
+        }
+        virtual NsIntVar& postC(bool /*positively*/) const
+        {
+                throw NsException("Ns_ExprConstrDiffn::postC: NsDiffn "
+                                  "cannot be used as a meta-constraint");
+        }
+};
+
+inline Ns_ExprConstrDiffn NsDiffn(NsIntVarArray& X, NsIntVarArray& Y,
+                                  const NsDeque<NsInt>& Widths,
+                                  const NsDeque<NsInt>& Heights)
+{
+        return Ns_ExprConstrDiffn(X, Y, Widths, Heights);
+}
+
 } // end namespace
 
 #endif // Ns_NAXOS_H
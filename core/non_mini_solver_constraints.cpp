@@ -297,6 +297,299 @@ void Ns_ConstrCount::LocalArcCons(Ns_QueueItem& Qitem)
         countArcCons(*VarArr, i, ValueIndex, ValuesOccurrences, Dwin, this);
 }
 
+const NsIndex Ns_ConstrCountFlow::UNMATCHED;
+
+Ns_ConstrCountFlow::Ns_ConstrCountFlow(NsIntVarArray* VarArr_init,
+                                       const NsDeque<NsInt>& Values,
+                                       const NsDeque<NsInt>& Occurrences,
+                                       const bool boundsOnly_init)
+  : VarArr(VarArr_init), boundsOnly(boundsOnly_init), nAugmentations(0)
+{
+        if (!boundsOnly)
+                revisionType = VALUE_CONSISTENCY;
+        assert_Ns(!VarArr->empty(), "Ns_ConstrCountFlow::Ns_ConstrCountFlow: "
+                                    "Condition required: !VarArr.empty()");
+        NsIntVarArray::iterator X = VarArr->begin();
+        NsProblemManager& pm = X->manager();
+        Ns_UNORDERED_SET<Ns_pointer_t> vars;
+        for (; X != VarArr->end(); ++X) {
+                assert_Ns(&pm == &X->manager(),
+                          "Ns_ConstrCountFlow::Ns_ConstrCountFlow: All the "
+                          "variables of a constraint must belong to the same "
+                          "NsProblemManager");
+                assert_Ns(vars.insert((Ns_pointer_t) & *X).second,
+                          "Ns_ConstrCountFlow::Ns_ConstrCountFlow: Duplicate "
+                          "NsIntVar");
+        }
+        assert_Ns(Values.size() == Occurrences.size(),
+                  "Ns_ConstrCountFlow::Ns_ConstrCountFlow: 'Values' and "
+                  "'Occurrences' sizes should match");
+        values = Values;
+        sort(values.begin(), values.end());
+        NsIndex i;
+        for (i = 0; i < values.size(); ++i) {
+                assert_Ns(valueIndices.insert(make_pair(values[i], i)).second,
+                          "Ns_ConstrCountFlow::Ns_ConstrCountFlow: Duplicate "
+                          "value");
+        }
+        occurrences.resize(values.size());
+        NsIndex occurrencesSum = 0;
+        for (i = 0; i < Values.size(); ++i) {
+                assert_Ns(Occurrences[i] >= 0,
+                          "Ns_ConstrCountFlow::Ns_ConstrCountFlow: negative "
+                          "value in 'Occurrences'");
+                occurrences[valueIndices[Values[i]]] = Occurrences[i];
+                occurrencesSum += Occurrences[i];
+        }
+        assert_Ns(occurrencesSum == VarArr->size(),
+                  "Ns_ConstrCountFlow::Ns_ConstrCountFlow: 'Occurrences' sum "
+                  "does not match 'VarArr' size");
+        varMatch.resize(VarArr->size());
+        std::fill(varMatch.begin(), varMatch.end(), UNMATCHED);
+        valueMatches.resize(values.size());
+        valueVisit.resize(values.size());
+}
+
+/// The index of the first value that may be an edge of the variable
+NsIndex Ns_ConstrCountFlow::firstValue(const NsIntVar& X) const
+{
+        return (lower_bound(values.begin(), values.end(), X.min()) -
+                values.begin());
+}
+
+/// Returns true if the v-th value is adjacent to the variable
+///
+/// The value should be between the bounds of the variable.
+bool Ns_ConstrCountFlow::isEdge(const NsIntVar& X, const NsIndex v) const
+{
+        return (boundsOnly || X.contains(values[v]));
+}
+
+void Ns_ConstrCountFlow::unmatch(const NsIndex x)
+{
+        NsDeque<NsIndex>& matches = valueMatches[varMatch[x]];
+        *find(matches.begin(), matches.end(), x) = matches.back();
+        matches.pop_back();
+        varMatch[x] = UNMATCHED;
+}
+
+/// Searches for an augmenting path that starts from the x-th variable
+///
+/// The variable should be unmatched, or matched to a visited value.
+bool Ns_ConstrCountFlow::augment(const NsIndex x)
+{
+        NsIntVar& X = (*VarArr)[x];
+        const NsIndex first = firstValue(X);
+        NsIndex v;
+        // A value with free occurrences is preferred
+        for (v = first; v < values.size() && values[v] <= X.max(); ++v) {
+                if (valueMatches[v].size() < occurrences[v] &&
+                    isEdge(X, v)) {
+                        if (varMatch[x] != UNMATCHED)
+                                unmatch(x);
+                        varMatch[x] = v;
+                        valueMatches[v].push_back(x);
+                        return true;
+                }
+        }
+        for (v = first; v < values.size() && values[v] <= X.max(); ++v) {
+                if (valueVisit[v] == nAugmentations || !isEdge(X, v))
+                        continue;
+                valueVisit[v] = nAugmentations;
+                // The variables of 'v' stay in place until one is moved
+                for (NsIndex i = 0; i < valueMatches[v].size(); ++i) {
+                        NsIndex y = valueMatches[v][i];
+                        if (augment(y)) {
+                                if (varMatch[x] != UNMATCHED)
+                                        unmatch(x);
+                                varMatch[x] = v;
+                                valueMatches[v].push_back(x);
+                                return true;
+                        }
+                }
+        }
+        return false;
+}
+
+/// Rematches the variables that have lost their matched values
+///
+/// Returns false if the occurrences cannot be satisfied.
+bool Ns_ConstrCountFlow::repairMatching(void)
+{
+        NsIndex x;
+        for (x = 0; x < VarArr->size(); ++x) {
+                NsIntVar& X = (*VarArr)[x];
+                if (varMatch[x] != UNMATCHED &&
+                    (values[varMatch[x]] < X.min() ||
+                     values[varMatch[x]] > X.max() ||
+                     !isEdge(X, varMatch[x])))
+                        unmatch(x);
+        }
+        for (x = 0; x < VarArr->size(); ++x) {
+                if (varMatch[x] == UNMATCHED) {
+                        ++nAugmentations;
+                        if (!augment(x))
+                                return false;
+                }
+        }
+        return true;
+}
+
+/// Removes the values that do not belong to any matching
+///
+/// The residual graph has an edge from each variable to its unmatched
+/// values and from each value to its matched variables. As all the
+/// variables are matched and all the occurrences are filled, an
+/// unmatched value is removed if it is not in the strongly connected
+/// component of the variable.
+///
+/// Returns true if a bound has been pruned in the interval relaxation.
+/// The new bound may leave out the values of the interval that the
+/// matching used, so the relaxation should then be revised again.
+bool Ns_ConstrCountFlow::removeUnmatchableValues(void)
+{
+        const NsIndex nVars = VarArr->size();
+        const NsIndex nNodes = nVars + values.size();
+        // The edges of each variable node
+        NsDeque<NsIndex> edgesBegin(nVars + 1), edges;
+        for (NsIndex x = 0; x < nVars; ++x) {
+                edgesBegin[x] = edges.size();
+                NsIntVar& X = (*VarArr)[x];
+                for (NsIndex v = firstValue(X);
+                     v < values.size() && values[v] <= X.max(); ++v) {
+                        if (v != varMatch[x] && isEdge(X, v))
+                                edges.push_back(nVars + v);
+                }
+        }
+        edgesBegin[nVars] = edges.size();
+        // Iterative Tarjan's algorithm
+        const NsIndex UNVISITED = static_cast<NsIndex>(-1);
+        NsDeque<NsIndex> order(nNodes), lowLink(nNodes), component(nNodes);
+        std::fill(order.begin(), order.end(), UNVISITED);
+        NsDeque<NsIndex> nextEdge(nNodes);
+        NsDeque<bool> onStack(nNodes);
+        NsDeque<NsIndex> stack, path;
+        NsIndex nVisited = 0, nComponents = 0;
+        for (NsIndex root = 0; root < nVars; ++root) {
+                if (order[root] != UNVISITED)
+                        continue;
+                path.push_back(root);
+                while (!path.empty()) {
+                        NsIndex node = path.back();
+                        if (order[node] == UNVISITED) {
+                                order[node] = lowLink[node] = nVisited++;
+                                nextEdge[node] = 0;
+                                stack.push_back(node);
+                                onStack[node] = true;
+                        }
+                        // The next successor of the node
+                        NsIndex succ = UNVISITED;
+                        if (node < nVars) {
+                                if (edgesBegin[node] + nextEdge[node] <
+                                    edgesBegin[node + 1])
+                                        succ = edges[edgesBegin[node] +
+                                                     nextEdge[node]];
+                        } else {
+                                const NsDeque<NsIndex>& matches =
+                                    valueMatches[node - nVars];
+                                if (nextEdge[node] < matches.size())
+                                        succ = matches[nextEdge[node]];
+                        }
+                        if (succ != UNVISITED) {
+                                ++nextEdge[node];
+                                if (order[succ] == UNVISITED)
+                                        path.push_back(succ);
+                                else if (onStack[succ] &&
+                                         order[succ] < lowLink[node])
+                                        lowLink[node] = order[succ];
+                                continue;
+                        }
+                        // All the successors have been examined
+                        path.pop_back();
+                        if (!path.empty() &&
+                            lowLink[node] < lowLink[path.back()])
+                                lowLink[path.back()] = lowLink[node];
+                        if (lowLink[node] == order[node]) {
+                                NsIndex member;
+                                do {
+                                        member = stack.back();
+                                        stack.pop_back();
+                                        onStack[member] = false;
+                                        component[member] = nComponents;
+                                } while (member != node);
+                                ++nComponents;
+                        }
+                }
+        }
+        NsDeque<NsInt> unmatchable;
+        bool prunedBound = false;
+        for (NsIndex x = 0; x < nVars; ++x) {
+                NsIntVar& X = (*VarArr)[x];
+                if (boundsOnly) {
+                        NsIntVar::const_iterator min = X.begin();
+                        while (min != X.end() && !matchable(x, *min, component))
+                                ++min;
+                        if (min == X.end()) {
+                                X.removeAll();
+                                return false;
+                        }
+                        NsIntVar::const_reverse_iterator max = X.rbegin();
+                        while (!matchable(x, *max, component))
+                                ++max;
+                        if (*min != X.min() || *max != X.max())
+                                prunedBound = true;
+                        if (!X.removeRange(NsMINUS_INF, *min - 1, this) ||
+                            !X.removeRange(*max + 1, NsPLUS_INF, this))
+                                return false;
+                        continue;
+                }
+                unmatchable.clear();
+                for (NsIntVar::const_iterator val = X.begin(); val != X.end();
+                     ++val) {
+                        if (!matchable(x, *val, component))
+                                unmatchable.push_back(*val);
+                }
+                for (NsDeque<NsInt>::const_iterator val = unmatchable.begin();
+                     val != unmatchable.end(); ++val) {
+                        if (!X.removeSingle(*val, this))
+                                return false;
+                }
+        }
+        return prunedBound;
+}
+
+/// Returns true if the edge of the x-th variable to 'val' belongs to
+/// the matching or to a strongly connected component
+bool Ns_ConstrCountFlow::matchable(const NsIndex x, const NsInt val,
+                                   const NsDeque<NsIndex>& component) const
+{
+        Ns_UNORDERED_MAP<NsInt, NsIndex>::const_iterator cit =
+            valueIndices.find(val);
+        if (cit == valueIndices.end())
+                return false;
+        return (cit->second == varMatch[x] ||
+                component[VarArr->size() + cit->second] == component[x]);
+}
+
+void Ns_ConstrCountFlow::ArcCons(void)
+{
+        // The modifications of the constraint do not wake it up, thus
+        // the bounds are revised until they stop changing
+        do {
+                if (!repairMatching()) {
+                        (*VarArr)[0].removeAll();
+                        return;
+                }
+        } while (removeUnmatchableValues());
+}
+
+/// The matching is repaired once for all the removed values
+void Ns_ConstrCountFlow::LocalArcCons(Ns_QueueItem& Qitem)
+{
+        if (boundsOnly || Qitem.lastRemovedValueFor(this))
+                ArcCons();
+}
+
 Ns_ConstrInverse::Ns_ConstrInverse(NsIntVarArray* VarArrInv_init,
                                    NsIntVarArray* VarArr_init)
   : VarArrInv(VarArrInv_init),
@@ -420,3 +713,1145 @@ void naxos::Ns_inverseConstraintToGraphFile(ofstream& fileConstraintsGraph,
                     << "\"];\n";
         }
 }
+
+const NsIndex Ns_ConstrCumulative::SHARED_VAR;
+
+Ns_ConstrCumulative::Ns_ConstrCumulative(NsIntVarArray* VarArr_init,
+                                         const NsDeque<NsInt>& Durations,
+                                         const NsDeque<NsInt>& Demands,
+                                         const NsInt capacity_init,
+                                         const bool edgeFinding_init)
+  : VarArr(VarArr_init),
+    durations(Durations),
+    demands(Demands),
+    capacity(capacity_init),
+    edgeFinding(edgeFinding_init),
+    profileStamp(0),
+    nProfileStamps(0),
+    builtProfileStamp(-1)
+{
+        assert_Ns(!VarArr->empty(), "Ns_ConstrCumulative::Ns_ConstrCumulative:"
+                                    " Condition required: !VarArr.empty()");
+        NsIntVarArray::iterator X = VarArr->begin();
+        NsProblemManager& pm = X->manager();
+        for (; X != VarArr->end(); ++X) {
+                assert_Ns(&pm == &X->manager(),
+                          "Ns_ConstrCumulative::Ns_ConstrCumulative: All the "
+                          "variables of a constraint must belong to the same "
+                          "NsProblemManager");
+        }
+        assert_Ns(durations.size() == VarArr->size() &&
+                      demands.size() == VarArr->size(),
+                  "Ns_ConstrCumulative::Ns_ConstrCumulative: 'Durations' and "
+                  "'Demands' sizes should match 'Starts' size");
+        for (NsIndex i = 0; i < VarArr->size(); ++i) {
+                assert_Ns(durations[i] >= 0 && demands[i] >= 0,
+                          "Ns_ConstrCumulative::Ns_ConstrCumulative: negative "
+                          "value in 'Durations' or 'Demands'");
+        }
+        assert_Ns(capacity >= 0, "Ns_ConstrCumulative::Ns_ConstrCumulative: "
+                                 "negative 'Capacity'");
+        est.resize(VarArr->size());
+        lct.resize(VarArr->size());
+        profiledStart.resize(VarArr->size());
+        profiledEnd.resize(VarArr->size());
+        for (NsIndex i = 0; i < VarArr->size(); ++i) {
+                Ns_pointer_t task = (Ns_pointer_t) & (*VarArr)[i];
+                if (!VarIndex.insert(make_pair(task, i)).second)
+                        VarIndex[task] = SHARED_VAR;
+        }
+        // Make 'lastSaveId' dirty as 'profileStamp' has not been saved
+        lastSaveId.id = NsUPLUS_INF;
+        lastSaveId.level = 0;
+}
+
+namespace {
+
+struct CompareByKey {
+
+        const NsDeque<NsInt>& key;
+
+        CompareByKey(const NsDeque<NsInt>& key_init) : key(key_init)
+        {
+        }
+
+        bool operator()(const NsIndex a, const NsIndex b) const
+        {
+                return (key[a] < key[b]);
+        }
+};
+
+/// Sorts the indices of 'order' by 'key'
+///
+/// An empty 'order' is filled with all the indices. Otherwise, it
+/// is assumed to be almost sorted from a previous call, and insertion
+/// sort is used.
+void sortByKey(NsDeque<NsIndex>& order, const NsDeque<NsInt>& key)
+{
+        if (order.empty()) {
+                for (NsIndex i = 0; i < key.size(); ++i)
+                        order.push_back(i);
+                sort(order.begin(), order.end(), CompareByKey(key));
+                return;
+        }
+        for (NsIndex k = 1; k < order.size(); ++k) {
+                NsIndex i = order[k];
+                NsIndex l = k;
+                for (; l > 0 && key[order[l - 1]] > key[i]; --l)
+                        order[l] = order[l - 1];
+                order[l] = i;
+        }
+}
+
+/// The number of the elements of 'order' whose 'key' is less than
+/// 'value', or less than or equal to it if 'inclusive'
+NsIndex countBefore(const NsDeque<NsIndex>& order, const NsDeque<NsInt>& key,
+                    const NsInt value, const bool inclusive)
+{
+        NsIndex low = 0, high = order.size();
+        while (low < high) {
+                NsIndex middle = (low + high) / 2;
+                if (key[order[middle]] < value ||
+                    (inclusive && key[order[middle]] == value))
+                        low = middle + 1;
+                else
+                        high = middle;
+        }
+        return low;
+}
+
+/// Removes the values outside the new bounds of the tasks that start
+/// at 'VarArr'
+///
+/// Sets 'modified' if a bound is pushed. Returns false if a domain
+/// is emptied.
+bool pruneTaskBounds(NsIntVarArray& VarArr, const NsDeque<NsInt>& durations,
+                     const NsDeque<NsInt>& est, const NsDeque<NsInt>& lct,
+                     const NsDeque<NsInt>& newEst,
+                     const NsDeque<NsInt>& newLct,
+                     const Ns_Constraint* constraint, bool& modified)
+{
+        for (NsIndex i = 0; i < VarArr.size(); ++i) {
+                if (newEst[i] > est[i]) {
+                        modified = true;
+                        if (!VarArr[i].removeRange(NsMINUS_INF, newEst[i] - 1,
+                                                   constraint))
+                                return false;
+                }
+                if (newLct[i] < lct[i]) {
+                        modified = true;
+                        if (!VarArr[i].removeRange(newLct[i] - durations[i] +
+                                                       1,
+                                                   NsPLUS_INF, constraint))
+                                return false;
+                }
+        }
+        return true;
+}
+
+/// Pushes the earliest start times of the cumulative tasks via
+/// edge-finding
+///
+/// A task should end after a set Omega of tasks, if they cannot
+/// all end before the latest completion time of Omega. Then the
+/// task starts after the energy of the subsets of the tasks that
+/// end before it leaves room for its demand. The detection needs
+/// O(n^2 log n) time and the updates O(kn^2), where k is the
+/// number of the distinct demands. Returns false on overload.
+bool cumulativeEdgeFinding(const NsDeque<NsInt>& est,
+                           const NsDeque<NsInt>& lct,
+                           const NsDeque<NsInt>& durations,
+                           const NsDeque<NsInt>& demands,
+                           const NsInt capacity, NsDeque<NsInt>& newEst)
+{
+        NsDeque<NsIndex> byEst, byLct;
+        NsDeque<NsInt> energy(est.size());
+        for (NsIndex i = 0; i < est.size(); ++i) {
+                energy[i] = durations[i] * demands[i];
+                if (energy[i] > 0) {
+                        byEst.push_back(i);
+                        byLct.push_back(i);
+                }
+        }
+        sort(byEst.begin(), byEst.end(), CompareByKey(est));
+        sort(byLct.begin(), byLct.end(), CompareByKey(lct));
+        const NsIndex m = byEst.size();
+        // The latest deadline of a set of tasks that precedes each task
+        NsDeque<NsInt> precedingLct(est.size());
+        fill(precedingLct.begin(), precedingLct.end(), NsMINUS_INF);
+        NsDeque<NsInt> suffixEnergy(m + 1), envelope(m);
+        NsIndex u, k;
+        for (u = 0; u < m; ++u) {
+                if (u + 1 < m && lct[byLct[u + 1]] == lct[byLct[u]])
+                        continue;
+                // Omega is the tasks that end until 'deadline'
+                const NsInt deadline = lct[byLct[u]];
+                suffixEnergy[m] = 0;
+                for (k = m; k > 0; --k) {
+                        NsIndex i = byEst[k - 1];
+                        suffixEnergy[k - 1] = suffixEnergy[k];
+                        if (lct[i] <= deadline)
+                                suffixEnergy[k - 1] += energy[i];
+                }
+                NsInt maxEnvelope = NsMINUS_INF;
+                for (k = 0; k < m; ++k) {
+                        if (suffixEnergy[k] > 0 &&
+                            capacity * est[byEst[k]] + suffixEnergy[k] >
+                                maxEnvelope)
+                                maxEnvelope = capacity * est[byEst[k]] +
+                                              suffixEnergy[k];
+                        envelope[k] = maxEnvelope;
+                }
+                if (maxEnvelope > capacity * deadline)
+                        return false;
+                for (k = u + 1; k < m; ++k) {
+                        NsIndex i = byLct[k];
+                        NsInt env =
+                            capacity * est[i] +
+                            suffixEnergy[countBefore(byEst, est, est[i],
+                                                     false)];
+                        NsIndex notAfter =
+                            countBefore(byEst, est, est[i], true);
+                        if (notAfter > 0 && envelope[notAfter - 1] > env)
+                                env = envelope[notAfter - 1];
+                        if (env + energy[i] > capacity * deadline)
+                                precedingLct[i] = deadline;
+                }
+        }
+        NsDeque<NsInt> detectedDemands;
+        for (k = 0; k < m; ++k) {
+                if (precedingLct[byEst[k]] != NsMINUS_INF)
+                        detectedDemands.push_back(demands[byEst[k]]);
+        }
+        sort(detectedDemands.begin(), detectedDemands.end());
+        detectedDemands.erase(
+            unique(detectedDemands.begin(), detectedDemands.end()),
+            detectedDemands.end());
+        // The update for each demand and each prefix of 'byLct'
+        NsDeque<NsInt> update(m);
+        for (NsDeque<NsInt>::const_iterator c = detectedDemands.begin();
+             c != detectedDemands.end(); ++c) {
+                NsInt maxUpdate = NsMINUS_INF;
+                for (u = 0; u < m; ++u) {
+                        const NsInt deadline = lct[byLct[u]];
+                        NsInt sumEnergy = 0;
+                        for (k = m; k > 0; --k) {
+                                NsIndex i = byEst[k - 1];
+                                if (lct[i] > deadline)
+                                        continue;
+                                sumEnergy += energy[i];
+                                NsInt rest =
+                                    sumEnergy -
+                                    (capacity - *c) * (deadline - est[i]);
+                                if (rest > 0 &&
+                                    est[i] + (rest + *c - 1) / *c > maxUpdate)
+                                        maxUpdate =
+                                            est[i] + (rest + *c - 1) / *c;
+                        }
+                        update[u] = maxUpdate;
+                }
+                for (k = 0; k < m; ++k) {
+                        NsIndex i = byEst[k];
+                        if (demands[i] != *c ||
+                            precedingLct[i] == NsMINUS_INF)
+                                continue;
+                        NsInt upd = update[countBefore(byLct, lct,
+                                                       precedingLct[i], true) -
+                                           1];
+                        if (upd > newEst[i])
+                                newEst[i] = upd;
+                }
+        }
+        return true;
+}
+
+} // end namespace
+
+/// The compulsory part [start, end) of the i-th task, or [0, 0) if
+/// it is empty or consumes nothing
+void Ns_ConstrCumulative::compulsoryPart(const NsIndex i, NsInt& start,
+                                         NsInt& end) const
+{
+        start = lct[i] - durations[i];
+        end = est[i] + durations[i];
+        if (demands[i] == 0 || start >= end)
+                start = end = 0;
+}
+
+/// Sweeps the compulsory parts of the tasks to build the profile
+///
+/// The orders of the tasks are repaired by insertion sort, in O(n)
+/// time plus the number of the tasks that have overtaken each other
+/// since the previous revision. Returns false if the profile exceeds
+/// the capacity.
+bool Ns_ConstrCumulative::buildProfile(void)
+{
+        const NsIndex n = VarArr->size();
+        NsDeque<NsInt> compulsoryStart(n), compulsoryEnd(n);
+        NsDeque<bool> compulsory(n);
+        for (NsIndex i = 0; i < n; ++i) {
+                compulsoryPart(i, compulsoryStart[i], compulsoryEnd[i]);
+                compulsory[i] = (compulsoryStart[i] < compulsoryEnd[i]);
+        }
+        sortByKey(byCompulsoryStart, compulsoryStart);
+        sortByKey(byCompulsoryEnd, compulsoryEnd);
+        profile.clear();
+        // Until recordProfile(), the profile may not match any stamp
+        builtProfileStamp = -1;
+        NsInt height = 0, time = NsMINUS_INF;
+        NsIndex s = 0, e = 0;
+        for (;;) {
+                while (s < n && !compulsory[byCompulsoryStart[s]])
+                        ++s;
+                while (e < n && !compulsory[byCompulsoryEnd[e]])
+                        ++e;
+                // Every compulsory part that has started has also ended
+                if (e == n)
+                        return true;
+                NsInt next = compulsoryEnd[byCompulsoryEnd[e]];
+                if (s < n && compulsoryStart[byCompulsoryStart[s]] < next)
+                        next = compulsoryStart[byCompulsoryStart[s]];
+                // The segments are not merged, so that each one is either
+                // inside or outside a compulsory part
+                if (height > 0)
+                        profile.push_back(Segment_t(time, next, height));
+                for (; s < n; ++s) {
+                        NsIndex i = byCompulsoryStart[s];
+                        if (!compulsory[i])
+                                continue;
+                        if (compulsoryStart[i] != next)
+                                break;
+                        height += demands[i];
+                }
+                for (; e < n; ++e) {
+                        NsIndex i = byCompulsoryEnd[e];
+                        if (!compulsory[i])
+                                continue;
+                        if (compulsoryEnd[i] != next)
+                                break;
+                        height -= demands[i];
+                }
+                if (height > capacity)
+                        return false;
+                time = next;
+        }
+}
+
+/// Records the compulsory parts for which the profile has been built
+///
+/// The profile is then reused while the compulsory parts, and thus
+/// 'profileStamp', do not change.
+void Ns_ConstrCumulative::recordProfile(void)
+{
+        NsProblemManager& pm = (*VarArr)[0].manager();
+        bool changed = false;
+        for (NsIndex i = 0; i < VarArr->size(); ++i) {
+                NsInt start, end;
+                compulsoryPart(i, start, end);
+                if (start != profiledStart[i] || end != profiledEnd[i]) {
+                        pm.saveValue(profiledStart[i]);
+                        pm.saveValue(profiledEnd[i]);
+                        profiledStart[i] = start;
+                        profiledEnd[i] = end;
+                        changed = true;
+                }
+        }
+        if (changed) {
+                if (!pm.isCurrentHistoryId(lastSaveId)) {
+                        pm.saveValue(profileStamp);
+                        lastSaveId = pm.getCurrentHistoryId();
+                }
+                profileStamp = ++nProfileStamps;
+        }
+        builtProfileStamp = profileStamp;
+}
+
+/// Pushes the i-th task out of the segments of the profile where it
+/// does not fit
+///
+/// It takes O(log s) time, where s is the number of the segments, plus
+/// the segments that the task is pushed over. Returns false if the
+/// task fits nowhere.
+bool Ns_ConstrCumulative::pushOutOfProfile(const NsIndex i, NsInt& newEst,
+                                           NsInt& newLct) const
+{
+        const NsInt p = durations[i];
+        const NsInt c = demands[i];
+        newEst = est[i];
+        newLct = lct[i];
+        if (p == 0 || c == 0 || est[i] == lct[i] - p)
+                return true;
+        // The own compulsory part is not taken into account
+        const NsInt ownStart = lct[i] - p;
+        const NsInt ownEnd = est[i] + p;
+        NsIndex low = 0, high = profile.size();
+        // The first segment that ends after the earliest start
+        while (low < high) {
+                NsIndex middle = (low + high) / 2;
+                if (profile[middle].end <= est[i])
+                        low = middle + 1;
+                else
+                        high = middle;
+        }
+        NsInt t = est[i];
+        for (NsIndex j = low; j < profile.size() && profile[j].start < t + p;
+             ++j) {
+                NsInt own = (profile[j].start >= ownStart &&
+                             profile[j].end <= ownEnd)
+                                ? c
+                                : 0;
+                if (profile[j].height - own + c > capacity) {
+                        t = profile[j].end;
+                        if (t > lct[i] - p)
+                                return false;
+                }
+        }
+        newEst = t;
+        // The segments that start before the latest completion
+        high = profile.size();
+        while (low < high) {
+                NsIndex middle = (low + high) / 2;
+                if (profile[middle].start < lct[i])
+                        low = middle + 1;
+                else
+                        high = middle;
+        }
+        t = lct[i];
+        for (NsIndex j = low; j > 0 && profile[j - 1].end > t - p; --j) {
+                NsInt own = (profile[j - 1].start >= ownStart &&
+                             profile[j - 1].end <= ownEnd)
+                                ? c
+                                : 0;
+                if (profile[j - 1].height - own + c > capacity) {
+                        t = profile[j - 1].start;
+                        if (t < est[i] + p)
+                                return false;
+                }
+        }
+        newLct = t;
+        return true;
+}
+
+/// Pushes each task out of the segments of the profile where it does
+/// not fit
+bool Ns_ConstrCumulative::timeTable(bool& modified)
+{
+        if (!buildProfile()) {
+                (*VarArr)[0].removeAll();
+                return false;
+        }
+        NsDeque<NsInt> newEst(est), newLct(lct);
+        for (NsIndex i = 0; i < VarArr->size(); ++i) {
+                if (!pushOutOfProfile(i, newEst[i], newLct[i])) {
+                        (*VarArr)[i].removeAll();
+                        return false;
+                }
+        }
+        return pruneTaskBounds(*VarArr, durations, est, lct, newEst, newLct,
+                               this, modified);
+}
+
+/// Applies edge-finding to the starts and, symmetrically, to the ends
+bool Ns_ConstrCumulative::edgeFind(bool& modified)
+{
+        const NsIndex n = VarArr->size();
+        NsDeque<NsInt> newEst(est);
+        if (!cumulativeEdgeFinding(est, lct, durations, demands, capacity,
+                                   newEst)) {
+                (*VarArr)[0].removeAll();
+                return false;
+        }
+        // The mirrored tasks run backwards in time
+        NsDeque<NsInt> mirroredEst(n), mirroredLct(n);
+        for (NsIndex i = 0; i < n; ++i) {
+                mirroredEst[i] = -lct[i];
+                mirroredLct[i] = -est[i];
+        }
+        NsDeque<NsInt> newMirroredEst(mirroredEst);
+        if (!cumulativeEdgeFinding(mirroredEst, mirroredLct, durations,
+                                   demands, capacity, newMirroredEst)) {
+                (*VarArr)[0].removeAll();
+                return false;
+        }
+        NsDeque<NsInt> newLct(n);
+        for (NsIndex i = 0; i < n; ++i)
+                newLct[i] = -newMirroredEst[i];
+        return pruneTaskBounds(*VarArr, durations, est, lct, newEst, newLct,
+                               this, modified);
+}
+
+void Ns_ConstrCumulative::ArcCons(void)
+{
+        bool modified;
+        do {
+                modified = false;
+                for (NsIndex i = 0; i < VarArr->size(); ++i) {
+                        if (durations[i] > 0 && demands[i] > capacity) {
+                                (*VarArr)[i].removeAll();
+                                return;
+                        }
+                        est[i] = (*VarArr)[i].min();
+                        lct[i] = (*VarArr)[i].max() + durations[i];
+                }
+                if (!timeTable(modified))
+                        return;
+                if (edgeFinding && !modified) {
+                        if (!edgeFind(modified))
+                                return;
+                }
+        } while (modified);
+        // The last profile has been built for the current bounds
+        recordProfile();
+}
+
+/// Pushes only the modified task, if its compulsory part is the same
+/// as in the profile of the current search node
+///
+/// Edge-finding depends on the bounds of all the tasks, so it needs a
+/// full revision.
+void Ns_ConstrCumulative::LocalArcCons(Ns_QueueItem& Qitem)
+{
+        NsIndex i = VarIndex[(Ns_pointer_t)Qitem.getVarFired()];
+        if (edgeFinding || builtProfileStamp != profileStamp ||
+            i == SHARED_VAR) {
+                ArcCons();
+                return;
+        }
+        NsIntVar& X = (*VarArr)[i];
+        for (;;) {
+                est[i] = X.min();
+                lct[i] = X.max() + durations[i];
+                NsInt start, end;
+                compulsoryPart(i, start, end);
+                if (start != profiledStart[i] || end != profiledEnd[i]) {
+                        ArcCons();
+                        return;
+                }
+                NsInt newEst, newLct;
+                if (!pushOutOfProfile(i, newEst, newLct)) {
+                        X.removeAll();
+                        return;
+                }
+                if (newEst == est[i] && newLct == lct[i])
+                        return;
+                // The new bounds may lie in other segments, due to holes
+                if (!X.removeRange(NsMINUS_INF, newEst - 1, this) ||
+                    !X.removeRange(newLct - durations[i] + 1, NsPLUS_INF,
+                                   this))
+                        return;
+        }
+}
+
+Ns_ConstrDisjunctive::Ns_ConstrDisjunctive(NsIntVarArray* VarArr_init,
+                                           const NsDeque<NsInt>& Durations)
+  : VarArr(VarArr_init), durations(Durations)
+{
+        assert_Ns(VarArr->size() >= 2,
+                  "Ns_ConstrDisjunctive::Ns_ConstrDisjunctive: Condition "
+                  "required: VarArr.size() >= 2");
+        NsIntVarArray::iterator X = VarArr->begin();
+        NsProblemManager& pm = X->manager();
+        for (; X != VarArr->end(); ++X) {
+                assert_Ns(&pm == &X->manager(),
+                          "Ns_ConstrDisjunctive::Ns_ConstrDisjunctive: All "
+                          "the variables of a constraint must belong to the "
+                          "same NsProblemManager");
+        }
+        assert_Ns(durations.size() == VarArr->size(),
+                  "Ns_ConstrDisjunctive::Ns_ConstrDisjunctive: 'Durations' "
+                  "size should match 'Starts' size");
+        for (NsIndex i = 0; i < VarArr->size(); ++i) {
+                assert_Ns(durations[i] >= 0,
+                          "Ns_ConstrDisjunctive::Ns_ConstrDisjunctive: "
+                          "negative value in 'Durations'");
+                if (durations[i] == 0)
+                        instantTasks.push_back(i);
+        }
+        est.resize(VarArr->size());
+        lct.resize(VarArr->size());
+}
+
+namespace {
+
+/// A balanced binary tree, whose leaves are the tasks sorted by their
+/// earliest start times
+///
+/// It computes the earliest completion time of a set Theta of the
+/// tasks, and of Theta together with at most one of the gray tasks of
+/// a set Lambda. Each operation costs O(log n).
+class ThetaLambdaTree {
+
+    private:
+        struct Node_t {
+
+                /// The sum of the durations of the Theta tasks
+                NsInt duration;
+
+                /// The earliest completion time of the Theta tasks
+                NsInt ect;
+
+                /// The above values, if a gray task is included
+                NsInt grayDuration;
+                NsInt grayEct;
+        };
+
+        NsDeque<Node_t> nodes;
+
+        NsIndex firstLeaf;
+
+        const NsDeque<NsInt>& est;
+
+        const NsDeque<NsInt>& durations;
+
+        /// The leaf of each task and the task of each leaf
+        NsDeque<NsIndex> leafOf, taskOf;
+
+        void setLeaf(const NsIndex i, const NsInt duration, const NsInt ect,
+                     const NsInt grayDuration, const NsInt grayEct)
+        {
+                NsIndex v = leafOf[i];
+                nodes[v].duration = duration;
+                nodes[v].ect = ect;
+                nodes[v].grayDuration = grayDuration;
+                nodes[v].grayEct = grayEct;
+                for (v /= 2; v > 0; v /= 2) {
+                        const Node_t& l = nodes[2 * v];
+                        const Node_t& r = nodes[2 * v + 1];
+                        nodes[v].duration = l.duration + r.duration;
+                        nodes[v].ect = max(r.ect, l.ect + r.duration);
+                        nodes[v].grayDuration =
+                            max(l.grayDuration + r.duration,
+                                l.duration + r.grayDuration);
+                        nodes[v].grayEct =
+                            max(r.grayEct, max(l.ect + r.grayDuration,
+                                               l.grayEct + r.duration));
+                }
+        }
+
+    public:
+        ThetaLambdaTree(const NsDeque<NsIndex>& byEst,
+                        const NsDeque<NsInt>& est_init,
+                        const NsDeque<NsInt>& durations_init)
+          : firstLeaf(1), est(est_init), durations(durations_init)
+        {
+                while (firstLeaf < byEst.size())
+                        firstLeaf *= 2;
+                Node_t empty;
+                empty.duration = empty.grayDuration = 0;
+                empty.ect = empty.grayEct = NsMINUS_INF;
+                nodes.resize(2 * firstLeaf);
+                std::fill(nodes.begin(), nodes.end(), empty);
+                leafOf.resize(est.size());
+                taskOf = byEst;
+                for (NsIndex k = 0; k < byEst.size(); ++k)
+                        leafOf[byEst[k]] = firstLeaf + k;
+        }
+
+        void insert(const NsIndex i)
+        {
+                setLeaf(i, durations[i], est[i] + durations[i], durations[i],
+                        est[i] + durations[i]);
+        }
+
+        void makeGray(const NsIndex i)
+        {
+                setLeaf(i, 0, NsMINUS_INF, durations[i],
+                        est[i] + durations[i]);
+        }
+
+        void remove(const NsIndex i)
+        {
+                setLeaf(i, 0, NsMINUS_INF, 0, NsMINUS_INF);
+        }
+
+        bool contains(const NsIndex i) const
+        {
+                return (nodes[leafOf[i]].ect != NsMINUS_INF);
+        }
+
+        NsInt ect(void) const
+        {
+                return nodes[1].ect;
+        }
+
+        NsInt grayEct(void) const
+        {
+                return nodes[1].grayEct;
+        }
+
+        /// The earliest completion time of Theta without the i-th task
+        NsInt ectWithout(const NsIndex i)
+        {
+                if (!contains(i))
+                        return ect();
+                remove(i);
+                NsInt result = ect();
+                insert(i);
+                return result;
+        }
+
+        /// The gray task that gives grayEct(), if it exceeds ect()
+        NsIndex responsibleGray(void) const
+        {
+                NsIndex v = 1;
+                bool forDuration = false;
+                while (v < firstLeaf) {
+                        const Node_t& l = nodes[2 * v];
+                        const Node_t& r = nodes[2 * v + 1];
+                        if (forDuration) {
+                                v = (nodes[v].grayDuration ==
+                                     l.grayDuration + r.duration)
+                                        ? 2 * v
+                                        : 2 * v + 1;
+                        } else if (nodes[v].grayEct == r.grayEct) {
+                                v = 2 * v + 1;
+                        } else if (nodes[v].grayEct ==
+                                   l.ect + r.grayDuration) {
+                                v = 2 * v + 1;
+                                forDuration = true;
+                        } else {
+                                v = 2 * v;
+                        }
+                }
+                return taskOf[v - firstLeaf];
+        }
+};
+
+/// Pushes the bounds of the disjunctive tasks
+///
+/// Edge-finding and detectable precedences push the earliest start
+/// times and not-last pushes the latest completion times. The mirrored
+/// tasks give the rest of the rules. Returns false on overload.
+bool disjunctiveFiltering(const NsDeque<NsInt>& est,
+                          const NsDeque<NsInt>& lct,
+                          const NsDeque<NsInt>& durations,
+                          NsDeque<NsInt>& newEst, NsDeque<NsInt>& newLct)
+{
+        NsDeque<NsIndex> byEst, byLct, byLst, byEct;
+        NsDeque<NsInt> lst(est.size()), ect(est.size());
+        for (NsIndex i = 0; i < est.size(); ++i) {
+                lst[i] = lct[i] - durations[i];
+                ect[i] = est[i] + durations[i];
+                if (durations[i] > 0) {
+                        byEst.push_back(i);
+                        byLct.push_back(i);
+                        byLst.push_back(i);
+                        byEct.push_back(i);
+                }
+        }
+        sort(byEst.begin(), byEst.end(), CompareByKey(est));
+        sort(byLct.begin(), byLct.end(), CompareByKey(lct));
+        sort(byLst.begin(), byLst.end(), CompareByKey(lst));
+        sort(byEct.begin(), byEct.end(), CompareByKey(ect));
+        const NsIndex m = byEst.size();
+        NsIndex k, q;
+        // Overload checking and edge-finding: Theta is the tasks that end
+        // until lct[j], and Lambda the tasks that end after them
+        ThetaLambdaTree tree(byEst, est, durations);
+        for (k = 0; k < m; ++k)
+                tree.insert(byLct[k]);
+        for (k = m; k > 0; --k) {
+                NsIndex j = byLct[k - 1];
+                if (tree.ect() > lct[j])
+                        return false;
+                while (tree.grayEct() > lct[j]) {
+                        NsIndex i = tree.responsibleGray();
+                        if (tree.ect() > newEst[i])
+                                newEst[i] = tree.ect();
+                        tree.remove(i);
+                }
+                tree.makeGray(j);
+        }
+        // Detectable precedences: Theta is the tasks that should
+        // precede the i-th task, as they start before it can end
+        ThetaLambdaTree precedences(byEst, est, durations);
+        for (k = 0, q = 0; k < m; ++k) {
+                NsIndex i = byEct[k];
+                for (; q < m && ect[i] > lst[byLst[q]]; ++q)
+                        precedences.insert(byLst[q]);
+                NsInt ectOthers = precedences.ectWithout(i);
+                if (ectOthers > newEst[i])
+                        newEst[i] = ectOthers;
+        }
+        // Not-last: Theta is the tasks that start before the i-th task
+        // ends; if they end after it starts, it ends before one of them
+        ThetaLambdaTree notLast(byEst, est, durations);
+        NsIndex lastInserted = 0;
+        for (k = 0, q = 0; k < m; ++k) {
+                NsIndex i = byLct[k];
+                for (; q < m && lct[i] > lst[byLst[q]]; ++q) {
+                        lastInserted = byLst[q];
+                        notLast.insert(lastInserted);
+                }
+                if (notLast.ectWithout(i) > lst[i] &&
+                    lst[lastInserted] < newLct[i])
+                        newLct[i] = lst[lastInserted];
+        }
+        return true;
+}
+
+} // end namespace
+
+void Ns_ConstrDisjunctive::ArcCons(void)
+{
+        const NsIndex n = VarArr->size();
+        NsDeque<NsInt> mirroredEst(n), mirroredLct(n);
+        bool modified;
+        do {
+                for (NsIndex i = 0; i < n; ++i) {
+                        est[i] = (*VarArr)[i].min();
+                        lct[i] = (*VarArr)[i].max() + durations[i];
+                        // The mirrored tasks run backwards in time
+                        mirroredEst[i] = -lct[i];
+                        mirroredLct[i] = -est[i];
+                }
+                NsDeque<NsInt> newEst(est), newLct(lct);
+                NsDeque<NsInt> newMirroredEst(mirroredEst),
+                    newMirroredLct(mirroredLct);
+                if (!disjunctiveFiltering(est, lct, durations, newEst,
+                                          newLct) ||
+                    !disjunctiveFiltering(mirroredEst, mirroredLct, durations,
+                                          newMirroredEst, newMirroredLct)) {
+                        (*VarArr)[0].removeAll();
+                        return;
+                }
+                for (NsIndex i = 0; i < n; ++i) {
+                        newEst[i] = max(newEst[i], -newMirroredLct[i]);
+                        newLct[i] = min(newLct[i], -newMirroredEst[i]);
+                }
+                modified = false;
+                if (!pruneTaskBounds(*VarArr, durations, est, lct, newEst,
+                                     newLct, this, modified) ||
+                    !pruneInstantTasks(modified))
+                        return;
+        } while (modified);
+}
+
+/// Keeps each task of zero duration from starting strictly inside
+/// another task, as the pairwise disjunctions do
+///
+/// Such a task cannot start inside the compulsory part of another
+/// task, and the other task cannot cover all its possible starts.
+/// It costs O(zn) time, where z is the number of the tasks of zero
+/// duration. Returns false if a domain is emptied.
+bool Ns_ConstrDisjunctive::pruneInstantTasks(bool& modified)
+{
+        for (NsIndex k = 0; k < instantTasks.size(); ++k) {
+                NsIntVar& Instant = (*VarArr)[instantTasks[k]];
+                for (NsIndex j = 0; j < VarArr->size(); ++j) {
+                        if (durations[j] == 0)
+                                continue;
+                        NsIntVar& Task = (*VarArr)[j];
+                        // The compulsory part [lst, ect) runs for
+                        // any start of the task
+                        NsInt lst = Task.max();
+                        NsInt ect = Task.min() + durations[j];
+                        if (lst + 1 < ect &&
+                            !Instant.removeRange(lst + 1, ect - 1, this,
+                                                 modified))
+                                return false;
+                        // The starts that would cover the whole domain
+                        NsInt first = Instant.max() - durations[j] + 1;
+                        NsInt last = Instant.min() - 1;
+                        if (first <= last &&
+                            !Task.removeRange(first, last, this, modified))
+                                return false;
+                }
+        }
+        return true;
+}
+
+void Ns_ConstrDisjunctive::LocalArcCons(Ns_QueueItem& /*Qitem*/)
+{
+        ArcCons();
+}
+
+Ns_ConstrDiffn::Ns_ConstrDiffn(NsIntVarArray* VarArrX_init,
+                               NsIntVarArray* VarArrY_init,
+                               const NsDeque<NsInt>& Widths,
+                               const NsDeque<NsInt>& Heights)
+  : VarArrX(VarArrX_init), VarArrY(VarArrY_init), atFixpoint(false)
+{
+        const NsIndex n = VarArrX->size();
+        assert_Ns(n >= 2 && VarArrY->size() == n && Widths.size() == n &&
+                      Heights.size() == n,
+                  "Ns_ConstrDiffn::Ns_ConstrDiffn: Condition required: "
+                  "'X', 'Y', 'Widths' and 'Heights' should have the same "
+                  "size, which is >= 2");
+        NsProblemManager& pm = (*VarArrX)[0].manager();
+        for (NsIndex i = 0; i < n; ++i) {
+                assert_Ns(&pm == &(*VarArrX)[i].manager() &&
+                              &pm == &(*VarArrY)[i].manager(),
+                          "Ns_ConstrDiffn::Ns_ConstrDiffn: All the variables "
+                          "of a constraint must belong to the same "
+                          "NsProblemManager");
+                assert_Ns(Widths[i] >= 0 && Heights[i] >= 0,
+                          "Ns_ConstrDiffn::Ns_ConstrDiffn: negative value in "
+                          "'Widths' or 'Heights'");
+        }
+        sizes[0] = Widths;
+        sizes[1] = Heights;
+        for (int d = 0; d < 2; ++d) {
+                lo[d].resize(n);
+                hi[d].resize(n);
+        }
+}
+
+void Ns_ConstrDiffn::toGraphFile(ofstream& fileConstraintsGraph) const
+{
+        Ns_arrayConstraintToGraphFile(fileConstraintsGraph, VarArrX, this,
+                                      "diffn");
+        for (NsIntVarArray::const_iterator V = VarArrY->begin();
+             V != VarArrY->end(); ++V) {
+                fileConstraintsGraph << "\tVar" << &*V << " -> Constr" << this
+                                     << " [arrowhead=none, style=dotted];\n";
+        }
+}
+
+namespace {
+
+/// Counts how many forbidden regions cover each segment of a range
+///
+/// The range is split at the given sorted points into segments. Each
+/// region is added or removed in O(log m) time, where m is the number
+/// of the segments, and whether the whole range is covered is known
+/// in constant time.
+class CoverTree {
+
+    private:
+        /// The first value of each segment, and the end of the range
+        const NsDeque<NsInt>& points;
+
+        /// The regions that cover the whole segment of each node, and
+        /// the minimum number of regions that cover a value below it
+        NsDeque<NsInt> cover, minCover;
+
+        void add(const NsIndex v, const NsIndex l, const NsIndex r,
+                 const NsIndex first, const NsIndex end, const NsInt delta)
+        {
+                if (end <= l || r <= first)
+                        return;
+                if (first <= l && r <= end) {
+                        cover[v] += delta;
+                } else {
+                        NsIndex middle = (l + r) / 2;
+                        add(2 * v, l, middle, first, end, delta);
+                        add(2 * v + 1, middle, r, first, end, delta);
+                }
+                minCover[v] = cover[v];
+                if (r - l > 1)
+                        minCover[v] +=
+                            min(minCover[2 * v], minCover[2 * v + 1]);
+        }
+
+        NsIndex segmentOf(const NsInt value) const
+        {
+                return (lower_bound(points.begin(), points.end(), value) -
+                        points.begin());
+        }
+
+    public:
+        CoverTree(const NsDeque<NsInt>& points_init)
+          : points(points_init),
+            cover(4 * points.size()),
+            minCover(4 * points.size())
+        {
+        }
+
+        /// Adds 'delta' times the region [first, last], which should
+        /// start and end at the points
+        void add(const NsInt first, const NsInt last, const NsInt delta)
+        {
+                add(1, 0, points.size() - 1, segmentOf(first),
+                    segmentOf(last + 1), delta);
+        }
+
+        bool covered(void) const
+        {
+                return (minCover[1] > 0);
+        }
+};
+
+/// Pushes the minimum origins of the rectangles in the dimension 'd'
+///
+/// The compulsory part of a rectangle forbids a region for the origin
+/// of another one. For each rectangle, the line of its minimum origin
+/// in 'd' is swept over the events where the k forbidden regions that
+/// meet its bounds start or end, while they cover the whole range of
+/// the origin in the other dimension. A CoverTree keeps the coverage,
+/// so each rectangle costs O(k log k) time. Returns false if a
+/// rectangle does not fit.
+bool diffnSweepMin(const NsDeque<NsInt> lo[2], const NsDeque<NsInt> hi[2],
+                   const NsDeque<NsInt> sizes[2], const int d,
+                   NsDeque<NsInt>& newLo)
+{
+        const int e = 1 - d;
+        const NsIndex n = sizes[0].size();
+        NsDeque<NsIndex> compulsory;
+        NsDeque<NsInt> compulsoryEnd(n);
+        NsInt maxLength = 0;
+        NsIndex i, j, k;
+        for (i = 0; i < n; ++i) {
+                compulsoryEnd[i] = lo[d][i] + sizes[d][i];
+                if (sizes[0][i] > 0 && sizes[1][i] > 0 &&
+                    hi[0][i] < lo[0][i] + sizes[0][i] &&
+                    hi[1][i] < lo[1][i] + sizes[1][i]) {
+                        compulsory.push_back(i);
+                        maxLength =
+                            max(maxLength, compulsoryEnd[i] - hi[d][i]);
+                }
+        }
+        if (compulsory.empty())
+                return true;
+        // The compulsory parts start at the maximum origins
+        sort(compulsory.begin(), compulsory.end(), CompareByKey(hi[d]));
+        NsDeque<NsIndex> byStart, byEnd;
+        NsDeque<NsInt> points;
+        for (j = 0; j < n; ++j) {
+                if (sizes[d][j] == 0 || sizes[e][j] == 0)
+                        continue;
+                // The forbidden regions that meet the bounds of j, in
+                // the order of their starts
+                byStart.clear();
+                points.clear();
+                points.push_back(lo[e][j]);
+                points.push_back(hi[e][j] + 1);
+                for (k = countBefore(compulsory, hi[d],
+                                     lo[d][j] - maxLength + 1, false);
+                     k < compulsory.size() &&
+                     hi[d][compulsory[k]] <= hi[d][j] + sizes[d][j] - 1;
+                     ++k) {
+                        i = compulsory[k];
+                        if (i != j && compulsoryEnd[i] - 1 >= lo[d][j] &&
+                            hi[e][i] - sizes[e][j] + 1 <= hi[e][j] &&
+                            lo[e][i] + sizes[e][i] - 1 >= lo[e][j]) {
+                                byStart.push_back(i);
+                                points.push_back(max(
+                                    hi[e][i] - sizes[e][j] + 1, lo[e][j]));
+                                points.push_back(
+                                    min(lo[e][i] + sizes[e][i], hi[e][j] + 1));
+                        }
+                }
+                sort(points.begin(), points.end());
+                points.erase(unique(points.begin(), points.end()),
+                             points.end());
+                byEnd = byStart;
+                sort(byEnd.begin(), byEnd.end(), CompareByKey(compulsoryEnd));
+                CoverTree tree(points);
+                NsInt origin = lo[d][j];
+                NsIndex s = 0, t = 0;
+                for (;;) {
+                        for (; s < byStart.size() &&
+                               hi[d][byStart[s]] - sizes[d][j] + 1 <= origin;
+                             ++s) {
+                                i = byStart[s];
+                                tree.add(
+                                    max(hi[e][i] - sizes[e][j] + 1, lo[e][j]),
+                                    min(lo[e][i] + sizes[e][i] - 1, hi[e][j]),
+                                    +1);
+                        }
+                        for (; t < byEnd.size() &&
+                               compulsoryEnd[byEnd[t]] - 1 < origin;
+                             ++t) {
+                                i = byEnd[t];
+                                tree.add(
+                                    max(hi[e][i] - sizes[e][j] + 1, lo[e][j]),
+                                    min(lo[e][i] + sizes[e][i] - 1, hi[e][j]),
+                                    -1);
+                        }
+                        if (!tree.covered())
+                                break;
+                        // The regions cover the origin at least until
+                        // the first of them that has not been removed
+                        // ends
+                        origin = compulsoryEnd[byEnd[t]];
+                        if (origin > hi[d][j])
+                                return false;
+                }
+                newLo[j] = origin;
+        }
+        return true;
+}
+
+} // end namespace
+
+void Ns_ConstrDiffn::ArcCons(void)
+{
+        NsIntVarArray* VarArr[2] = {VarArrX, VarArrY};
+        const NsIndex n = sizes[0].size();
+        NsDeque<NsInt> mirroredLo[2], mirroredHi[2];
+        bool modified;
+        // Until the fixpoint, 'lo' and 'hi' may not match the bounds
+        atFixpoint = false;
+        do {
+                for (int d = 0; d < 2; ++d) {
+                        for (NsIndex i = 0; i < n; ++i) {
+                                lo[d][i] = (*VarArr[d])[i].min();
+                                hi[d][i] = (*VarArr[d])[i].max();
+                        }
+                }
+                modified = false;
+                for (int d = 0; d < 2; ++d) {
+                        NsDeque<NsInt> newLo(lo[d]);
+                        // The mirrored rectangles have their origins at
+                        // the opposite corners in 'd'
+                        mirroredLo[d].resize(n);
+                        mirroredHi[d].resize(n);
+                        mirroredLo[1 - d] = lo[1 - d];
+                        mirroredHi[1 - d] = hi[1 - d];
+                        for (NsIndex i = 0; i < n; ++i) {
+                                mirroredLo[d][i] = -hi[d][i] - sizes[d][i];
+                                mirroredHi[d][i] = -lo[d][i] - sizes[d][i];
+                        }
+                        NsDeque<NsInt> newMirroredLo(mirroredLo[d]);
+                        if (!diffnSweepMin(lo, hi, sizes, d, newLo) ||
+                            !diffnSweepMin(mirroredLo, mirroredHi, sizes, d,
+                                           newMirroredLo)) {
+                                (*VarArr[d])[0].removeAll();
+                                return;
+                        }
+                        for (NsIndex i = 0; i < n; ++i) {
+                                NsIntVar& V = (*VarArr[d])[i];
+                                if (newLo[i] > lo[d][i]) {
+                                        modified = true;
+                                        if (!V.removeRange(NsMINUS_INF,
+                                                           newLo[i] - 1, this))
+                                                return;
+                                }
+                                NsInt newHi =
+                                    -newMirroredLo[i] - sizes[d][i];
+                                if (newHi < hi[d][i]) {
+                                        modified = true;
+                                        if (!V.removeRange(newHi + 1,
+                                                           NsPLUS_INF, this))
+                                                return;
+                                }
+                        }
+                }
+        } while (modified);
+        atFixpoint = true;
+}
+
+/// Revises the constraint, unless the bounds are the same as in the
+/// fixpoint of the last revision
+///
+/// The revision depends only on the bounds. Thus, when many origins
+/// are modified at once, the first of their queue items revises the
+/// constraint for all of them, and the others cost O(n) time.
+void Ns_ConstrDiffn::LocalArcCons(Ns_QueueItem& /*Qitem*/)
+{
+        if (atFixpoint) {
+                NsIntVarArray* VarArr[2] = {VarArrX, VarArrY};
+                bool same = true;
+                for (int d = 0; d < 2 && same; ++d) {
+                        for (NsIndex i = 0; i < sizes[d].size() && same;
+                             ++i) {
+                                same = ((*VarArr[d])[i].min() == lo[d][i] &&
+                                        (*VarArr[d])[i].max() == hi[d][i]);
+                        }
+                }
+                if (same)
+                        return;
+        }
+        ArcCons();
+}
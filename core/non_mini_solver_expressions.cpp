@@ -82,8 +82,23 @@ Ns_Constraint* Ns_ExprConstrCount::postConstraint(bool positively) const
 {
         assert_Ns(positively,
                   "Ns_ExprConstrCount::postConstraint: 'positively'==false");
-        Ns_Constraint* newConstr = new Ns_ConstrCount(
-            &VarArr, Values, Occurrences, SplitPositions, Split, Dwin);
+        Ns_Constraint* newConstr;
+        if (consistency != NsCOUNT_VALUES && !VarArr.empty()) {
+                newConstr = new Ns_ConstrCountFlow(
+                    &VarArr, Values, Occurrences,
+                    consistency == NsCOUNT_BOUNDS);
+                for (NsIntVarArray::iterator X = VarArr.begin();
+                     X != VarArr.end(); ++X)
+                        X->addConstraint(newConstr);
+                VarArr.addConstraint();
+                if (!Split)
+                        return newConstr;
+                // The split occurrences are imposed by an extra constraint
+                newConstr->ArcCons();
+                VarArr[0].manager().recordConstraint(newConstr);
+        }
+        newConstr = new Ns_ConstrCount(&VarArr, Values, Occurrences,
+                                       SplitPositions, Split, Dwin);
         for (NsIntVarArray::iterator X = VarArr.begin(); X != VarArr.end(); ++X)
                 X->addConstraint(newConstr);
         VarArr.addConstraint();
@@ -126,3 +141,47 @@ void Ns_ExprInverse::post(NsIntVarArray& VarArrInv) const
         newConstr->ArcCons();
         VarArr[0].manager().recordConstraint(newConstr);
 }
+
+Ns_Constraint* Ns_ExprConstrCumulative::postConstraint(bool positively) const
+{
+        assert_Ns(positively, "Ns_ExprConstrCumulative::postConstraint: "
+                              "'positively'==false");
+        if (Starts.empty())
+                return 0; // no constraint
+        Ns_Constraint* newConstr = new Ns_ConstrCumulative(
+            &Starts, Durations, Demands, Capacity, EdgeFinding);
+        for (NsIntVarArray::iterator X = Starts.begin(); X != Starts.end(); ++X)
+                X->addConstraint(newConstr);
+        Starts.addConstraint();
+        return newConstr;
+}
+
+Ns_Constraint* Ns_ExprConstrDisjunctive::postConstraint(bool positively) const
+{
+        assert_Ns(positively, "Ns_ExprConstrDisjunctive::postConstraint: "
+                              "'positively'==false");
+        if (Starts.size() <= 1)
+                return 0; // no constraint
+        Ns_Constraint* newConstr = new Ns_ConstrDisjunctive(&Starts, Durations);
+        for (NsIntVarArray::iterator X = Starts.begin(); X != Starts.end(); ++X)
+                X->addConstraint(newConstr);
+        Starts.addConstraint();
+        return newConstr;
+}
+
+Ns_Constraint* Ns_ExprConstrDiffn::postConstraint(bool positively) const
+{
+        assert_Ns(positively, "Ns_ExprConstrDiffn::postConstraint: "
+                              "'positively'==false");
+        if (X.size() <= 1 && Y.size() <= 1)
+                return 0; // no constraint
+        Ns_Constraint* newConstr = new Ns_ConstrDiffn(&X, &Y, Widths, Heights);
+        NsIntVarArray::iterator V;
+        for (V = X.begin(); V != X.end(); ++V)
+                V->addConstraint(newConstr);
+        X.addConstraint();
+        for (V = Y.begin(); V != Y.end(); ++V)
+                V->addConstraint(newConstr);
+        Y.addConstraint();
+        return newConstr;
+}
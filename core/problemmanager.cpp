@@ -348,6 +348,19 @@ void destroy_goal(NsGoal* g)
         }
 }
 
+/// The i-th term (starting from 1) of the Luby sequence 1 1 2 1 1 2 4 ...
+unsigned long luby(unsigned long i)
+{
+        for (;;) {
+                unsigned long k = 1;
+                while ((1UL << k) - 1 < i)
+                        ++k;
+                if ((1UL << k) - 1 == i)
+                        return (1UL << (k - 1));
+                i -= (1UL << (k - 1)) - 1;
+        }
+}
+
 /// Reimplements difftime() to address MinGW issues
 inline double DiffTime(time_t time2, time_t time1)
 {
@@ -394,8 +407,8 @@ Ns_StackGoals::~Ns_StackGoals(void)
 
 NsProblemManager::~NsProblemManager(void)
 {
-        // Delete the queue first, because it depends to the following
-        getQueue().clear();
+        // Delete the queues first, because they depend to the following
+        clearQueues();
         // Constraints destruction
         for (Ns_constraints_array_t::iterator c = constraints.begin();
              c != constraints.end(); ++c) {
@@ -406,6 +419,34 @@ NsProblemManager::~NsProblemManager(void)
              v != intermediateVars.end(); ++v) {
                 delete *v;
         }
+        for (NsDeque<Ns_FirstFailHeap*>::iterator heap = firstFailHeaps.begin();
+             heap != firstFailHeaps.end(); ++heap) {
+                delete *heap;
+        }
+        // Tables destruction, after the constraints that share them
+        for (Ns_UNORDERED_MAP<size_t, NsDeque<Ns_TupleStore*>>::iterator
+                 sameHash = tupleStores.begin();
+             sameHash != tupleStores.end(); ++sameHash) {
+                for (NsDeque<Ns_TupleStore*>::iterator store =
+                         sameHash->second.begin();
+                     store != sameHash->second.end(); ++store) {
+                        delete *store;
+                }
+        }
+}
+
+Ns_TupleStore* NsProblemManager::internTupleStore(Ns_TupleStore* newStore)
+{
+        NsDeque<Ns_TupleStore*>& sameHash = tupleStores[newStore->hash()];
+        for (NsDeque<Ns_TupleStore*>::iterator store = sameHash.begin();
+             store != sameHash.end(); ++store) {
+                if (**store == *newStore) {
+                        delete newStore;
+                        return *store;
+                }
+        }
+        sameHash.push_back(newStore);
+        return newStore;
 }
 
 /// Fetches the next constraint to currentConstr that affects variable varFired
@@ -445,43 +486,52 @@ NsProblemManager::~NsProblemManager(void)
 ///                    return temp;
 ///            }
 ///    }
+///
+/// The entailed constraints that are met are moved after the
+/// live constraints of varFired, so that they are not met again
+/// in the current search subtree.
 Ns_Constraint* Ns_QueueItem::getNextConstraint(void)
 {
-        for (/*VOID*/; currentConstr < varFired->constraints.size();
-             ++currentConstr) {
-                switch (
-                    varFired->constraints[currentConstr].constr->revisionType) {
+        while (currentConstr < varFired->liveConstraints) {
+                Ns_Constraint* c = varFired->constraints[currentConstr].constr;
+                if (c->entailed) {
+                        // The constraint that takes its place is examined
+                        varFired->dropConstraint(currentConstr);
+                        currentRemovedValue = 0;
+                        continue;
+                }
+                switch (c->revisionType) {
                 case Ns_Constraint::VALUE_CONSISTENCY:
                         do {
                                 ++currentRemovedValue;
                         } while (
                             currentRemovedValue - 1 < removedValues.size() &&
                             removedValues[currentRemovedValue - 1]
-                                    .constrFired ==
-                                varFired->constraints[currentConstr].constr);
+                                    .constrFired == c);
                         if (currentRemovedValue - 1 == removedValues.size())
                                 currentRemovedValue = 0;
                         else
-                                return varFired->constraints[currentConstr]
-                                    .constr;
+                                return c;
                         break;
                 case Ns_Constraint::BOUNDS_CONSISTENCY:
                         if (removedBoundRec.removedBound &&
-                            varFired->constraints[currentConstr].constr !=
-                                removedBoundRec.constrFired) {
+                            c != removedBoundRec.constrFired &&
+                            fired(varFired->constraints[currentConstr]
+                                      .events)) {
                                 // No need to check the constraint that
                                 // initiated the propagation.
-                                return varFired->constraints[currentConstr++]
-                                    .constr;
+                                ++currentConstr;
+                                return c;
                         }
                         break;
                 case Ns_Constraint::BIDIRECTIONAL_CONSISTENCY:
                         if (removedBoundRec.removedBound &&
                             removedBoundRec.removalTime >=
-                                varFired->constraints[currentConstr]
-                                    .constr->lastConstraintCheckTime) {
-                                return varFired->constraints[currentConstr++]
-                                    .constr;
+                                c->lastConstraintCheckTime &&
+                            fired(varFired->constraints[currentConstr]
+                                      .events)) {
+                                ++currentConstr;
+                                return c;
                         }
                         break;
                 default:
@@ -489,6 +539,7 @@ Ns_Constraint* Ns_QueueItem::getNextConstraint(void)
                                           "Invalid 'constr->revisionType'");
                         break;
                 };
+                ++currentConstr;
         }
         return 0;
 }
@@ -518,15 +569,142 @@ void NsProblemManager::add(const Ns_ExprConstr& expr, const NsInt weight)
         vSoftConstraintsTerms.push_back(weight * expr.post());
 }
 
+/// Empties the propagation queues of both engines
+void NsProblemManager::clearQueues(void)
+{
+        getQueue().clear();
+        for (int p = 0; p < Ns_Constraint::N_PRIORITY_CLASSES; ++p) {
+                while (!constraintQueues[p].empty()) {
+                        constraintQueues[p].front()->inConstraintQueue = false;
+                        constraintQueues[p].pop();
+                }
+        }
+}
+
+/// Selects the propagation engine; the default is VARIABLE_QUEUE
+void NsProblemManager::propagationEngine(const PropagationEngine engine)
+{
+        bool pending = !getQueue().empty();
+        for (int p = 0; p < Ns_Constraint::N_PRIORITY_CLASSES; ++p)
+                pending = pending || !constraintQueues[p].empty();
+        assert_Ns(!pending, "NsProblemManager::propagationEngine: Cannot "
+                            "switch engine while propagating");
+        propagation = engine;
+}
+
+/// Queues the constraints that should be revised after a modification
+///
+/// It is used by the constraint-centric engine, in place of the
+/// revisions of the AC-5 engine, for the constraints of
+/// Qitem.getVarFired() that the modification concerns. A constraint
+/// is queued once, until it is revised. The constraints that are
+/// revised locally are checked immediately, except for the expensive
+/// ones, whose state is only updated before they are queued.
+void NsProblemManager::scheduleConstraints(Ns_QueueItem& Qitem)
+{
+        Ns_Constraint* c;
+        while ((c = Qitem.getNextConstraint()) != 0) {
+                Ns_Constraint::PriorityClass p = c->priorityClass();
+                if (c->revisedLocally() &&
+                    p != Ns_Constraint::EXPENSIVE_PRIORITY) {
+                        c->LocalArcCons(Qitem);
+                        c->lastConstraintCheckTime = ++nConstraintChecks;
+                        if (foundInconsistency) {
+                                Qitem.failedBy(c);
+                                return;
+                        }
+                        continue;
+                }
+                if (c->revisedLocally())
+                        c->updateLocally(Qitem);
+                if (!c->inConstraintQueue) {
+                        c->inConstraintQueue = true;
+                        constraintQueues[p].push(c);
+                }
+        }
+}
+
+/// Imposes arc consistency by revising each queued constraint as a whole
+///
+/// The modified variables are still queued as in the AC-5 engine,
+/// but they are only used to queue their constraints. A constraint
+/// is revised only when the queues of the higher priority classes
+/// are empty, so that the cheap constraints reach a fixpoint before
+/// an expensive one is revised.
+bool NsProblemManager::constraintsArcConsistent(void)
+{
+        for (;;) {
+                while (!getQueue().empty() && !foundInconsistency) {
+                        getQueue().front().getVarFired()->queueItem = 0;
+                        scheduleConstraints(getQueue().front());
+                        getQueue().pop();
+                }
+                if (foundInconsistency) {
+                        foundInconsistency = false;
+                        clearQueues();
+                        ++nFailures;
+                        return false;
+                }
+                int p = 0;
+                while (p < Ns_Constraint::N_PRIORITY_CLASSES &&
+                       constraintQueues[p].empty())
+                        ++p;
+                if (p == Ns_Constraint::N_PRIORITY_CLASSES)
+                        return true;
+                Ns_Constraint* c = constraintQueues[p].front();
+                constraintQueues[p].pop();
+                c->inConstraintQueue = false;
+                if (c->entailed)
+                        continue;
+                c->ArcCons();
+                c->lastConstraintCheckTime = ++nConstraintChecks;
+                if (foundInconsistency)
+                        c->recordFailure();
+        }
+}
+
+/// Records an inconsistency that the constraint provoked, while it
+/// was revised as a whole
+///
+/// No variable fired the revision, so the failure is counted for
+/// the constraint in each variable of its scope.
+void Ns_Constraint::recordFailure(void)
+{
+        for (std::vector<NsIntVar*>::iterator V = scope.begin();
+             V != scope.end(); ++V) {
+                for (NsIndex k = 0; k < (*V)->liveConstraints; ++k) {
+                        if ((*V)->constraints[k].constr == this) {
+                                ++(*V)->constraints[k].failures;
+                                break;
+                        }
+                }
+        }
+        increaseWeight();
+}
+
+/// Increases the weight of the constraint after an inconsistency
+///
+/// The weighted degrees of its variables are updated too.
+void Ns_Constraint::increaseWeight(void)
+{
+        ++weight;
+        for (std::vector<NsIntVar*>::iterator V = scope.begin();
+             V != scope.end(); ++V) {
+                ++(*V)->weightedDegree;
+        }
+}
+
 /// Imposes arc consistency
 bool NsProblemManager::arcConsistent(void)
 {
         if (foundInconsistency) {
                 foundInconsistency = false;
-                getQueue().clear();
+                clearQueues();
                 ++nFailures;
                 return false;
         }
+        if (propagation == CONSTRAINT_QUEUE)
+                return constraintsArcConsistent();
         Ns_Constraint* c;
         NsIntVar* vFired;
         while (!getQueue().empty()) {
@@ -540,8 +718,9 @@ bool NsProblemManager::arcConsistent(void)
                         c->LocalArcCons(getQueue().front());
                         c->lastConstraintCheckTime = ++nConstraintChecks;
                         if (foundInconsistency) {
+                                getQueue().front().failedBy(c);
                                 foundInconsistency = false;
-                                getQueue().clear();
+                                clearQueues();
                                 ++nFailures;
                                 return false;
                         }
@@ -551,6 +730,49 @@ bool NsProblemManager::arcConsistent(void)
         return true;
 }
 
+/// Assigns the value to the variable, as a search decision
+NsGoal* NsgSetValue::GOAL(void)
+{
+        Var.manager().decisionOn(Var, value);
+        Var.set(value);
+        return 0;
+}
+
+/// Removes the value from the domain of the variable, as a search decision
+NsGoal* NsgRemoveValue::GOAL(void)
+{
+        Var.manager().removalOn(Var, value);
+        Var.remove(value);
+        return 0;
+}
+
+/// Records the effect of a goal that is not a decision on a variable
+///
+/// If it modified any domain, the nogoods cannot be extracted
+/// after this point of the path. If it failed, the search below
+/// the current node cannot refute it.
+void NsProblemManager::recordGoalEffect(void)
+{
+        if (foundInconsistency) {
+                searchNodes.top().refutable = false;
+        } else if (goalShrinks != 0) {
+                searchNodes.top().decisions.push_back(
+                    Ns_SearchNode::Decision(0, 0, false));
+        }
+}
+
+/// Adds the impact of the last decision to the mean impact of its variable
+///
+/// 'consistent' is false if the propagation of the decision failed.
+void NsProblemManager::recordImpact(const bool consistent)
+{
+        if (learning) {
+                decisionVar->addImpact(
+                    (consistent) ? 1 - std::exp(-searchSpaceReduction) : 1);
+        }
+        decisionVar = 0;
+}
+
 /// Backtracks the search process to the previous choice point
 bool NsProblemManager::backtrack(void)
 {
@@ -565,14 +787,30 @@ bool NsProblemManager::backtrack(void)
                 goalNextChoice = searchNodes.top().goalNextChoice;
                 if (goalNextChoice == 0)
                         return false;
+                bool refutable = searchNodes.top().refutable;
+                Ns_SearchNode::Decision refuted =
+                    searchNodes.top().firstAssignment();
                 searchNodes.top().bitsetsStore.restore();
+                searchNodes.top().constraintsStore.restore();
                 searchNodes.pop();
                 searchNodes.top().stackAND.push(goalNextChoice);
+                if (restarts != NO_RESTARTS) {
+                        // The search below the node is exhausted
+                        if (!refutable) {
+                                searchNodes.top().refutable = false;
+                        } else if (refuted.var != 0) {
+                                refuted.refuted = true;
+                                searchNodes.top().decisions.push_back(refuted);
+                        }
+                        // The refutation above becomes a nogood too
+                        if (nFailures - restartFailures >= restartCutoff)
+                                return restartSearch();
+                }
                 if (vObjective != 0) {
                         vObjective->remove(bestObjective, NsPLUS_INF);
                         if (foundInconsistency) {
                                 foundInconsistency = false;
-                                getQueue().clear();
+                                clearQueues();
                                 continue;
                         }
                 }
@@ -580,17 +818,143 @@ bool NsProblemManager::backtrack(void)
         }
 }
 
+/// Sets the restart policy of nextSolution()
+///
+/// The cutoffs are counted in failures. The goals that have
+/// been added to the problem manager are executed again after
+/// each restart, while the weights and the activities of the
+/// heuristics and the best objective value persist.
+void NsProblemManager::restartPolicy(const RestartPolicy policy,
+                                     const unsigned long scale,
+                                     const double factor)
+{
+        assert_Ns(firstNextSolution, "NsProblemManager::restartPolicy: "
+                                     "Cannot be set after the search began");
+        assert_Ns(policy == NO_RESTARTS || scale > 0,
+                  "NsProblemManager::restartPolicy: Zero scale");
+        assert_Ns(factor >= 1,
+                  "NsProblemManager::restartPolicy: Factor less than one");
+        restarts = policy;
+        restartScale = scale;
+        restartFactor = factor;
+        restartFailures = nFailures;
+        nRestarts = 0;
+        nextRestartCutoff();
+}
+
+/// Computes the number of the failures allowed for the next run
+void NsProblemManager::nextRestartCutoff(void)
+{
+        switch (restarts) {
+        case LUBY:
+                restartCutoff = restartScale * luby(nRestarts + 1);
+                break;
+        case GEOMETRIC:
+                restartCutoff =
+                    restartScale * std::pow(restartFactor, nRestarts);
+                break;
+        default:
+                restartCutoff = restartScale;
+                break;
+        }
+}
+
+/// Restarts the search when the cutoff of the current run is reached
+///
+/// It only backtracks to the root search node, which keeps the
+/// state after the first arcConsistent() call, so the root is
+/// not propagated again. Then the goals added before the search
+/// are executed again. Returns false if the objective cannot be
+/// improved anymore.
+bool NsProblemManager::restartSearch(void)
+{
+        ++nRestarts;
+        restartFailures = nFailures;
+        nextRestartCutoff();
+        recordNogoods();
+        // Pops every search node except for the base one, which
+        // holds the goals
+        while (searchNodes.size() > 1) {
+                destroy_goal(searchNodes.top().goalNextChoice);
+                searchNodes.top().bitsetsStore.restore();
+                searchNodes.top().constraintsStore.restore();
+                searchNodes.pop();
+        }
+        // The objective bound and the new nogoods are propagated in
+        // the base node, which is never restored, as they hold for
+        // every next run.
+        if (vObjective != 0)
+                vObjective->remove(bestObjective, NsPLUS_INF);
+        if (nogoods != 0)
+                nogoods->ArcCons();
+        bool consistent = arcConsistent();
+        searchNodes.top().bitsetsStore.clear();
+        searchNodes.top().constraintsStore.clear();
+        if (!consistent) {
+                // Nothing is left to search
+                while (!searchNodes.top().stackAND.empty()) {
+                        destroy_goal(searchNodes.top().stackAND.top());
+                        searchNodes.top().stackAND.pop();
+                }
+        }
+        assert_Ns(searchNodes.push(Ns_SearchNode(0, searchNodes.gbegin(),
+                                                 numSearchTreeNodes())),
+                  "NsProblemManager::restartSearch: Root push should succeed");
+        return consistent;
+}
+
+/// Extracts the reduced nogoods of the current search path
+///
+/// For each assignment that the search has refuted, the
+/// assignments decided before it on the path, together with the
+/// refuted one, cannot hold at the same time. The negative
+/// decisions are not needed, as they are implied by the
+/// previous nogoods. The extraction stops at the first
+/// modification that is not an assignment.
+void NsProblemManager::recordNogoods(void)
+{
+        if (restarts == NO_RESTARTS)
+                return;
+        NsDeque<const Ns_SearchNode*> path;
+        for (Ns_StackSearch::iterator node = searchNodes.begin();
+             node != searchNodes.end(); ++node) {
+                path.push_front(&*node);
+        }
+        NsDeque<Ns_ConstrNogoods::Literal> nogood;
+        for (NsDeque<const Ns_SearchNode*>::iterator node = path.begin();
+             node != path.end(); ++node) {
+                for (std::vector<Ns_SearchNode::Decision>::const_iterator d =
+                         (*node)->decisions.begin();
+                     d != (*node)->decisions.end(); ++d) {
+                        if (d->var == 0)
+                                return;
+                        nogood.push_back(
+                            Ns_ConstrNogoods::Literal(d->var, d->value));
+                        if (d->refuted) {
+                                if (nogoods == 0) {
+                                        nogoods = new Ns_ConstrNogoods;
+                                        recordConstraint(nogoods);
+                                }
+                                nogoods->add(nogood);
+                                nogood.pop_back();
+                        }
+                }
+        }
+}
+
 /// Reverts the domains of the constrained variables
 ///
 /// Except for the 'objective' variable, it restores every
 /// variable in the state it was after the first arcConsistent()
-/// call.
+/// call. If a restart policy is set, the nogoods of the current
+/// search path are recorded first.
 void NsProblemManager::restart(void)
 {
+        recordNogoods();
         firstNextSolution = true;
         // For any case, we clear the propagation engine's members.
         foundInconsistency = false;
-        getQueue().clear();
+        clearQueues();
         bool foundSecondFrame = false;
         NsGoal* goalNextChoice;
         assert_Ns(!searchNodes.empty(),
@@ -600,6 +964,7 @@ void NsProblemManager::restart(void)
                 if (goalNextChoice == 0)
                         foundSecondFrame = true;
                 searchNodes.top().bitsetsStore.restore();
+                searchNodes.top().constraintsStore.restore();
                 searchNodes.pop();
                 searchNodes.top().stackAND.push(goalNextChoice);
                 // We kept the above line because of Memory Management
@@ -626,15 +991,29 @@ bool NsProblemManager::nextSolution(void)
                 // Soft constraints objective
                 if (vObjective == 0 && !vSoftConstraintsTerms.empty())
                         minimize(-NsSum(vSoftConstraintsTerms));
+                if (nogoods != 0)
+                        nogoods->ArcCons();
                 isArcCons = arcConsistent();
                 // Throwing away unnesessary 'bitsetsStore' in the first frame
                 searchNodes.top().bitsetsStore.clear();
+                searchNodes.top().constraintsStore.clear();
                 // (A) Cutting from the stackAND of the base frame...
                 Ns_StackGoals tempStackAND;
-                while (!searchNodes.top().stackAND.empty()) {
+                while (restarts == NO_RESTARTS &&
+                       !searchNodes.top().stackAND.empty()) {
                         tempStackAND.push(searchNodes.top().stackAND.top());
                         searchNodes.top().stackAND.pop();
                 }
+                // ...unless restarts are enabled, where the goals stay
+                // in the base frame, in order to be executed again
+                // (without being deleted) after each restart.
+                for (Ns_StackGoals::iterator g =
+                         searchNodes.top().stackAND.begin();
+                     g != searchNodes.top().stackAND.end(); ++g) {
+                        assert_Ns(!(*g)->isGoalAND() && !(*g)->isGoalOR(),
+                                  "NsProblemManager::nextSolution: A "
+                                  "meta-goal cannot be restarted");
+                }
                 // A push of frame, for the purposes of
                 // NsProblemManager::restart(). We took care placing it _after_
                 // the arcConsistent() call because in future, we will not be
@@ -740,10 +1119,18 @@ bool NsProblemManager::nextSolution(void)
                                 return false;
                 } else {
                         ++nGoals;
+                        searchSpaceReduction = 0;
+                        decisionGoal = false;
+                        goalShrinks = 0;
                         NewGoal = CurrGoal->GOAL();
+                        if (restarts != NO_RESTARTS && !decisionGoal)
+                                recordGoalEffect();
                         if (popped_a_goal)
                                 delete CurrGoal;
-                        if (!arcConsistent()) {
+                        bool consistent = arcConsistent();
+                        if (decisionVar != 0)
+                                recordImpact(consistent);
+                        if (!consistent) {
                                 destroy_goal(NewGoal);
                                 if (!backtrack())
                                         return false;
@@ -763,6 +1150,11 @@ bool NsProblemManager::nextSolution(void)
                                         // vObjective has been augmented.
                                 }
                                 searchNodes.solutionNode(vObjective);
+                                // A restart would find the same
+                                // solutions again, if there is no
+                                // objective to improve.
+                                if (vObjective == 0)
+                                        restarts = NO_RESTARTS;
                                 return true;
                         }
                 }
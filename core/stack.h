@@ -6,37 +6,107 @@
 #ifndef Ns_STACK_H
 #define Ns_STACK_H
 
+#include <new>
+
+/// A stack whose frames are stored in contiguous chunks of memory
+///
+/// Each chunk is twice as large as the previous one. The frames
+/// never move after their construction; therefore pointers and
+/// iterators to a frame remain valid while new frames are pushed
+/// above it. The memory of the popped frames is not freed but it
+/// is recycled by the following pushes, in order to avoid an
+/// allocation per push while searching and backtracking.
 template <typename TemplType>
 class NsStack {
 
-    protected:
-        struct StackNode_t {
+    public:
+        typedef TemplType value_type;
 
-                TemplType theData;
+        typedef unsigned long size_type;
 
-                StackNode_t* next;
+    private:
+        /// The number of frames that fit into the first chunk
+        enum { FIRST_CHUNK_SIZE = 8 };
 
-                StackNode_t(const TemplType& T) : theData(T), next(0)
-                {
-                }
-        };
+        /// The number of frames that fit into a chunk
+        static size_type chunkSize(const size_type chunk)
+        {
+                return (static_cast<size_type>(FIRST_CHUNK_SIZE) << chunk);
+        }
 
-        StackNode_t* stackTopNode;
+        /// Array of pointers to the allocated chunks
+        TemplType** chunks;
 
-    public:
-        typedef TemplType value_type;
+        /// The number of the allocated chunks
+        size_type nChunks;
 
-        typedef unsigned long size_type;
+        /// The size of the 'chunks' array
+        size_type chunksCapacity;
+
+        /// The chunk that contains the top frame
+        size_type topChunk;
+
+        /// Points to the top frame, or is null if the stack is empty
+        TemplType* stackTop;
 
-    private:
         size_type nFrames;
 
+        /// Allocates the chunk, if it does not already exist
+        void allocateChunk(const size_type chunk)
+        {
+                if (chunk < nChunks)
+                        return;
+                if (nChunks == chunksCapacity) {
+                        size_type newCapacity =
+                            (chunksCapacity == 0) ? 4 : 2 * chunksCapacity;
+                        TemplType** newChunks = new TemplType*[newCapacity];
+                        for (size_type i = 0; i < nChunks; ++i)
+                                newChunks[i] = chunks[i];
+                        delete[] chunks;
+                        chunks = newChunks;
+                        chunksCapacity = newCapacity;
+                }
+                chunks[nChunks] = static_cast<TemplType*>(
+                    ::operator new(chunkSize(nChunks) * sizeof(TemplType)));
+                ++nChunks;
+        }
+
+        /// Moves 'frame' one position lower in the stack
+        ///
+        /// Sets 'frame' to null when it goes below the bottom frame.
+        template <typename FramePointer>
+        void lowerFrame(FramePointer& frame, size_type& chunk) const
+        {
+                if (frame == chunks[chunk]) {
+                        if (chunk == 0) {
+                                frame = 0;
+                        } else {
+                                --chunk;
+                                frame = chunks[chunk] + chunkSize(chunk) - 1;
+                        }
+                } else {
+                        --frame;
+                }
+        }
+
     public:
-        NsStack(void) : stackTopNode(0), nFrames(0)
+        NsStack(void)
+          : chunks(0),
+            nChunks(0),
+            chunksCapacity(0),
+            topChunk(0),
+            stackTop(0),
+            nFrames(0)
         {
         }
 
         NsStack(const NsStack& stackOther)
+          : chunks(0),
+            nChunks(0),
+            chunksCapacity(0),
+            topChunk(0),
+            stackTop(0),
+            nFrames(0)
         {
                 *this = stackOther;
         }
@@ -46,6 +116,9 @@ class NsStack {
         ~NsStack(void)
         {
                 clear();
+                for (size_type i = 0; i < nChunks; ++i)
+                        ::operator delete(chunks[i]);
+                delete[] chunks;
         }
 
         size_type size(void) const
@@ -61,35 +134,49 @@ class NsStack {
 
         bool empty(void) const
         {
-                return (stackTopNode == 0);
+                return (stackTop == 0);
         }
 
         TemplType& top(void)
         {
-                assert_Ns(stackTopNode != 0, "NsStack::top: Stack is empty");
-                return stackTopNode->theData;
+                assert_Ns(stackTop != 0, "NsStack::top: Stack is empty");
+                return *stackTop;
         }
 
         const TemplType& top(void) const
         {
-                assert_Ns(stackTopNode != 0, "NsStack::top: Stack is empty");
-                return stackTopNode->theData;
+                assert_Ns(stackTop != 0, "NsStack::top: Stack is empty");
+                return *stackTop;
         }
 
         void pop(void)
         {
                 assert_Ns(!empty(), "NsStack::pop: Stack is empty");
-                StackNode_t* current = stackTopNode;
-                stackTopNode = current->next;
-                delete current;
+                TemplType* current = stackTop;
+                lowerFrame(stackTop, topChunk);
+                current->~TemplType();
                 --nFrames;
         }
 
         void push(const TemplType newData)
         {
-                StackNode_t* newNode = new StackNode_t(newData);
-                newNode->next = stackTopNode;
-                stackTopNode = newNode;
+                size_type newChunk = topChunk;
+                TemplType* newFrame;
+                if (stackTop == 0) {
+                        newChunk = 0;
+                        allocateChunk(newChunk);
+                        newFrame = chunks[newChunk];
+                } else if (stackTop ==
+                           chunks[topChunk] + chunkSize(topChunk) - 1) {
+                        ++newChunk;
+                        allocateChunk(newChunk);
+                        newFrame = chunks[newChunk];
+                } else {
+                        newFrame = stackTop + 1;
+                }
+                new (newFrame) TemplType(newData);
+                topChunk = newChunk;
+                stackTop = newFrame;
                 ++nFrames;
         }
 
@@ -101,20 +188,28 @@ class NsStack {
         class iterator {
 
             private:
-                StackNode_t* currNode;
+                const NsStack* theStack;
+
+                TemplType* currFrame;
+
+                size_type currChunk;
 
             public:
-                iterator(void) : currNode(0)
+                iterator(void) : theStack(0), currFrame(0), currChunk(0)
                 {
                 }
 
-                iterator(StackNode_t* startNode) : currNode(startNode)
+                iterator(const NsStack* theStack_init, TemplType* startFrame,
+                         const size_type startChunk)
+                  : theStack(theStack_init),
+                    currFrame(startFrame),
+                    currChunk(startChunk)
                 {
                 }
 
                 bool operator==(const iterator& b) const
                 {
-                        return (currNode == b.currNode);
+                        return (currFrame == b.currFrame);
                 }
 
                 bool operator!=(const iterator& b) const
@@ -124,65 +219,76 @@ class NsStack {
 
                 TemplType& operator*(void)const
                 {
-                        assert_Ns(currNode != 0,
+                        assert_Ns(currFrame != 0,
                                   "NsStack::iterator::*: Bad request "
                                   "'*(something.end())'");
-                        return currNode->theData;
+                        return *currFrame;
                 }
 
                 TemplType* operator->(void)const
                 {
-                        assert_Ns(currNode != 0,
+                        assert_Ns(currFrame != 0,
                                   "NsStack::iterator::->: Bad request "
                                   "'*(something.end())'");
-                        return &currNode->theData;
+                        return currFrame;
                 }
 
                 iterator& end(void)
                 {
-                        currNode = 0;
+                        currFrame = 0;
                         return *this;
                 }
 
                 iterator& operator++(void)
                 {
-                        assert_Ns(currNode != 0,
+                        assert_Ns(currFrame != 0,
                                   "NsStack::iterator::++: Bad request "
                                   "'++(something.end())'");
-                        currNode = currNode->next;
+                        theStack->lowerFrame(currFrame, currChunk);
                         return *this;
                 }
         };
 
         iterator begin(void)
         {
-                return iterator(stackTopNode);
+                return iterator(this, stackTop, topChunk);
         }
 
         iterator end(void)
         {
-                iterator iter_end(stackTopNode);
+                iterator iter_end(this, stackTop, topChunk);
                 return iter_end.end();
         }
 
+        class const_iterator;
+        friend class const_iterator;
+
         class const_iterator {
 
             private:
-                const StackNode_t* currNode;
+                const NsStack* theStack;
+
+                const TemplType* currFrame;
+
+                size_type currChunk;
 
             public:
-                const_iterator(void) : currNode(0)
+                const_iterator(void) : theStack(0), currFrame(0), currChunk(0)
                 {
                 }
 
-                const_iterator(const StackNode_t* startNode)
-                  : currNode(startNode)
+                const_iterator(const NsStack* theStack_init,
+                               const TemplType* startFrame,
+                               const size_type startChunk)
+                  : theStack(theStack_init),
+                    currFrame(startFrame),
+                    currChunk(startChunk)
                 {
                 }
 
                 bool operator==(const const_iterator& b) const
                 {
-                        return (currNode == b.currNode);
+                        return (currFrame == b.currFrame);
                 }
 
                 bool operator!=(const const_iterator& b) const
@@ -192,44 +298,44 @@ class NsStack {
 
                 const TemplType& operator*(void)const
                 {
-                        assert_Ns(currNode != 0,
+                        assert_Ns(currFrame != 0,
                                   "NsStack::const_iterator::*: Bad request "
                                   "'*(something.end())'");
-                        return currNode->theData;
+                        return *currFrame;
                 }
 
                 const TemplType* operator->(void)const
                 {
-                        assert_Ns(currNode != 0,
+                        assert_Ns(currFrame != 0,
                                   "NsStack::const_iterator::->: Bad request "
                                   "'*(something.end())'");
-                        return &currNode->theData;
+                        return currFrame;
                 }
 
                 const_iterator& end(void)
                 {
-                        currNode = 0;
+                        currFrame = 0;
                         return *this;
                 }
 
                 const_iterator& operator++(void)
                 {
-                        assert_Ns(currNode != 0,
+                        assert_Ns(currFrame != 0,
                                   "NsStack::const_iterator::++: Bad request "
                                   "'++(something.end())'");
-                        currNode = currNode->next;
+                        theStack->lowerFrame(currFrame, currChunk);
                         return *this;
                 }
         };
 
         const_iterator begin(void) const
         {
-                return const_iterator(stackTopNode);
+                return const_iterator(this, stackTop, topChunk);
         }
 
         const_iterator end(void) const
         {
-                const_iterator iter_end(stackTopNode);
+                const_iterator iter_end(this, stackTop, topChunk);
                 return iter_end.end();
         }
 };
@@ -237,17 +343,20 @@ class NsStack {
 template <typename TemplType>
 NsStack<TemplType>& NsStack<TemplType>::operator=(const NsStack& stackOther)
 {
-        nFrames = stackOther.nFrames;
-        StackNode_t** currNode = &stackTopNode;
-        StackNode_t* const* currNodeOther = &stackOther.stackTopNode;
-        for (;;) {
-                if (*currNodeOther == 0) {
-                        *currNode = *currNodeOther;
+        if (this == &stackOther)
+                return *this;
+        clear();
+        // Copy the frames from the bottom to the top
+        for (size_type chunk = 0; chunk < stackOther.nChunks; ++chunk) {
+                if (stackOther.stackTop == 0 || chunk > stackOther.topChunk)
                         break;
-                }
-                *currNode = new StackNode_t(**currNodeOther);
-                currNode = &(*currNode)->next;
-                currNodeOther = &(*currNodeOther)->next;
+                const TemplType* frame = stackOther.chunks[chunk];
+                const TemplType* lastFrame =
+                    (chunk == stackOther.topChunk)
+                        ? stackOther.stackTop
+                        : frame + chunkSize(chunk) - 1;
+                for (; frame <= lastFrame; ++frame)
+                        push(*frame);
         }
         return *this;
 }
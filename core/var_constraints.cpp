@@ -15,6 +15,8 @@ void Ns_ConstrXlessthanY::ArcCons(void)
 {
         VarX->removeRange(VarY->max(), NsPLUS_INF, this);
         VarY->removeRange(NsMINUS_INF, VarX->min(), this);
+        if (VarX->max() < VarY->min())
+                VarX->manager().entail(this);
 }
 
 void Ns_ConstrXlessthanY::LocalArcCons(Ns_QueueItem& Qitem)
@@ -27,12 +29,16 @@ void Ns_ConstrXlessthanY::LocalArcCons(Ns_QueueItem& Qitem)
                     "Ns_ConstrXlessthanY::LocalArcCons: Wrong getVarFired");
                 VarX->removeRange(VarY->max(), NsPLUS_INF, this);
         }
+        if (VarX->max() < VarY->min())
+                VarX->manager().entail(this);
 }
 
 void Ns_ConstrXlesseqthanY::ArcCons(void)
 {
         VarX->removeRange(VarY->max() + 1, NsPLUS_INF, this);
         VarY->removeRange(NsMINUS_INF, VarX->min() - 1, this);
+        if (VarX->max() <= VarY->min())
+                VarX->manager().entail(this);
 }
 
 void Ns_ConstrXlesseqthanY::LocalArcCons(Ns_QueueItem& Qitem)
@@ -45,6 +51,8 @@ void Ns_ConstrXlesseqthanY::LocalArcCons(Ns_QueueItem& Qitem)
                     "Ns_ConstrXlesseqthanY::LocalArcCons: Wrong getVarFired");
                 VarX->removeRange(VarY->max() + 1, NsPLUS_INF, this);
         }
+        if (VarX->max() <= VarY->min())
+                VarX->manager().entail(this);
 }
 
 namespace {
@@ -498,6 +506,8 @@ void Ns_ConstrXeqYplusC::ArcCons(void)
                 VarY->removeRange(VarX->max() - C + 1, NsPLUS_INF, this,
                                   modification);
         } while (modification);
+        if (VarX->isBound() && VarY->isBound())
+                VarX->manager().entail(this);
 }
 
 void Ns_ConstrXeqYplusC::LocalArcCons(Ns_QueueItem& /*Qitem*/)
@@ -560,18 +570,9 @@ void Ns_ConstrXeqYtimesC::LocalArcCons(Ns_QueueItem& /*Qitem*/)
 
 void Ns_ConstrXeqY::ArcCons(void)
 {
-        bool modification;
-        do {
-                modification = false;
-                VarX->removeRange(NsMINUS_INF, VarY->min() - 1, this,
-                                  modification);
-                VarX->removeRange(VarY->max() + 1, NsPLUS_INF, this,
-                                  modification);
-                VarY->removeRange(NsMINUS_INF, VarX->min() - 1, this,
-                                  modification);
-                VarY->removeRange(VarX->max() + 1, NsPLUS_INF, this,
-                                  modification);
-        } while (modification);
+        // After the two intersections the domains are equal
+        if (VarX->intersect(*VarY, this))
+                VarY->intersect(*VarX, this);
 }
 
 void Ns_ConstrXeqY::LocalArcCons(Ns_QueueItem& /*Qitem*/)
@@ -794,6 +795,9 @@ void Ns_ConstrXneqY::ArcCons(void)
                 VarX->removeSingle(VarY->value(), this);
         if (VarX->isBound())
                 VarY->removeSingle(VarX->value(), this);
+        if ((VarX->isBound() && !VarY->contains(VarX->value())) ||
+            (VarY->isBound() && !VarX->contains(VarY->value())))
+                VarX->manager().entail(this);
 }
 
 void Ns_ConstrXneqY::LocalArcCons(Ns_QueueItem& Qitem)
@@ -807,6 +811,9 @@ void Ns_ConstrXneqY::LocalArcCons(Ns_QueueItem& Qitem)
                 if (VarY->isBound())
                         VarX->removeSingle(VarY->value(), this);
         }
+        if ((VarX->isBound() && !VarY->contains(VarX->value())) ||
+            (VarY->isBound() && !VarX->contains(VarY->value())))
+                VarX->manager().entail(this);
 }
 
 void Ns_ConstrXeqAbsY::ArcCons(void)
@@ -19,14 +19,45 @@ int VarHeurFirst::select(const NsIntVarArray& Vars)
 // minimum remaining values
 int VarHeurMRV::select(const NsIntVarArray& Vars)
 {
-        int index = -1;
-        NsUInt minDom = NsUPLUS_INF;
-        for (NsIndex i = 0; i < Vars.size(); ++i) {
-                if (!Vars[i].isBound() && Vars[i].size() < minDom) {
-                        minDom = Vars[i].size();
-                        index = i;
-                }
-        }
+        NsIndex index = Vars.firstFailIndex();
+        if (index == NsINDEX_INF)
+                return -1;
+        return index;
+}
+
+// minimum domain size per weighted degree
+int VarHeurDomWdeg::select(const NsIntVarArray& Vars)
+{
+        NsIndex index = Vars.domWdegIndex();
+        if (index == NsINDEX_INF)
+                return -1;
+        return index;
+}
+
+// minimum domain size per degree
+int VarHeurDomDeg::select(const NsIntVarArray& Vars)
+{
+        NsIndex index = Vars.domDegIndex();
+        if (index == NsINDEX_INF)
+                return -1;
+        return index;
+}
+
+// maximum activity per domain size
+int VarHeurActivity::select(const NsIntVarArray& Vars)
+{
+        NsIndex index = Vars.activityIndex();
+        if (index == NsINDEX_INF)
+                return -1;
+        return index;
+}
+
+// minimum estimated search space after the assignment
+int VarHeurImpact::select(const NsIntVarArray& Vars)
+{
+        NsIndex index = Vars.impactIndex();
+        if (index == NsINDEX_INF)
+                return -1;
         return index;
 }
 
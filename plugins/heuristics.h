@@ -31,6 +31,26 @@ class VarHeurRand : public VariableHeuristic {
         int select(const naxos::NsIntVarArray& Vars);
 };
 
+class VarHeurDomWdeg : public VariableHeuristic {
+    public:
+        int select(const naxos::NsIntVarArray& Vars);
+};
+
+class VarHeurDomDeg : public VariableHeuristic {
+    public:
+        int select(const naxos::NsIntVarArray& Vars);
+};
+
+class VarHeurActivity : public VariableHeuristic {
+    public:
+        int select(const naxos::NsIntVarArray& Vars);
+};
+
+class VarHeurImpact : public VariableHeuristic {
+    public:
+        int select(const naxos::NsIntVarArray& Vars);
+};
+
 /*******
 class VarHeurDegree : public VariableHeuristic{
 public: